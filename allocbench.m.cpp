@@ -0,0 +1,117 @@
+// Counts global allocator calls per processed command.
+//
+// Parsing into a session's reused buffers should not allocate once they are
+// warmed up. A full execute() also appends to history, which keeps a copy of
+// every line, and process() copies the arguments it is given.
+//
+//   ./allocbench --commands 100000 --line "send hello 'big world' -l"
+#include "capture.h"
+#include "command-processor.h"
+#include "style.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <streambuf>
+
+namespace
+{
+    std::atomic<std::size_t> s_allocations{0};
+
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+    };
+
+    template <typename Body>
+    void measure(const char *name, int commands, Body body)
+    {
+        // warm up so buffers reach their working size
+        for (int i = 0; i < 100; i++)
+        {
+            body();
+        }
+        std::size_t before = s_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < commands; i++)
+        {
+            body();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::size_t allocations = s_allocations.load() - before;
+        std::cerr << name << ": " << static_cast<double>(allocations) / commands << " allocations/command, "
+                  << seconds * 1e9 / commands << " ns/command\n";
+    }
+}
+
+void *operator new(std::size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char **argv)
+{
+    int commands = 100000;
+    std::string line = "send hello 'big world argument' -l --verbose";
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--commands" && i + 1 < argc)
+            commands = std::stoi(argv[++i]);
+        else if (arg == "--line" && i + 1 < argc)
+            line = argv[++i];
+        else
+        {
+            std::cerr << "usage: allocbench [--commands N] [--line TEXT]\n";
+            return 1;
+        }
+    }
+
+    NullBuffer null;
+    auto console = ose4g::redirectOutput(&null);
+    ose4g::setColorMode(ose4g::ColorMode::NEVER);
+    ose4g::CommandProcessorImpl processor("allocbench");
+    std::size_t received = 0;
+    ose4g::Command command = line.substr(0, line.find(' '));
+    processor.add(command, [&](const ose4g::Args &args)
+                  { received += args.size(); });
+
+    ose4g::Command parsed;
+    ose4g::Args args;
+    std::array<std::byte, 4096> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    measure("parse", commands, [&]
+            {
+                arena.release();
+                processor.parseStatement(line, parsed, args, &arena); });
+    measure("parse + process", commands, [&]
+            {
+                arena.release();
+                processor.parseStatement(line, parsed, args, &arena);
+                processor.process(parsed, args); });
+    measure("execute", commands, [&]
+            { processor.execute(line); });
+
+    ose4g::redirectOutput(console);
+    return received > 0 ? 0 : 1;
+}
@@ -1,21 +1,98 @@
 #include "autocomplete.h"
+#include <algorithm>
 
 namespace ose4g
 {
+    namespace
+    {
+        template <typename... Args>
+        std::shared_ptr<AutoComplete::Node> makeNode(Args&&... args)
+        {
+            return makeCounted<AutoComplete::Node>(MemoryCategory::COMPLETION, std::forward<Args>(args)...);
+        }
+    }
+
     void AutoComplete::add(const std::string& s){
-        auto temp = root.get();
-        for(char c: s)
+        root = insert(root.get(), s);
+    }
+
+    void AutoComplete::addAll(std::vector<std::string> words){
+        if(words.empty())
+        {
+            return;
+        }
+        // sorted, words with a common prefix are next to each other
+        std::sort(words.begin(), words.end());
+        root = insertAll(root.get(), words.data(), words.data() + words.size(), 0);
+    }
+
+    void AutoComplete::remove(const std::string& s){
+        auto updated = erase(root.get(), s);
+        root = updated ? updated : makeNode();
+    }
+
+    std::shared_ptr<const AutoComplete::Node> AutoComplete::insert(const Node* node, std::string_view s)
+    {
+        auto copy = node ? makeNode(*node) : makeNode();
+        if(s.empty())
+        {
+            copy->isWord = true;
+            return copy;
+        }
+        auto& child = copy->children[s[0]];
+        child = insert(child.get(), s.substr(1));
+        return copy;
+    }
+
+    std::shared_ptr<const AutoComplete::Node> AutoComplete::insertAll(const Node* node, const std::string* begin, const std::string* end, std::size_t depth)
+    {
+        auto copy = node ? makeNode(*node) : makeNode();
+        // a word ending here sorts before the longer ones
+        while(begin != end && begin->size() == depth)
         {
-            if(!temp->children[c])
+            copy->isWord = true;
+            begin++;
+        }
+        while(begin != end)
+        {
+            char c = (*begin)[depth];
+            auto last = std::find_if(begin, end, [&](const std::string& word){ return word[depth] != c; });
+            auto& child = copy->children[c];
+            child = insertAll(child.get(), begin, last, depth + 1);
+            begin = last;
+        }
+        return copy;
+    }
+
+    // returns nullptr when the node is left with nothing in it
+    std::shared_ptr<const AutoComplete::Node> AutoComplete::erase(const Node* node, std::string_view s)
+    {
+        auto copy = makeNode(*node);
+        if(s.empty())
+        {
+            copy->isWord = false;
+        }
+        else
+        {
+            auto it = copy->children.find(s[0]);
+            if(it == copy->children.end())
             {
-                temp->children[c] = std::make_unique<Node>();
+                return copy;
             }
-            temp = temp->children[c].get();
+            it->second = erase(it->second.get(), s.substr(1));
+            if(!it->second)
+            {
+                copy->children.erase(it);
+            }
+        }
+        if(!copy->isWord && copy->children.empty())
+        {
+            return nullptr;
         }
-        temp->isWord = true;
+        return copy;
     }
 
-    void AutoComplete::dfs(AutoComplete::Node* root, std::vector<std::string>& suggestions, std::string path)
+    void AutoComplete::dfs(const AutoComplete::Node* root, std::vector<std::string>& suggestions, std::string path)
     {
         if(root->isWord)
         {
@@ -26,18 +103,19 @@ namespace ose4g
             dfs(node.second.get(), suggestions, path + node.first);
         }
     }
-    std::vector<std::string> AutoComplete::getSuggestions(const std::string& s){
+    std::vector<std::string> AutoComplete::getSuggestions(const std::string& s) const{
         auto temp = root.get();
         std::vector<std::string> suggestions;
         for(char c: s)
         {
-            if(temp->children.find(c) == temp->children.end())
+            auto it = temp->children.find(c);
+            if(it == temp->children.end())
             {
                 return suggestions;
             }
-            temp = temp->children[c].get();
+            temp = it->second.get();
         }
         dfs(temp, suggestions, s);
         return suggestions;
     }   
-}
\ No newline at end of file
+}
@@ -2,38 +2,65 @@
 #define AUTOCOMPLETE_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
+#include "memory.h"
 
 
 
 namespace ose4g
 {
+    /**
+     * Trie of words for prefix suggestions.
+     *
+     * Nodes are immutable and shared, add and remove copy only the path to
+     * the word. Copying an AutoComplete is therefore cheap and the copy is
+     * unaffected by later changes to the original, which lets registry
+     * snapshots carry their own AutoComplete. Nodes are counted as
+     * MemoryCategory::COMPLETION.
+     */
     class AutoComplete{
         public:
             struct Node{
-                std::map<char,std::unique_ptr<Node>> children;
+                CountedMap<char,std::shared_ptr<const Node>> children{CountingAllocator<char>(MemoryCategory::COMPLETION)};
                 bool isWord = false;
             };
         private:
             // Trie Node
-            std::unique_ptr<Node> root;
+            std::shared_ptr<const Node> root;
 
             // depth first search for Trie Node
-            static void dfs(Node* node, std::vector<std::string>& suggestions, std::string path);
+            static void dfs(const Node* node, std::vector<std::string>& suggestions, std::string path);
+
+            // returns a copy of node with s inserted or removed below it
+            static std::shared_ptr<const Node> insert(const Node* node, std::string_view s);
+            static std::shared_ptr<const Node> erase(const Node* node, std::string_view s);
+            // copies node once and inserts sorted words sharing its first depth characters
+            static std::shared_ptr<const Node> insertAll(const Node* node, const std::string* begin, const std::string* end, std::size_t depth);
         public:
-            AutoComplete():root(std::make_unique<Node>()){}
+            AutoComplete():root(makeCounted<Node>(MemoryCategory::COMPLETION)){}
             /**
             * @brief gets suggestions for the given prefix
             */
-            std::vector<std::string> getSuggestions(const std::string& prefix);
+            std::vector<std::string> getSuggestions(const std::string& prefix) const;
 
             /**
             * @brief adds string to a particular suggestion
             */
             void add(const std::string&);
+
+            /**
+            * @brief adds many strings, copying each node they pass through once
+            */
+            void addAll(std::vector<std::string> words);
+
+            /**
+            * @brief removes a string added with add
+            */
+            void remove(const std::string&);
     };
 }
 
-#endif
\ No newline at end of file
+#endif
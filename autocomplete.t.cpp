@@ -19,4 +19,33 @@ TEST(AutoCompleteTest, shouldGetAllMatchingWords){
     autocomplete.add("os4ge");
     auto suggestions = autocomplete.getSuggestions("ose");
     ASSERT_THAT(suggestions, UnorderedElementsAre("ose", "ose4g", "osemudiamen"));
-}
\ No newline at end of file
+}
+
+TEST(AutoCompleteTest, copyShouldNotSeeLaterChanges){
+    ose4g::AutoComplete autocomplete;
+    autocomplete.add("ose");
+    ose4g::AutoComplete copy = autocomplete;
+    autocomplete.add("ose4g");
+    autocomplete.remove("ose");
+    ASSERT_THAT(autocomplete.getSuggestions("ose"), UnorderedElementsAre("ose4g"));
+    ASSERT_THAT(copy.getSuggestions("ose"), UnorderedElementsAre("ose"));
+}
+
+TEST(AutoCompleteTest, removeShouldKeepLongerWords){
+    ose4g::AutoComplete autocomplete;
+    autocomplete.add("ose");
+    autocomplete.add("ose4g");
+    autocomplete.remove("ose4g");
+    autocomplete.remove("missing");
+    ASSERT_THAT(autocomplete.getSuggestions("o"), UnorderedElementsAre("ose"));
+}
+
+TEST(AutoCompleteTest, addingManyShouldMatchAddingOneAtATime){
+    ose4g::AutoComplete autocomplete;
+    autocomplete.add("ose");
+    ose4g::AutoComplete copy = autocomplete;
+    autocomplete.addAll({"osemudiamen", "os4ge", "ose4g", "ose", "b", "os4ge"});
+    ASSERT_THAT(autocomplete.getSuggestions("os"), UnorderedElementsAre("ose", "ose4g", "osemudiamen", "os4ge"));
+    ASSERT_THAT(autocomplete.getSuggestions(""), UnorderedElementsAre("b", "ose", "ose4g", "osemudiamen", "os4ge"));
+    ASSERT_THAT(copy.getSuggestions(""), UnorderedElementsAre("ose"));
+}
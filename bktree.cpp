@@ -0,0 +1,273 @@
+#include "bktree.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+namespace ose4g
+{
+    namespace
+    {
+        std::size_t quadraticDistance(std::string_view from, std::string_view to)
+        {
+            std::vector<std::size_t> row(to.size() + 1);
+            std::iota(row.begin(), row.end(), 0);
+            for (std::size_t i = 1; i <= from.size(); i++)
+            {
+                std::size_t diagonal = row[0];
+                row[0] = i;
+                for (std::size_t j = 1; j <= to.size(); j++)
+                {
+                    std::size_t above = row[j];
+                    row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (from[i - 1] != to[j - 1])});
+                    diagonal = above;
+                }
+            }
+            return row[to.size()];
+        }
+
+        template <typename... Args>
+        std::shared_ptr<BkTree::Node> makeNode(Args &&...args)
+        {
+            return makeCounted<BkTree::Node>(MemoryCategory::SUGGESTIONS, std::forward<Args>(args)...);
+        }
+    }
+
+    EditDistance::EditDistance(std::string_view pattern) : d_pattern(pattern)
+    {
+        if (pattern.size() > 64)
+        {
+            return;
+        }
+        for (std::size_t i = 0; i < pattern.size(); i++)
+        {
+            d_masks[static_cast<unsigned char>(pattern[i])] |= std::uint64_t{1} << i;
+        }
+    }
+
+    std::size_t EditDistance::to(std::string_view word) const
+    {
+        if (d_pattern.size() > 64)
+        {
+            return quadraticDistance(d_pattern, word);
+        }
+        if (d_pattern.empty())
+        {
+            return word.size();
+        }
+        // each bit is one row of the dynamic programming column, Pv/Mv say whether
+        // it is one more or one less than the row above (Hyyrö's form of Myers' algorithm)
+        std::uint64_t positive = ~std::uint64_t{0};
+        std::uint64_t negative = 0;
+        const std::uint64_t last = std::uint64_t{1} << (d_pattern.size() - 1);
+        std::size_t score = d_pattern.size();
+        for (char c : word)
+        {
+            std::uint64_t equal = d_masks[static_cast<unsigned char>(c)];
+            std::uint64_t vertical = equal | negative;
+            std::uint64_t horizontal = (((equal & positive) + positive) ^ positive) | equal;
+            std::uint64_t horizontalPositive = negative | ~(horizontal | positive);
+            std::uint64_t horizontalNegative = positive & horizontal;
+            if (horizontalPositive & last)
+            {
+                score++;
+            }
+            else if (horizontalNegative & last)
+            {
+                score--;
+            }
+            // the first row grows by one per character of word
+            horizontalPositive = (horizontalPositive << 1) | 1;
+            horizontalNegative <<= 1;
+            positive = horizontalNegative | ~(vertical | horizontalPositive);
+            negative = horizontalPositive & vertical;
+        }
+        return score;
+    }
+
+    std::size_t editDistance(std::string_view from, std::string_view to)
+    {
+        // the distance is symmetric, use whichever side fits in a machine word
+        if (from.size() > 64 && to.size() <= 64)
+        {
+            std::swap(from, to);
+        }
+        return EditDistance(from).to(to);
+    }
+
+    std::shared_ptr<const BkTree::Node> BkTree::erase(const std::shared_ptr<const Node> &node, const EditDistance &query, bool &erased)
+    {
+        if (!node)
+        {
+            return node;
+        }
+        std::size_t distance = query.to(node->word);
+        if (distance == 0)
+        {
+            if (node->removed)
+            {
+                return node;
+            }
+            erased = true;
+            // the word still routes searches to its children
+            auto copy = makeNode(*node);
+            copy->removed = true;
+            return copy;
+        }
+        auto found = node->children.find(distance);
+        if (found == node->children.end())
+        {
+            return node;
+        }
+        auto child = erase(found->second, query, erased);
+        if (child == found->second)
+        {
+            return node;
+        }
+        auto copy = makeNode(*node);
+        copy->children[distance] = std::move(child);
+        return copy;
+    }
+
+    void BkTree::collect(const Node &node, std::vector<std::string> &words)
+    {
+        if (!node.removed)
+        {
+            words.emplace_back(node.word);
+        }
+        for (auto &child : node.children)
+        {
+            collect(*child.second, words);
+        }
+    }
+
+    void BkTree::add(const std::string &word)
+    {
+        addAll({word});
+    }
+
+    void BkTree::addAll(const std::vector<std::string> &words)
+    {
+        // nodes created by this call, no other tree can see them yet
+        std::unordered_set<const Node *> owned;
+        auto writable = [&](std::shared_ptr<const Node> &slot) -> Node &
+        {
+            if (!owned.contains(slot.get()))
+            {
+                slot = makeNode(*slot);
+                owned.insert(slot.get());
+            }
+            return const_cast<Node &>(*slot);
+        };
+        std::vector<std::size_t> path;
+        for (auto &word : words)
+        {
+            auto leaf = makeNode();
+            leaf->word.assign(word);
+            if (!d_root)
+            {
+                owned.insert(leaf.get());
+                d_root = std::move(leaf);
+                d_size++;
+                continue;
+            }
+            // find where the word goes without changing anything, the masks are built once for the whole path
+            EditDistance query(word);
+            path.clear();
+            const Node *node = d_root.get();
+            bool present = false;
+            while (true)
+            {
+                std::size_t distance = query.to(node->word);
+                if (distance == 0)
+                {
+                    present = !node->removed;
+                    break;
+                }
+                path.push_back(distance);
+                auto child = node->children.find(distance);
+                if (child == node->children.end())
+                {
+                    break;
+                }
+                node = child->second.get();
+            }
+            if (present)
+            {
+                continue;
+            }
+            // node may be freed once copied below
+            bool revive = std::string_view(node->word) == word;
+            // copy the path down to the change, the rest is shared with the old tree
+            Node *target = &writable(d_root);
+            std::size_t steps = revive ? path.size() : path.size() - 1;
+            for (std::size_t i = 0; i < steps; i++)
+            {
+                target = &writable(target->children[path[i]]);
+            }
+            if (revive)
+            {
+                target->removed = false;
+                d_removed--;
+            }
+            else
+            {
+                owned.insert(leaf.get());
+                target->children[path.back()] = std::move(leaf);
+            }
+            d_size++;
+        }
+    }
+
+    void BkTree::remove(const std::string &word)
+    {
+        bool erased = false;
+        d_root = erase(d_root, EditDistance(word), erased);
+        if (!erased)
+        {
+            return;
+        }
+        d_size--;
+        d_removed++;
+        if (d_removed > d_size)
+        {
+            std::vector<std::string> words;
+            words.reserve(d_size);
+            collect(*d_root, words);
+            *this = BkTree();
+            addAll(words);
+        }
+    }
+
+    std::vector<BkTree::Match> BkTree::search(std::string_view word, std::size_t maxDistance, std::size_t limit) const
+    {
+        std::vector<Match> matches;
+        if (!d_root)
+        {
+            return matches;
+        }
+        EditDistance query(word);
+        std::vector<const Node *> pending{d_root.get()};
+        while (!pending.empty())
+        {
+            const Node *node = pending.back();
+            pending.pop_back();
+            std::size_t distance = query.to(node->word);
+            if (distance <= maxDistance && !node->removed)
+            {
+                matches.emplace_back(distance, node->word);
+            }
+            // by the triangle inequality only these children can hold close enough words
+            auto child = node->children.lower_bound(distance > maxDistance ? distance - maxDistance : 0);
+            for (; child != node->children.end() && child->first <= distance + maxDistance; child++)
+            {
+                pending.push_back(child->second.get());
+            }
+        }
+        std::sort(matches.begin(), matches.end());
+        if (matches.size() > limit)
+        {
+            matches.resize(limit);
+        }
+        return matches;
+    }
+}
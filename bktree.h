@@ -0,0 +1,89 @@
+#ifndef BKTREE_H
+#define BKTREE_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "memory.h"
+
+namespace ose4g
+{
+    /**
+     * @brief Levenshtein distance from one pattern to many words.
+     *
+     * Uses Myers' bit-parallel algorithm: the pattern's character masks are
+     * built once and each word is then compared in one pass of a few word
+     * operations per character. Patterns longer than 64 characters fall back
+     * to the quadratic algorithm.
+     */
+    class EditDistance
+    {
+    private:
+        std::string d_pattern;
+        std::array<std::uint64_t, 256> d_masks{};
+
+    public:
+        explicit EditDistance(std::string_view pattern);
+
+        /// @brief insertions, deletions and substitutions turning the pattern into word
+        std::size_t to(std::string_view word) const;
+    };
+
+    /// @brief Levenshtein distance between two strings
+    std::size_t editDistance(std::string_view from, std::string_view to);
+
+    /**
+     * @brief BK-tree of words for nearest match lookups by edit distance.
+     *
+     * A search only visits children whose distance to their parent can still
+     * lead to a close enough word, a small fraction of the tree for small
+     * distances. Like AutoComplete, nodes are immutable and shared so copies
+     * are cheap and independent. Removed words stay in the tree to route
+     * searches until removed words outnumber the others, then it is rebuilt.
+     * Nodes are counted as MemoryCategory::SUGGESTIONS.
+     */
+    class BkTree
+    {
+    public:
+        struct Node
+        {
+            CountedString word{CountingAllocator<char>(MemoryCategory::SUGGESTIONS)};
+            bool removed = false;
+            CountedMap<std::size_t, std::shared_ptr<const Node>> children{CountingAllocator<char>(MemoryCategory::SUGGESTIONS)};
+        };
+
+        /// @brief a word found by search and its distance from the query
+        using Match = std::pair<std::size_t, std::string>;
+
+    private:
+        std::shared_ptr<const Node> d_root;
+        std::size_t d_size = 0;
+        std::size_t d_removed = 0;
+
+        static std::shared_ptr<const Node> erase(const std::shared_ptr<const Node> &node, const EditDistance &query, bool &erased);
+        static void collect(const Node &node, std::vector<std::string> &words);
+
+    public:
+        void add(const std::string &word);
+
+        /// @brief adds many words, nodes copied for an earlier word are changed in place for later ones
+        void addAll(const std::vector<std::string> &words);
+        void remove(const std::string &word);
+
+        /**
+         * @brief words within maxDistance of word, closest first and then alphabetically.
+         *
+         * @param limit most matches returned.
+         */
+        std::vector<Match> search(std::string_view word, std::size_t maxDistance, std::size_t limit) const;
+
+        std::size_t size() const { return d_size; }
+    };
+}
+
+#endif
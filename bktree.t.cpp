@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "bktree.h"
+
+namespace
+{
+    std::size_t slowDistance(const std::string &from, const std::string &to)
+    {
+        std::vector<std::vector<std::size_t>> table(from.size() + 1, std::vector<std::size_t>(to.size() + 1));
+        for (std::size_t i = 0; i <= from.size(); i++)
+            table[i][0] = i;
+        for (std::size_t j = 0; j <= to.size(); j++)
+            table[0][j] = j;
+        for (std::size_t i = 1; i <= from.size(); i++)
+            for (std::size_t j = 1; j <= to.size(); j++)
+                table[i][j] = std::min({table[i - 1][j] + 1, table[i][j - 1] + 1, table[i - 1][j - 1] + (from[i - 1] != to[j - 1])});
+        return table[from.size()][to.size()];
+    }
+
+    std::string randomWord(std::mt19937 &random, std::size_t maxLength)
+    {
+        std::string word(random() % (maxLength + 1), 'a');
+        for (auto &c : word)
+            c = "abcd-"[random() % 5];
+        return word;
+    }
+}
+
+TEST(EditDistanceTest, shouldMatchDynamicProgramming)
+{
+    std::mt19937 random(3);
+    // lengths past 64 use the fallback
+    for (int i = 0; i < 2000; i++)
+    {
+        std::string from = randomWord(random, i % 10 == 0 ? 90 : 20);
+        std::string to = randomWord(random, i % 7 == 0 ? 90 : 20);
+        ASSERT_EQ(ose4g::editDistance(from, to), slowDistance(from, to)) << from << ' ' << to;
+    }
+    EXPECT_EQ(ose4g::editDistance("hepl", "help"), 2u);
+    EXPECT_EQ(ose4g::editDistance("", "help"), 4u);
+    EXPECT_EQ(ose4g::EditDistance("kitten").to("sitting"), 3u);
+}
+
+TEST(BkTreeTest, searchShouldFindEveryWordWithinDistance)
+{
+    std::mt19937 random(5);
+    ose4g::BkTree tree;
+    std::vector<std::string> words;
+    for (int i = 0; i < 500; i++)
+    {
+        words.push_back(randomWord(random, 8));
+        tree.add(words.back());
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    EXPECT_EQ(tree.size(), words.size());
+
+    for (int i = 0; i < 50; i++)
+    {
+        std::string query = randomWord(random, 8);
+        std::vector<ose4g::BkTree::Match> expected;
+        for (auto &word : words)
+        {
+            if (auto distance = slowDistance(query, word); distance <= 2)
+                expected.emplace_back(distance, word);
+        }
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(tree.search(query, 2, words.size()), expected) << query;
+    }
+}
+
+TEST(BkTreeTest, removedWordsShouldNotBeFoundAndCopiesShouldBeIndependent)
+{
+    ose4g::BkTree tree;
+    for (auto word : {"help", "hello", "history", "halt", "held"})
+        tree.add(word);
+    ose4g::BkTree copy = tree;
+
+    tree.remove("hello");
+    tree.remove("held");
+    EXPECT_EQ(tree.size(), 3u);
+    EXPECT_EQ(tree.search("helo", 2, 10), (std::vector<ose4g::BkTree::Match>{{1, "help"}, {2, "halt"}}));
+    EXPECT_EQ(copy.search("helo", 1, 10), (std::vector<ose4g::BkTree::Match>{{1, "held"}, {1, "hello"}, {1, "help"}}));
+
+    // enough removals rebuild the tree, adding back still works
+    tree.remove("halt");
+    tree.remove("history");
+    tree.add("hello");
+    EXPECT_EQ(tree.size(), 2u);
+    EXPECT_EQ(tree.search("helo", 1, 1), (std::vector<ose4g::BkTree::Match>{{1, "hello"}}));
+}
+
+TEST(BkTreeTest, addingManyShouldMatchAddingOneAtATime)
+{
+    std::mt19937 random(9);
+    std::vector<std::string> words;
+    ose4g::BkTree one;
+    for (int i = 0; i < 300; i++)
+    {
+        words.push_back(randomWord(random, 8));
+        one.add(words.back());
+    }
+    ose4g::BkTree many;
+    many.addAll({"abc", "dd"});
+    ose4g::BkTree before = many;
+    many.remove("abc");
+    many.addAll(words);
+    many.remove("dd");
+
+    EXPECT_EQ(many.size(), one.size());
+    for (int i = 0; i < 50; i++)
+    {
+        std::string query = randomWord(random, 8);
+        EXPECT_EQ(many.search(query, 2, 1000), one.search(query, 2, 1000)) << query;
+    }
+    EXPECT_EQ(before.size(), 2u);
+    EXPECT_EQ(before.search("abc", 0, 1).size(), 1u);
+}
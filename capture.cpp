@@ -0,0 +1,116 @@
+#include "capture.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+
+namespace ose4g
+{
+    namespace
+    {
+        thread_local std::string *t_target = nullptr;
+        thread_local const OutputCapture::Sink *t_sink = nullptr;
+
+        /// streambuf installed in std::cout for the whole run of the program.
+        /// It has no put area so every write reaches xsputn/overflow and is
+        /// routed by the calling thread.
+        class RoutingBuffer : public std::streambuf
+        {
+        public:
+            std::atomic<std::streambuf *> d_downstream = nullptr;
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    return traits_type::not_eof(c);
+                }
+                if (t_target)
+                {
+                    t_target->push_back(traits_type::to_char_type(c));
+                    return c;
+                }
+                if (t_sink)
+                {
+                    char ch = traits_type::to_char_type(c);
+                    (*t_sink)(std::string_view(&ch, 1));
+                    return c;
+                }
+                auto downstream = d_downstream.load();
+                return downstream ? downstream->sputc(traits_type::to_char_type(c)) : traits_type::eof();
+            }
+
+            std::streamsize xsputn(const char *s, std::streamsize n) override
+            {
+                if (t_target)
+                {
+                    t_target->append(s, n);
+                    return n;
+                }
+                if (t_sink)
+                {
+                    (*t_sink)(std::string_view(s, n));
+                    return n;
+                }
+                auto downstream = d_downstream.load();
+                return downstream ? downstream->sputn(s, n) : 0;
+            }
+
+            int sync() override
+            {
+                auto downstream = d_downstream.load();
+                return t_target || t_sink || !downstream ? 0 : downstream->pubsync();
+            }
+        };
+
+        std::mutex s_mutex;
+        // never destroyed, std::cout is flushed after static destructors have run
+        RoutingBuffer &s_buffer = *new RoutingBuffer;
+
+        void install()
+        {
+            s_buffer.d_downstream = std::cout.rdbuf();
+            std::cout.rdbuf(&s_buffer);
+        }
+
+        // std::cout is set up by the <iostream> include above, this runs before main starts any thread
+        const bool s_installed = (install(), true);
+
+        void ensureInstalled()
+        {
+            // only if std::cout.rdbuf was replaced behind our back, which is the replacer's race
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (std::cout.rdbuf() != &s_buffer)
+            {
+                install();
+            }
+        }
+    }
+
+    OutputCapture::OutputCapture(std::string &target) : d_previous(t_target), d_previousSink(t_sink)
+    {
+        ensureInstalled();
+        t_target = &target;
+        t_sink = nullptr;
+    }
+
+    OutputCapture::OutputCapture(Sink sink) : d_previous(t_target), d_previousSink(t_sink), d_sink(std::move(sink))
+    {
+        ensureInstalled();
+        t_target = nullptr;
+        t_sink = &d_sink;
+    }
+
+    OutputCapture::~OutputCapture()
+    {
+        t_target = d_previous;
+        t_sink = d_previousSink;
+    }
+
+    std::streambuf *redirectOutput(std::streambuf *buffer)
+    {
+        ensureInstalled();
+        return s_buffer.d_downstream.exchange(buffer);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <functional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+
+namespace ose4g
+{
+    /**
+     * @brief Redirects everything the current thread writes to std::cout into a string.
+     *
+     * Handlers print to std::cout, this lets their output be sent somewhere
+     * else (a socket, a cache) without changing them. Other threads keep
+     * writing to the real std::cout while a capture is active. Captures nest.
+     *
+     * Output is routed by a streambuf put in std::cout once at startup, so
+     * starting and ending a capture never touches std::cout itself and is
+     * safe while other threads write to it.
+     */
+    class OutputCapture
+    {
+    public:
+        using Sink = std::function<void(std::string_view)>;
+
+    private:
+        std::string *d_previous;
+        const Sink *d_previousSink;
+        Sink d_sink;
+
+    public:
+        explicit OutputCapture(std::string &target);
+
+        /// @brief passes every write to sink as it happens instead of collecting it
+        explicit OutputCapture(Sink sink);
+        ~OutputCapture();
+
+        OutputCapture(const OutputCapture &) = delete;
+        OutputCapture &operator=(const OutputCapture &) = delete;
+    };
+
+    /**
+     * @brief sends std::cout output that no capture takes to buffer instead.
+     *
+     * Use it rather than std::cout.rdbuf, which would take the routing
+     * streambuf out and capture nothing until the next capture puts it back.
+     * Output written by other threads while it is called may go to either buffer.
+     *
+     * @returns the buffer output went to before.
+     */
+    std::streambuf *redirectOutput(std::streambuf *buffer);
+}
+
+#endif
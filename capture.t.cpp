@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "capture.h"
+
+TEST(OutputCaptureTest, shouldCaptureOnlyTheCurrentThread)
+{
+    std::stringstream console;
+    auto original = ose4g::redirectOutput(console.rdbuf());
+    std::string captured;
+    {
+        ose4g::OutputCapture capture(captured);
+        std::cout << "captured " << 42 << std::endl;
+        std::thread([]
+                    { std::cout << "console" << std::flush; })
+            .join();
+    }
+    std::cout << " after";
+    ose4g::redirectOutput(original);
+
+    EXPECT_EQ(captured, "captured 42\n");
+    EXPECT_EQ(console.str(), "console after");
+}
+
+TEST(OutputCaptureTest, capturesShouldNest)
+{
+    std::string outer, inner;
+    {
+        ose4g::OutputCapture first(outer);
+        std::cout << "a";
+        {
+            ose4g::OutputCapture second(inner);
+            std::cout << "b";
+        }
+        std::cout << "c";
+    }
+    EXPECT_EQ(outer, "ac");
+    EXPECT_EQ(inner, "b");
+}
+
+TEST(OutputCaptureTest, capturesShouldNotTouchStdCout)
+{
+    auto *installed = std::cout.rdbuf();
+    std::string captured;
+    {
+        ose4g::OutputCapture capture(captured);
+        EXPECT_EQ(std::cout.rdbuf(), installed);
+    }
+    EXPECT_EQ(std::cout.rdbuf(), installed);
+}
@@ -1,184 +1,1471 @@
 #include "command-processor.h"
 #include "util.h"
+#include "style.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <memory_resource>
 #include <iostream>
 #include <format>
-#include <regex>
+#include <condition_variable>
+#include <deque>
 #include <exception>
+#include <fstream>
+#include <set>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include "keyboardinput.h"
+#include "capture.h"
+#include "threadpool.h"
+#include "tokenizer.h"
+#include "trace.h"
 
 namespace ose4g
 {
-    CommandProcessorImpl::CommandProcessorImpl(const std::string &name) : d_name(name), d_commandPattern("^[A-Za-z][A-Za-z0-9-]*$") {
-        d_autocomplete.add("help");
-        d_autocomplete.add("exit");
-        d_autocomplete.add("clear");
-        d_autocomplete.add("history");
+    namespace
+    {
+        constexpr Style COMMAND_STYLE(Color::BLUE);
+        constexpr Style ERROR_STYLE(Color::RED);
+        constexpr Style PROMPT_STYLE(Color::GREEN);
+
+        struct Builtin
+        {
+            std::string_view name;
+            std::string_view description;
+        };
+
+        // handled by dispatch itself, in the order help lists them
+        constexpr std::array<Builtin, 10> BUILTINS{{
+            {"help", "lists all commands and their description"},
+            {"clear", "clear screen"},
+            {"exit", "exit program"},
+            {"history", "print history"},
+            {"alias", "list aliases or define one: alias name = command args; command args"},
+            {"trace", "record a timeline: trace start, then trace stop <file>"},
+            {"parallel", "run a command once per argument: parallel [-j N] [--unordered] command args ::: arg1 arg2"},
+            {"mem", "print the memory the process uses for commands, completion and history"},
+            {"every", "run a command periodically: every [--coalesce] 5s command args, every to list, every cancel id|all"},
+            {"watch", "run a command every 2s: watch [--coalesce] command args"},
+        }};
+
+        // scheduled output waiting for the console command to finish, beyond this the oldest lines are dropped
+        constexpr std::size_t SCHEDULED_OUTPUT_LIMIT = 64 * 1024;
+
+        void printHelpLine(std::ostream &out, std::string_view command, std::string_view description)
+        {
+            out << '\t' << styled(command, COMMAND_STYLE) << ": " << description << '\n';
+        }
+    }
+
+    bool CommandProcessorImpl::isBuiltin(std::string_view command)
+    {
+        return std::any_of(BUILTINS.begin(), BUILTINS.end(), [&](const Builtin &builtin)
+                           { return builtin.name == command; });
+    }
+
+    bool CommandProcessorImpl::reachesBuiltin(const Command &command)
+    {
+        std::vector<Command> pending{command};
+        std::vector<Command> seen;
+        while (!pending.empty())
+        {
+            Command next = std::move(pending.back());
+            pending.pop_back();
+            if (isBuiltin(next))
+            {
+                return true;
+            }
+            if (std::find(seen.begin(), seen.end(), next) != seen.end())
+            {
+                continue;
+            }
+            auto entry = d_registry.find(next);
+            if (entry && entry->macro)
+            {
+                for (auto &step : entry->macro->commands())
+                {
+                    pending.push_back(step);
+                }
+            }
+            seen.push_back(std::move(next));
+        }
+        return false;
+    }
+
+    CommandProcessorImpl::CommandProcessorImpl(const std::string &name) : d_name(name), d_prompt(name + " => "),
+        d_session([this](const std::string &input) { return complete(input); }) {
+        d_session.schedules->sink = [this](const std::string &output)
+        { showScheduled(output); };
+        d_registry.update([](CommandRegistry::Snapshot &snapshot)
+                          {
+            for (auto &builtin : BUILTINS)
+            {
+                snapshot.autocomplete.add(std::string(builtin.name));
+                snapshot.names.add(std::string(builtin.name));
+            } });
+    }
+
+    void CommandProcessorImpl::help()
+    {
+        // write straight to the stream so large registries never build one big string
+        for (auto &builtin : BUILTINS)
+        {
+            printHelpLine(std::cout, builtin.name, builtin.description);
+        }
+
+        RcuReadGuard guard;
+        auto &commands = d_registry.current().commands;
+        std::vector<std::pair<const Command *, const CommandEntry *>> sorted;
+        sorted.reserve(commands.size());
+        for (auto &command : commands)
+        {
+            sorted.emplace_back(&command.first, command.second.get());
+        }
+        std::sort(sorted.begin(), sorted.end(), [](auto &lhs, auto &rhs)
+                  { return *lhs.first < *rhs.first; });
+        for (auto &command : sorted)
+        {
+            printHelpLine(std::cout, *command.first, command.second->description);
+        }
+        std::cout << std::flush;
+    }
+
+    void CommandProcessorImpl::help(const CommandPath &path)
+    {
+        if (path.empty())
+        {
+            help();
+            return;
+        }
+        auto entry = findEntry(path);
+        if (!entry)
+        {
+            throw std::invalid_argument("No help for unknown command");
+        }
+        printHelpLine(std::cout, path.back(), entry->description);
+        printSubcommands(*entry);
+    }
+
+    void CommandProcessorImpl::printSubcommands(const CommandEntry &entry)
+    {
+        for (auto &subcommand : entry.subcommands)
+        {
+            std::cout << '\t';
+            printHelpLine(std::cout, subcommand.first, subcommand.second->description);
+        }
+        std::cout << std::flush;
+    }
+
+    void CommandProcessorImpl::checkPath(const CommandPath &path)
+    {
+        if (path.empty())
+        {
+            throw std::invalid_argument("invalid argument provided for command");
+        }
+        const Command &command = path[0];
+        if (isBuiltin(command))
+        {
+            throw std::invalid_argument("invalid argument provided for command");
+        }
+        for (auto &name : path)
+        {
+            if (!isValidName(name))
+            {
+                throw std::invalid_argument("invalid argument provided for command");
+            }
+        }
+    }
+
+    void CommandProcessorImpl::addProcessor(const CommandPath &path, CommandEntry::Processor processor, const std::vector<Rule *> &validateRules,
+                                            const std::string &description, const CommandOptions &options)
+    {
+        checkPath(path);
+        addEntry(path, {.processor = std::move(processor), .description = description, .rules = validateRules, .options = options});
+    }
+
+    void CommandProcessorImpl::addGroup(const CommandPath &path, const std::string &description)
+    {
+        checkPath(path);
+        addEntry(path, {.description = description});
+    }
+
+    void CommandProcessorImpl::addEntry(const CommandPath &path, CommandEntry entry)
+    {
+        std::vector<std::pair<CommandPath, CommandEntry>> entries;
+        entries.emplace_back(path, std::move(entry));
+        addEntries(std::move(entries));
+    }
+
+    void CommandProcessorImpl::addEntries(std::vector<std::pair<CommandPath, CommandEntry>> entries)
+    {
+        for (auto &[path, entry] : entries)
+        {
+            if (entry.options.cacheTtl.count() > 0)
+            {
+                if (!entry.processor)
+                {
+                    throw std::invalid_argument("only commands with a processor can be cached");
+                }
+                entry.cache = std::make_shared<ResultCache>(entry.options.cacheTtl, entry.options.cacheSize);
+            }
+        }
+        d_registry.update([&](CommandRegistry::Snapshot &snapshot)
+                          { snapshot.insertAll(entries); });
+    }
+
+    std::pair<CommandPath, CommandEntry> CommandProcessorImpl::makeEntry(const CommandDefinition &definition)
+    {
+        checkPath({definition.command});
+        if (!definition.processor)
+        {
+            throw std::invalid_argument("processor must not be empty");
+        }
+        return {{definition.command},
+                {.processor = countedCallable(MemoryCategory::HANDLERS, [processor = definition.processor](const Args &args, std::stop_token)
+                                              { processor(args); }),
+                 .description = definition.description,
+                 .rules = definition.rules,
+                 .options = definition.options}};
+    }
+
+    void CommandProcessorImpl::remove(const Command &command)
+    {
+        removeSubcommand({command});
+    }
+
+    void CommandProcessorImpl::defineAlias(const Command &name, const std::string &definition, const std::string &description)
+    {
+        std::vector<Macro::Step> steps;
+        std::size_t start = 0;
+        char quote = 0;
+        for (std::size_t i = 0; i <= definition.size(); i++)
+        {
+            char c = i < definition.size() ? definition[i] : ';';
+            if (quote)
+            {
+                quote = c == quote ? 0 : quote;
+                if (i < definition.size())
+                {
+                    continue;
+                }
+            }
+            if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+            else if (c == ';')
+            {
+                Macro::Step step;
+                if (!parseStatement(definition.substr(start, i - start), step.first, step.second))
+                {
+                    throw std::invalid_argument("Invalid alias definition");
+                }
+                if (!step.first.empty())
+                {
+                    steps.push_back(std::move(step));
+                }
+                start = i + 1;
+            }
+        }
+        defineMacro(name, std::move(steps), description);
+    }
+
+    void CommandProcessorImpl::defineMacro(const Command &name, std::vector<Macro::Step> steps, const std::string &description)
+    {
+        checkPath({name});
+        auto macro = std::make_shared<const Macro>(std::move(steps));
+        CommandEntry entry{.macro = macro, .description = description.empty() ? "alias for " + macro->text() : description};
+        d_registry.update([&](CommandRegistry::Snapshot &snapshot)
+                          {
+            // follow the aliases this one calls, reaching name again means it would never finish
+            std::vector<Command> pending = macro->commands();
+            std::set<Command> seen;
+            while (!pending.empty())
+            {
+                Command next = std::move(pending.back());
+                pending.pop_back();
+                if (next == name)
+                {
+                    throw std::invalid_argument("alias " + name + " would call itself");
+                }
+                auto found = snapshot.commands.find(next);
+                if (!found || !(*found)->macro || !seen.insert(next).second)
+                {
+                    continue;
+                }
+                auto called = (*found)->macro->commands();
+                pending.insert(pending.end(), called.begin(), called.end());
+            }
+            auto existing = snapshot.commands.find(name);
+            if (existing && (*existing)->macro)
+            {
+                snapshot.erase({name});
+            }
+            snapshot.insert({name}, entry); });
+    }
+
+    void CommandProcessorImpl::printAliases()
+    {
+        RcuReadGuard guard;
+        std::vector<std::pair<const Command *, const Macro *>> aliases;
+        for (auto &command : d_registry.current().commands)
+        {
+            if (command.second->macro)
+            {
+                aliases.emplace_back(&command.first, command.second->macro.get());
+            }
+        }
+        std::sort(aliases.begin(), aliases.end(), [](auto &lhs, auto &rhs)
+                  { return *lhs.first < *rhs.first; });
+        for (auto &alias : aliases)
+        {
+            std::cout << '\t' << styled(*alias.first, COMMAND_STYLE) << " = " << alias.second->text() << '\n';
+        }
+        std::cout << std::flush;
+    }
+
+    std::shared_ptr<Plugin> CommandProcessorImpl::loadPlugin(const std::string &manifestPath)
+    {
+        auto plugin = std::make_shared<Plugin>(manifestPath);
+        std::vector<std::pair<CommandPath, CommandEntry>> entries;
+        entries.reserve(plugin->commands().size());
+        for (auto &declared : plugin->commands())
+        {
+            checkPath({declared.command});
+            entries.push_back({{declared.command},
+                               {.processor = countedCallable(MemoryCategory::HANDLERS, [plugin, command = declared.command](const Args &args, std::stop_token)
+                                                             { plugin->call(command, args); }),
+                                .description = declared.description}});
+        }
+        addEntries(std::move(entries));
+        return plugin;
+    }
+
+    void CommandProcessorImpl::loadRcFile(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::invalid_argument("cannot open " + path);
+        }
+        std::string line;
+        for (int number = 1; std::getline(file, line); number++)
+        {
+            auto first = line.find_first_not_of(" \t");
+            if (first == std::string::npos || line[first] == '#')
+            {
+                continue;
+            }
+            try
+            {
+                Command command;
+                Args args;
+                if (!parseStatement(line, command, args))
+                {
+                    throw std::invalid_argument("Invalid input");
+                }
+                dispatch(d_session, command, args, {}, line);
+            }
+            catch (const std::exception &exc)
+            {
+                throw std::invalid_argument(path + ":" + std::to_string(number) + ": " + exc.what());
+            }
+        }
+    }
+
+    std::shared_ptr<const CommandEntry> CommandProcessorImpl::findEntry(const CommandPath &path)
+    {
+        auto entry = path.empty() ? nullptr : d_registry.find(path[0]);
+        for (std::size_t i = 1; entry && i < path.size(); i++)
+        {
+            auto child = entry->subcommands.find(path[i]);
+            entry = child == entry->subcommands.end() ? nullptr : child->second;
+        }
+        return entry;
+    }
+
+    void CommandProcessorImpl::invalidateCache(const CommandPath &path)
+    {
+        auto entry = findEntry(path);
+        if (!entry)
+        {
+            throw std::invalid_argument("Unknown command");
+        }
+        if (entry->cache)
+        {
+            entry->cache->clear();
+        }
+    }
+
+    ResultCache::Stats CommandProcessorImpl::cacheStats(const CommandPath &path)
+    {
+        auto entry = findEntry(path);
+        if (!entry)
+        {
+            throw std::invalid_argument("Unknown command");
+        }
+        return entry->cache ? entry->cache->stats() : ResultCache::Stats{};
+    }
+
+    void CommandProcessorImpl::setDefaultTimeout(std::chrono::milliseconds timeout)
+    {
+        d_defaultTimeout = timeout;
+    }
+
+    void CommandProcessorImpl::setPager(const PagerOptions &options)
+    {
+        d_pagerOptions = options;
+    }
+
+    void CommandProcessorImpl::setHistoryByteLimit(std::size_t bytes)
+    {
+        d_historyByteLimit = bytes;
+        d_session.history.setByteLimit(bytes);
+    }
+
+    void CommandProcessorImpl::printMemory(const Session &session)
+    {
+        auto usage = memoryUsage();
+        auto print = [](std::string_view name, const MemoryUsage::Counter &counter)
+        {
+            std::cout << '\t' << styled(name, COMMAND_STYLE) << ": " << counter.bytes << " bytes in " << counter.allocations << " allocations\n";
+        };
+        for (std::size_t i = 0; i < MEMORY_CATEGORIES; i++)
+        {
+            print(memoryCategoryName(static_cast<MemoryCategory>(i)), usage.categories[i]);
+        }
+        print("total", usage.total());
+        std::cout << "\tthis session's history: " << session.history.size() << " lines in " << session.history.bytes() << " bytes";
+        if (session.history.byteLimit() > 0)
+        {
+            std::cout << " of " << session.history.byteLimit();
+        }
+        std::cout << std::endl;
+    }
+
+    void CommandProcessorImpl::removeSubcommand(const CommandPath &path)
+    {
+        d_registry.update([&](CommandRegistry::Snapshot &snapshot)
+                          { snapshot.erase(path); });
+    }
+
+    void CommandProcessorImpl::run()
+    {
+        
+        clearScreen();
+        struct WorkerGuard
+        {
+            CommandProcessorImpl &processor;
+            ~WorkerGuard()
+            {
+                processor.stopWorker();
+                processor.setTerminalState(TerminalState::DIRECT);
+            }
+        } workerGuard{*this};
+        while (d_session.isRunning)
+        {
+            KeyboardInput::getInstance().enableKeyboard();
+            const std::string &input = getUserInput();
+            KeyboardInput::getInstance().disableKeyboard();
+            InterruptScope interrupts;
+            executeOnWorker(input);
+        }
+    }
+
+    // hands console commands to a thread that lives as long as run(), see executeOnWorker
+    struct CommandProcessorImpl::Worker
+    {
+        std::mutex mutex;
+        std::condition_variable changed;
+        // a copy, the console reads the next line into the same buffer while an abandoned command still runs
+        std::optional<std::string> input;
+        // requested by Ctrl-C, a new one for each command
+        std::stop_source stop;
+        // set when the command's output goes to the pager
+        std::shared_ptr<OutputSpool> spool;
+        bool done = false;
+        bool abandoned = false;
+        bool quit = false;
+        // the scratch space of an abandoned command, kept until it returns
+        std::unique_ptr<Session::Scratch> scratch;
+        std::thread thread;
+    };
+
+    /*
+     * A handler that ignores its deadline keeps the worker and the console
+     * gets control back. Ctrl-C asks the command to stop through its
+     * stop_token, a second Ctrl-C gives up on it the same way. So does
+     * quitting the pager, the command is given up on if it is still running
+     * a grace period later.
+     */
+    void CommandProcessorImpl::executeOnWorker(const std::string &input)
+    {
+        std::erase_if(d_abandoned, [](const std::shared_ptr<Worker> &abandoned)
+                      {
+            {
+                std::lock_guard lock(abandoned->mutex);
+                if (!abandoned->done)
+                {
+                    return false;
+                }
+            }
+            abandoned->thread.join();
+            return true; });
+        if (!d_worker)
+        {
+            d_worker = std::make_shared<Worker>();
+            d_worker->thread = std::thread(&CommandProcessorImpl::workerLoop, this, d_worker);
+        }
+        Worker &worker = *d_worker;
+        std::size_t rows = 0;
+        std::size_t columns = 0;
+        std::shared_ptr<OutputSpool> spool;
+        if (d_pagerOptions.enabled && terminalSize(rows, columns))
+        {
+            spool = std::make_shared<OutputSpool>(d_pagerOptions);
+        }
+        std::unique_lock lock(worker.mutex);
+        worker.input = input;
+        worker.stop = std::stop_source();
+        worker.spool = spool;
+        worker.done = false;
+        worker.changed.notify_all();
+        lock.unlock();
+
+        int interrupts = 0;
+        // true once the command is to be given up on, call without the lock
+        auto interrupted = [&]
+        {
+            int count = InterruptScope::count();
+            if (count > interrupts)
+            {
+                interrupts = count;
+                worker.stop.request_stop();
+            }
+            return interrupts >= 2;
+        };
+        auto abandon = [&]
+        {
+            if (!worker.done)
+            {
+                worker.abandoned = true;
+            }
+        };
+        std::optional<std::chrono::steady_clock::time_point> quitDeadline;
+        if (spool)
+        {
+            bool complete = showOutput(*spool, rows, columns, [&]
+                                       {
+                bool giveUp = interrupted();
+                std::lock_guard guard(worker.mutex);
+                if (giveUp)
+                {
+                    abandon();
+                }
+                return worker.abandoned; });
+            if (!complete)
+            {
+                // the reader is gone, the command is asked to stop as on Ctrl-C
+                worker.stop.request_stop();
+                quitDeadline = std::chrono::steady_clock::now() + d_watchdog.gracePeriod();
+            }
+        }
+        lock.lock();
+        // a signal handler can not wake the condition variable, the Ctrl-C count is polled
+        while (!worker.changed.wait_for(lock, std::chrono::milliseconds(20), [&]
+                                        { return worker.done || worker.abandoned; }))
+        {
+            lock.unlock();
+            bool giveUp = interrupted() || (quitDeadline && std::chrono::steady_clock::now() >= *quitDeadline);
+            lock.lock();
+            if (giveUp)
+            {
+                abandon();
+            }
+        }
+        if (!worker.abandoned)
+        {
+            return;
+        }
+
+        // an abandoned worker exits after its command, the next command starts a new one
+        bool finished = worker.done;
+        if (finished)
+        {
+            lock.unlock();
+            worker.thread.join();
+        }
+        else
+        {
+            worker.scratch = std::move(d_session.scratch);
+            d_session.scratch = std::make_unique<Session::Scratch>();
+            lock.unlock();
+            d_abandoned.push_back(d_worker);
+        }
+        d_worker.reset();
+        if (!finished)
+        {
+            std::cout << styled("Command did not stop, left running in the background", ERROR_STYLE) << std::endl;
+        }
+    }
+
+    void CommandProcessorImpl::workerLoop(std::shared_ptr<Worker> worker)
+    {
+        std::function<void()> onRunaway = [raw = worker.get()]
+        {
+            std::lock_guard lock(raw->mutex);
+            // the rest of the command must not run once the console has moved on, see dispatch
+            raw->stop.request_stop();
+            raw->abandoned = true;
+            raw->changed.notify_all();
+        };
+        std::unique_lock lock(worker->mutex);
+        while (true)
+        {
+            worker->changed.wait(lock, [&]
+                                 { return worker->input || worker->quit; });
+            if (worker->quit)
+            {
+                return;
+            }
+            std::string input = std::move(*worker->input);
+            worker->input.reset();
+            Context context{worker->stop.get_token(), onRunaway, false};
+            auto spool = worker->spool;
+            lock.unlock();
+            {
+                std::optional<OutputCapture> capture;
+                if (spool)
+                {
+                    capture.emplace([&](std::string_view text)
+                                    { spool->append(text); });
+                }
+                execute(d_session, input, context);
+            }
+            if (spool)
+            {
+                spool->close();
+            }
+            lock.lock();
+            worker->done = true;
+            worker->changed.notify_all();
+            if (worker->abandoned)
+            {
+                return;
+            }
+        }
+    }
+
+    void CommandProcessorImpl::stopWorker()
+    {
+        if (d_worker)
+        {
+            {
+                std::lock_guard lock(d_worker->mutex);
+                d_worker->quit = true;
+                d_worker->changed.notify_all();
+            }
+            d_worker->thread.join();
+            d_worker.reset();
+        }
+        // commands left running still use the processor and the session, run() returns once they do
+        for (auto &abandoned : d_abandoned)
+        {
+            bool done;
+            {
+                std::lock_guard lock(abandoned->mutex);
+                done = abandoned->done;
+            }
+            if (!done)
+            {
+                std::cout << styled("Waiting for a command left running in the background", ERROR_STYLE) << std::endl;
+            }
+            abandoned->thread.join();
+        }
+        d_abandoned.clear();
+    }
+
+    void CommandProcessorImpl::record(const std::string &path)
+    {
+        d_recorder = std::make_shared<SessionRecorder>(path);
+    }
+
+    void CommandProcessorImpl::stopRecording()
+    {
+        d_recorder.store(nullptr);
+    }
+
+    void CommandProcessorImpl::execute(const std::string &input)
+    {
+        execute(d_session, input);
+    }
+
+    void CommandProcessorImpl::execute(Session &session, const std::string &input, const Context &context)
+    {
+        TraceSpan span("command", input);
+        session.history.addBack(input);
+        auto &scratch = *session.scratch;
+        // nothing from the previous command is still using the arena
+        scratch.arena.release();
+        Command &command = scratch.command;
+        Args &args = scratch.args;
+        bool parsed;
+        {
+            TraceSpan span("parse");
+            parsed = parseStatement(input, command, args, &scratch.arena);
+        }
+        if (!parsed)
+        {
+            std::cout << styled("Invalid input", ERROR_STYLE) << std::endl;
+            return;
+        }
+
+        auto recorder = d_recorder.load();
+        // dispatch changes args, keep what was typed for the log
+        Args &recordedArgs = scratch.recordedArgs;
+        if (recorder)
+        {
+            recordedArgs.resize(args.size());
+            for (std::size_t i = 0; i < args.size(); i++)
+            {
+                recordedArgs[i].assign(args[i]);
+            }
+        }
+        auto started = std::chrono::steady_clock::now();
+        bool ok = false;
+        std::string error;
+        try
+        {
+            TraceSpan span("dispatch", command);
+            dispatch(session, command, args, context, input);
+            ok = true;
+            std::cout << std::endl;
+        }
+        catch (const std::invalid_argument &exc)
+        {
+            error = exc.what();
+        }
+        catch (const std::exception &exc)
+        {
+            error = exc.what();
+        }
+        catch (...)
+        {
+            error = "An unknown error occured";
+        }
+        if (!ok)
+        {
+            std::cout << styled(error, ERROR_STYLE) << std::endl;
+        }
+        if (recorder)
+        {
+            recorder->record(command, recordedArgs, started, std::chrono::steady_clock::now() - started, ok, error);
+        }
+    }
+
+    bool CommandProcessorImpl::parseStatement(const std::string &input, Command &command, Args &args)
+    {
+        std::array<std::byte, 1024> buffer;
+        std::pmr::monotonic_buffer_resource scratch(buffer.data(), buffer.size());
+        return parseStatement(input, command, args, &scratch);
+    }
+
+    bool CommandProcessorImpl::parseStatement(std::string_view input, Command &command, Args &args, std::pmr::memory_resource *scratch)
+    {
+        if (input == "")
+        {
+            command.clear();
+            args.clear();
+            return true;
+        }
+
+        // words point into input unless a quoted argument splits them, e.g. ab'cd'ef gives cd and abef
+        std::pmr::vector<std::string_view> seen(scratch);
+        std::pmr::deque<std::pmr::string> joined(scratch);
+        std::string_view word;
+        std::pmr::string *pieces = nullptr;
+        auto endWord = [&]
+        {
+            if (pieces)
+            {
+                seen.push_back(*pieces);
+                pieces = nullptr;
+            }
+            else if (!word.empty())
+            {
+                seen.push_back(word);
+            }
+            word = {};
+        };
+
+        std::size_t i = 0;
+        std::size_t n = input.size();
+        while (i < n)
+        {
+            // skip whole runs of ordinary bytes at once, long payloads are only scanned by findSeparator
+            std::size_t next = i + findSeparator(input.data() + i, n - i);
+            if (next > i)
+            {
+                std::string_view run = input.substr(i, next - i);
+                if (pieces)
+                {
+                    pieces->append(run);
+                }
+                else if (word.empty())
+                {
+                    word = run;
+                }
+                else
+                {
+                    // the word continues after a quoted argument
+                    pieces = &joined.emplace_back(word);
+                    pieces->append(run);
+                }
+            }
+            if (next == n)
+            {
+                break;
+            }
+            if (input[next] == ' ')
+            {
+                endWord();
+                i = next + 1;
+                continue;
+            }
+            // if string is within quotes, find the end quote.
+            std::size_t close = input.find(input[next], next + 1);
+            if (close == std::string_view::npos)
+            {
+                return false;
+            }
+            seen.push_back(input.substr(next + 1, close - next - 1));
+            i = close + 1;
+        }
+        endWord();
+        if (seen.empty())
+        {
+            command.clear();
+            args.clear();
+            return true;
+        }
+        // assign in place so the strings keep their capacity
+        command.assign(seen[0]);
+        args.resize(seen.size() - 1);
+        for (std::size_t j = 1; j < seen.size(); j++)
+        {
+            args[j - 1].assign(seen[j]);
+        }
+        return true;
+    }
+
+    void CommandProcessorImpl::process(const Command &command, Args args)
+    {
+        dispatch(d_session, command, args);
+    }
+
+    void CommandProcessorImpl::dispatch(Session &session, const Command &command, Args &args, const Context &context, std::string_view line)
+    {
+        if (command == "")
+        {
+            return;
+        }
+        // e.g. the steps of an alias after the one that was interrupted, a command left running in the background
+        // gets here only once its handler returns and must not touch the session the console has moved on with
+        if (context.stop.stop_requested())
+        {
+            throw std::runtime_error("Interrupted");
+        }
+        // builtins change or read the session the other calls are using, e.g. through an alias
+        if (context.parallel && isBuiltin(command))
+        {
+            throw std::invalid_argument("parallel cannot run " + command);
+        }
+        if (command == "help")
+        {
+            help(args);
+            return;
+        }
+        if (command == "exit")
+        {
+            session.isRunning = false;
+            return;
+        }
+        if (command == "clear")
+        {
+            clearScreen();
+            return;
+        }
+        if (command == "history")
+        {
+            session.history.write(std::cout);
+            return;
+        }
+        if (command == "trace")
+        {
+            if (args.size() == 1 && args[0] == "start")
+            {
+                startTracing();
+                std::cout << "tracing";
+                return;
+            }
+            if (args.size() == 2 && args[0] == "stop")
+            {
+                auto spans = stopTracing(args[1]);
+                std::cout << "wrote " << spans << " spans to " << args[1];
+                return;
+            }
+            throw std::invalid_argument("usage: trace start, then trace stop <file>");
+        }
+        if (command == "parallel")
+        {
+            runParallel(session, args, context);
+            return;
+        }
+        if (command == "mem")
+        {
+            printMemory(session);
+            return;
+        }
+        if (command == "every" || command == "watch")
+        {
+            runEvery(session, command == "watch", args);
+            return;
+        }
+        if (command == "alias")
+        {
+            if (args.empty())
+            {
+                printAliases();
+                return;
+            }
+            if (args.size() < 3 || args[1] != "=")
+            {
+                throw std::invalid_argument("usage: alias name = command args; command args");
+            }
+            // the tokens no longer say where a ; was quoted, defineAlias splits the text after = instead
+            std::string definition;
+            if (!line.empty())
+            {
+                definition = line.substr(line.find('=') + 1);
+            }
+            else
+            {
+                // called with arguments rather than a line, they are put back together as they would be typed
+                for (std::size_t i = 2; i < args.size(); i++)
+                {
+                    const std::string &arg = args[i];
+                    char quote = arg.find('\'') == std::string::npos ? '\'' : '"';
+                    bool quoted = arg.empty() || arg.find_first_of(" '\"") != std::string::npos;
+                    definition += i > 2 ? " " : "";
+                    definition += quoted ? quote + arg + quote : arg;
+                }
+            }
+            defineAlias(args[0], definition);
+            return;
+        }
+        // holding the entry keeps it alive even if another thread removes the command
+        auto entry = d_registry.find(command);
+        if (!entry)
+        {
+            throw std::invalid_argument(notFound(command));
+        }
+
+        // walk down the tree while the next argument names a subcommand
+        std::size_t depth = 0;
+        while (depth < args.size())
+        {
+            auto child = entry->subcommands.find(args[depth]);
+            if (child == entry->subcommands.end())
+            {
+                break;
+            }
+            entry = child->second;
+            depth++;
+        }
+        args.erase(args.begin(), args.begin() + depth);
+
+        if (entry->macro)
+        {
+            // the registry may have changed since the alias was defined, each step is looked up again
+            for (auto &step : entry->macro->expand(args))
+            {
+                dispatch(session, step.first, step.second, context);
+            }
+            return;
+        }
+        if (!entry->runnable())
+        {
+            if (!args.empty())
+            {
+                throw std::invalid_argument("Unknown subcommand " + args[0]);
+            }
+            printSubcommands(*entry);
+            return;
+        }
+        std::pair<bool, std::string> res;
+        {
+            TraceSpan span("validate");
+            res = validateArgs(*entry, args);
+        }
+        if (!res.first)
+        {
+            throw std::invalid_argument(res.second);
+        }
+
+        if (!entry->cache)
+        {
+            invoke(*entry, command, args, context);
+        }
+        else
+        {
+            auto key = ResultCache::key(args);
+            if (entry->cache->lookup(key, std::cout))
+            {
+                return;
+            }
+            std::string output;
+            try
+            {
+                OutputCapture capture(output);
+                invoke(*entry, command, args, context);
+            }
+            catch (...)
+            {
+                std::cout << output;
+                throw;
+            }
+            std::cout << output;
+            entry->cache->insert(std::move(key), std::move(output));
+        }
+        for (auto &path : entry->options.invalidates)
+        {
+            if (auto target = findEntry(path); target && target->cache)
+            {
+                target->cache->clear();
+            }
+        }
     }
 
-    void CommandProcessorImpl::help()
+    std::string CommandProcessorImpl::notFound(const Command &command)
     {
-        std::string helpMessage = "\t" + addColor("help", Color::BLUE) + ": lists all commands and their description";
-        helpMessage += "\n\t" + addColor("clear", Color::BLUE) + ": clear screen";
-        helpMessage += "\n\t" + addColor("exit", Color::BLUE) + ": exit program";
-        helpMessage += "\n\t" + addColor("history", Color::BLUE) + ": print history";
-        for (auto &command : d_commandDescriptionMap)
+        std::string message = "Command " + command + " not found";
+        // a swap of two letters costs two, allow it unless the name is so short anything would match
+        std::size_t maxDistance = command.size() < 4 ? 1 : std::max<std::size_t>(2, command.size() / 3);
+        std::vector<BkTree::Match> matches;
+        {
+            RcuReadGuard guard;
+            matches = d_registry.current().names.search(command, maxDistance, 3);
+        }
+        for (std::size_t i = 0; i < matches.size(); i++)
         {
-            helpMessage += ("\n\t" + addColor(command.first, Color::BLUE) + ": " + command.second);
+            message += (i == 0 ? ", did you mean " : ", ") + matches[i].second;
         }
-        std::cout << helpMessage << std::endl;
+        return matches.empty() ? message : message + "?";
     }
 
-    void CommandProcessorImpl::add(const Command &command, std::function<void(const Args &)> processor, const std::string &description)
+    // one scheduled command line, parsed once and run with a session of its own
+    struct CommandProcessorImpl::ScheduledCommand
+    {
+        std::string header;
+        Command command;
+        Args args;
+        Session session{LineEditor::Completer()};
+        // the session that scheduled it, which gets the output
+        std::shared_ptr<Session::Schedules> owner;
+    };
+
+    Scheduler::Id CommandProcessorImpl::schedule(std::chrono::milliseconds period, const std::string &line, Scheduler::Overrun overrun)
     {
-        // starts with alphabet.
-        // has alphanumeric characters or -
-        if (!std::regex_match(command, d_commandPattern) || command == "help" || command == "clear" || command == "exit" || command == "history")
+        Command command;
+        Args args;
+        if (!parseStatement(line, command, args) || command.empty())
         {
-            throw std::invalid_argument("invalid argument provided for command");
+            throw std::invalid_argument("Invalid input");
+        }
+        return schedule(d_session, period, command, args, overrun);
+    }
+
+    Scheduler::Id CommandProcessorImpl::schedule(Session &owner, std::chrono::milliseconds period, const Command &command, const Args &args, Scheduler::Overrun overrun)
+    {
+        if (isBuiltin(command))
+        {
+            throw std::invalid_argument("built in commands cannot be scheduled");
+        }
+        if (!d_registry.find(command))
+        {
+            throw std::invalid_argument(notFound(command));
         }
-        if(d_commandProcessorMap.count(command))
+        std::string name = command;
+        for (auto &arg : args)
         {
-            throw std::invalid_argument("command already exists");
+            name += ' ';
+            name += arg;
         }
-        d_commandProcessorMap[command] = processor;
-        d_commandDescriptionMap[command] = description;
-        d_autocomplete.add(command);
+        auto scheduled = std::make_shared<ScheduledCommand>();
+        formatStyled(std::back_inserter(scheduled->header), styled("every " + formatDuration(period) + ": " + name, COMMAND_STYLE));
+        scheduled->header += '\n';
+        scheduled->command = command;
+        scheduled->args = args;
+        scheduled->owner = owner.schedules;
+        auto id = d_scheduler.add(std::move(name), period, [this, scheduled]
+                                  { runScheduled(*scheduled); }, overrun);
+        std::lock_guard lock(owner.schedules->mutex);
+        owner.schedules->ids.push_back(id);
+        return id;
     }
 
-    void CommandProcessorImpl::add(const Command &command, std::function<void(const Args &)> processor, const std::vector<Rule *> &validateRules, const std::string &description)
+    std::size_t CommandProcessorImpl::cancelSchedules(Session &session)
     {
-        add(command, processor, description);
-        d_commandRuleMap[command] = validateRules;
+        std::lock_guard lock(session.schedules->mutex);
+        std::size_t cancelled = 0;
+        for (auto id : session.schedules->ids)
+        {
+            cancelled += d_scheduler.cancel(id);
+        }
+        session.schedules->ids.clear();
+        return cancelled;
     }
 
-    void CommandProcessorImpl::run()
+    bool CommandProcessorImpl::cancelSchedule(Scheduler::Id id)
     {
-        
-        clearScreen();
-        std::string input;
-        while (isRunning)
+        return d_scheduler.cancel(id);
+    }
+
+    // runs on a scheduler thread, never more than once at a time for the same schedule
+    void CommandProcessorImpl::runScheduled(ScheduledCommand &scheduled)
+    {
+        TraceSpan span("scheduled", scheduled.command);
+        // dispatch changes args, copying into the scratch ones reuses their capacity
+        Args &args = scheduled.session.scratch->args;
+        args = scheduled.args;
+        std::string output = scheduled.header;
         {
-            KeyboardInput::getInstance().enableKeyboard();
-            input = getUserInput();
-            KeyboardInput::getInstance().disableKeyboard();
-            d_history.addBack(input);
-            Command command;
-            Args args;
-            if (!parseStatement(input, command, args))
+            OutputCapture capture(output);
+            try
             {
-                std::cout << addColor("Invalid input", Color::RED) << std::endl;
-                continue;
+                dispatch(scheduled.session, scheduled.command, args);
             }
-            try
+            catch (const std::exception &exc)
             {
-                process(command, args);
-                std::cout << std::endl;
+                std::cout << styled(exc.what(), ERROR_STYLE);
             }
-            catch (const std::invalid_argument &exc)
+        }
+        if (output.back() != '\n')
+        {
+            output += '\n';
+        }
+        std::lock_guard lock(scheduled.owner->mutex);
+        if (scheduled.owner->sink)
+        {
+            scheduled.owner->sink(output);
+        }
+    }
+
+    void CommandProcessorImpl::showScheduled(const std::string &output)
+    {
+        std::lock_guard lock(d_terminalMutex);
+        switch (d_terminalState)
+        {
+        case TerminalState::DIRECT:
+            std::cout << output << std::flush;
+            break;
+        case TerminalState::PROMPT:
+            // print over the prompt, then draw it again with what was typed so far
+            d_screenBuffer.clear();
+            d_session.editor.render(d_screenBuffer, d_promptBuffer);
+            std::cout << "\r\033[K" << output << d_screenBuffer << std::flush;
+            break;
+        case TerminalState::BUSY:
+            d_scheduledOutput += output;
+            if (d_scheduledOutput.size() > SCHEDULED_OUTPUT_LIMIT)
             {
-                std::cout << addColor(exc.what(), Color::RED) << std::endl;
+                auto cut = d_scheduledOutput.find('\n', d_scheduledOutput.size() - SCHEDULED_OUTPUT_LIMIT);
+                d_scheduledOutput.erase(0, cut == std::string::npos ? d_scheduledOutput.size() - SCHEDULED_OUTPUT_LIMIT : cut + 1);
+                d_scheduledOutputDropped = true;
             }
-            catch (const std::exception &exc)
+            break;
+        }
+    }
+
+    void CommandProcessorImpl::setTerminalState(TerminalState state)
+    {
+        std::lock_guard lock(d_terminalMutex);
+        d_terminalState = state;
+        if (state == TerminalState::BUSY || d_scheduledOutput.empty())
+        {
+            return;
+        }
+        if (d_scheduledOutputDropped)
+        {
+            std::cout << styled("earlier scheduled output was dropped", ERROR_STYLE) << '\n';
+            d_scheduledOutputDropped = false;
+        }
+        std::cout << d_scheduledOutput << std::flush;
+        d_scheduledOutput.clear();
+        d_scheduledOutput.shrink_to_fit();
+    }
+
+    void CommandProcessorImpl::runEvery(Session &session, bool watch, const Args &args)
+    {
+        const std::string usage = watch ? "usage: watch [--coalesce] command args"
+                                        : "usage: every [--coalesce] <period> command args, every cancel <id|all>";
+        if (args.empty())
+        {
+            printSchedules(session);
+            return;
+        }
+        if (!watch && args[0] == "cancel")
+        {
+            if (args.size() != 2)
             {
-                std::cout << addColor(exc.what(), Color::RED) << std::endl;
+                throw std::invalid_argument(usage);
             }
-            catch (...)
+            if (args[1] == "all")
+            {
+                std::cout << "cancelled " << cancelSchedules(session);
+                return;
+            }
+            Scheduler::Id id = 0;
+            auto [end, error] = std::from_chars(args[1].data(), args[1].data() + args[1].size(), id);
+            // only what this session scheduled
+            std::unique_lock lock(session.schedules->mutex);
+            auto &ids = session.schedules->ids;
+            auto owned = std::find(ids.begin(), ids.end(), id);
+            if (error != std::errc() || end != args[1].data() + args[1].size() || owned == ids.end() || !d_scheduler.cancel(id))
             {
-                std::cout << addColor("An unknown error occured", Color::RED) << std::endl;
+                throw std::invalid_argument("no schedule " + args[1]);
             }
+            ids.erase(owned);
+            lock.unlock();
+            std::cout << "cancelled " << id;
+            return;
+        }
 
+        std::size_t next = 0;
+        auto overrun = Scheduler::Overrun::SKIP;
+        if (args[next] == "--coalesce")
+        {
+            overrun = Scheduler::Overrun::COALESCE;
+            next++;
+        }
+        std::chrono::milliseconds period = std::chrono::seconds(2);
+        if (!watch)
+        {
+            if (next == args.size())
+            {
+                throw std::invalid_argument(usage);
+            }
+            period = parseDuration(args[next++]);
+        }
+        if (next == args.size())
+        {
+            throw std::invalid_argument(usage);
         }
+        auto id = schedule(session, period, args[next], Args(args.begin() + next + 1, args.end()), overrun);
+        std::cout << "scheduled " << id << ", stop it with every cancel " << id;
     }
 
-    bool CommandProcessorImpl::parseStatement(const std::string &input, Command &command, Args &args)
+    void CommandProcessorImpl::printSchedules(const Session &session)
     {
-        if (input == "")
+        auto schedules = d_scheduler.list();
         {
-            return true;
+            std::lock_guard lock(session.schedules->mutex);
+            auto &ids = session.schedules->ids;
+            std::erase_if(schedules, [&](const Scheduler::Info &info)
+                          { return std::find(ids.begin(), ids.end(), info.id) == ids.end(); });
         }
-
-        std::vector<std::string> seen;
-        std::string temp = "";
-        int i = 0;
-        int n = input.size();
-        while (i < n)
+        if (schedules.empty())
         {
-            // if string is within quotes, find the end quote.
-            if (input[i] == '"' || input[i] == '\'')
+            std::cout << "nothing scheduled";
+            return;
+        }
+        for (auto &info : schedules)
+        {
+            std::cout << '\t' << info.id << ": " << styled("every " + formatDuration(info.period), COMMAND_STYLE) << ' ' << info.name
+                      << ", " << info.runs << " runs, " << info.skipped << " skipped";
+            if (info.overrun == Scheduler::Overrun::COALESCE)
             {
-                int start = i;
-                char c = input[i];
-                i++;
-                while (i < n && input[i] != c)
-                {
-                    i++;
-                }
-                if (i == n)
-                {
-                    return false;
-                }
-                seen.push_back(input.substr(start + 1, i - start - 1));
+                std::cout << ", coalescing";
+            }
+            if (info.running)
+            {
+                std::cout << ", running";
             }
+            std::cout << '\n';
+        }
+        std::cout << std::flush;
+    }
 
-            else if (input[i] == ' ')
+    void CommandProcessorImpl::runParallel(Session &session, const Args &args, const Context &context)
+    {
+        const std::string usage = "usage: parallel [-j N] [--unordered] command args ::: arg1 arg2";
+        std::size_t jobs = std::max(1u, std::thread::hardware_concurrency());
+        bool ordered = true;
+        std::size_t i = 0;
+        for (; i < args.size() && args[i].starts_with('-'); i++)
+        {
+            if (args[i] == "--unordered")
             {
-                if (temp != "")
-                {
-                    seen.push_back(temp);
-                    temp = "";
-                }
+                ordered = false;
+            }
+            else if (args[i] == "-j" && i + 1 < args.size() && !args[i + 1].empty() &&
+                     std::all_of(args[i + 1].begin(), args[i + 1].end(), [](char c)
+                                 { return c >= '0' && c <= '9'; }))
+            {
+                jobs = std::stoul(args[++i]);
             }
             else
             {
-                temp += input[i];
+                throw std::invalid_argument(usage);
             }
-            i++;
         }
-        if (temp != "")
+        auto separator = std::find(args.begin() + i, args.end(), ":::");
+        if (separator == args.end() || separator == args.begin() + i || jobs == 0)
         {
-            seen.push_back(temp);
+            throw std::invalid_argument(usage);
         }
-        command = seen[0];
-        args = std::vector(seen.begin() + 1, seen.end());
-        return true;
+        const Command &target = args[i];
+        if (isBuiltin(target))
+        {
+            throw std::invalid_argument("parallel cannot run " + target);
+        }
+        Args fixed(args.begin() + i + 1, separator);
+        std::vector<std::string> inputs(separator + 1, args.end());
+
+        struct Result
+        {
+            std::string output;
+            std::string error;
+            bool ok = false;
+        };
+        std::vector<Result> results(inputs.size());
+        Context call = context;
+        call.parallel = true;
+        auto run = [&](std::size_t index)
+        {
+            Result &result = results[index];
+            if (context.stop.stop_requested())
+            {
+                result.error = "Interrupted";
+                return;
+            }
+            Args callArgs = fixed;
+            callArgs.push_back(inputs[index]);
+            try
+            {
+                // pool threads are not captured by whoever runs parallel, the output is printed from here
+                OutputCapture capture(result.output);
+                dispatch(session, target, callArgs, call);
+                result.ok = true;
+            }
+            catch (const std::exception &exc)
+            {
+                result.error = exc.what();
+            }
+            catch (...)
+            {
+                result.error = "An unknown error occured";
+            }
+        };
+
+        std::size_t failed = 0;
+        auto print = [&](std::size_t index)
+        {
+            Result &result = results[index];
+            std::cout << result.output;
+            if (!result.output.empty() && result.output.back() != '\n')
+            {
+                std::cout << '\n';
+            }
+            if (!result.ok)
+            {
+                failed++;
+                std::cout << styled(target + " " + inputs[index] + ": " + result.error, ERROR_STYLE) << '\n';
+            }
+            std::cout << std::flush;
+            result.output = std::string();
+        };
+        // in order mode prints each result once everything before it has been printed
+        std::vector<bool> finished(inputs.size());
+        std::size_t next = 0;
+        std::size_t threads = std::min(jobs, inputs.size());
+        {
+            std::lock_guard lock(d_poolMutex);
+            if (!d_pool)
+            {
+                d_pool = std::make_unique<WorkStealingPool>(threads);
+            }
+        }
+        d_pool->reserve(threads);
+        d_pool->forEach(inputs.size(), run, [&](std::size_t index)
+                        {
+            if (!ordered)
+            {
+                print(index);
+                return;
+            }
+            finished[index] = true;
+            while (next < inputs.size() && finished[next])
+            {
+                print(next++);
+            } },
+                        threads);
+
+        std::string summary = std::to_string(inputs.size() - failed) + " succeeded, " + std::to_string(failed) + " failed";
+        if (failed > 0)
+        {
+            throw std::runtime_error(summary);
+        }
+        std::cout << summary;
     }
 
-    void CommandProcessorImpl::process(const Command &command, Args args)
+    void CommandProcessorImpl::invoke(const CommandEntry &entry, const Command &command, const Args &args, const Context &context)
     {
-        if (command == "")
+        TraceSpan span("handler", command);
+        // only commands that can be interrupted or have a deadline pay for a stop state
+        std::stop_source stop(std::nostopstate);
+        Watchdog::Watch watch;
+        auto timeout = entry.options.timeout.count() > 0 ? entry.options.timeout : d_defaultTimeout.load();
+        bool interruptible = context.stop.stop_possible();
+        if (interruptible || timeout.count() > 0)
         {
-            return;
+            stop = std::stop_source();
         }
-        if (command == "help")
+        // the handler gets its own stop state, a missed deadline stops it and not the rest of the command
+        auto forward = [&stop]
+        { stop.request_stop(); };
+        std::optional<std::stop_callback<decltype(forward)>> interrupt;
+        if (interruptible)
         {
-            help();
-            return;
+            interrupt.emplace(context.stop, forward);
         }
-        if (command == "exit")
+        if (timeout.count() > 0)
         {
-            isRunning = false;
-            return;
+            watch = d_watchdog.watch(command, timeout, stop, context.onRunaway);
         }
-        if (command == "clear")
+
+        if (entry.processor)
         {
-            clearScreen();
-            return;
+            entry.processor(args, stop.get_token());
         }
-        if (command == "history")
+        else
         {
-            std::cout << d_history.getAllHistory();
-            return;
+            // print each chunk as it comes, the stream is destroyed (cancelled) on any exit
+            auto stream = entry.streamProcessor(args);
+            while (!stop.stop_requested() && stream.next())
+            {
+                std::cout << stream.chunk() << std::flush;
+            }
         }
-        auto res = validateArgs(command, args);
-        if (!res.first)
+        if (watch.expired())
         {
-            throw std::invalid_argument(res.second);
+            throw std::runtime_error("Timed out after " + std::to_string(timeout.count()) + "ms");
         }
-        if (d_commandProcessorMap.find(command) == d_commandProcessorMap.end())
+        if (context.stop.stop_requested())
         {
-            throw std::invalid_argument("Command " + command + " not found");
+            throw std::runtime_error("Interrupted");
         }
-        d_commandProcessorMap[command](args);
     }
 
     void CommandProcessorImpl::clearScreen()
@@ -186,15 +1473,10 @@ namespace ose4g
         std::cout << "\033[2J\033[H";
     }
 
-    std::pair<bool, std::string> CommandProcessorImpl::validateArgs(const Command &command, Args &args)
+    std::pair<bool, std::string> CommandProcessorImpl::validateArgs(const CommandEntry &entry, Args &args)
     {
-        if (!d_commandRuleMap.count(command))
-        {
-            return {true, ""};
-        }
-
         std::string message = "";
-        for (auto rule : d_commandRuleMap[command])
+        for (auto rule : entry.rules)
         {
             auto res = rule->apply(args);
             message += res.second;
@@ -207,125 +1489,110 @@ namespace ose4g
         return {true, message};
     }
 
-    std::string CommandProcessorImpl::getUserInput()
+    const std::string &CommandProcessorImpl::getUserInput()
     {
-        std::string currentInput = "";
-        int pos = 0;
-        std::string prompt = addColor(d_name + " => ", Color::GREEN);
-        History temp;
-        temp.addFront(currentInput);
+        std::string &prompt = d_promptBuffer;
+        prompt.clear();
+        formatStyled(std::back_inserter(prompt), styled(d_prompt, PROMPT_STYLE));
+        std::string &screen = d_screenBuffer;
+        LineEditor &editor = d_session.editor;
+        editor.reset();
+        // scheduled output held back while the last command ran comes first
+        setTerminalState(TerminalState::PROMPT);
 
         while (true)
         {
-            std::cout << ("\r\033[K" + prompt + currentInput) << std::flush;
-            
-            // move the cursor
-            int stepsBack = currentInput.length() - pos;
-            for (int i = 0; i < stepsBack; i++)
             {
-                std::cout << "\033[D" << std::flush;
+                TraceSpan span("render");
+                std::lock_guard lock(d_terminalMutex);
+                screen.clear();
+                editor.render(screen, prompt);
+                std::cout << screen << std::flush;
             }
 
-            auto input = KeyboardInput::getInstance().getInput();
-            
-            // add ascii character to current string
-            if (input.first == KeyboardInput::InputType::ASCII)
-            {
-                currentInput = (currentInput.substr(0, pos) + input.second + currentInput.substr(pos));
-                temp.edit(currentInput);
-                pos++;
-            }
-            // remove from current string
-            else if (input.first == KeyboardInput::InputType::BACKSPACE && currentInput.length() > 0)
+            KeyboardInput::Input input;
             {
-                currentInput = currentInput.substr(0, pos - 1) + currentInput.substr(pos);
-                temp.edit(currentInput);
-                pos--;
+                TraceSpan span("read key");
+                input = KeyboardInput::getInstance().getInput();
             }
-            // return complete user input
-            else if (input.first == KeyboardInput::InputType::ENTER)
+            std::lock_guard lock(d_terminalMutex);
+            auto action = editor.feed(input);
+            if (action == LineEditor::Action::NEWLINE)
             {
                 std::cout << "\n";
-                pos = 0;
-                if (currentInput != "")
-                    break;
             }
-            // move cursor left
-            else if (input.first == KeyboardInput::InputType::ARROW_LEFT && pos > 0)
+            else if (action == LineEditor::Action::CANCEL)
             {
-                pos--;
+                std::cout << "^C\n";
             }
-            // move cursor right
-            else if (input.first == KeyboardInput::InputType::ARROW_RIGHT && pos < currentInput.length())
+            else if (action == LineEditor::Action::SUBMIT)
             {
-                pos++;
+                std::cout << "\n";
+                d_terminalState = TerminalState::BUSY;
+                break;
             }
-            // go to previous history
-            else if (input.first == KeyboardInput::InputType::ARROW_UP)
+            else if (action == LineEditor::Action::SUGGEST)
             {
-                /**
-                 * check history for temporary history first
-                 * if not then check the permanent history
-                 */
-                auto v = temp.getPrevious();
-
-                if (v.first)
-                {
-                    currentInput = v.second;
-                    pos = currentInput.length();
-                }
-                else
-                {
-                    auto d = d_history.getPrevious();
-                    if (d.first)
-                    {
-                        currentInput = d.second;
-                        pos = currentInput.length();
-                        temp.addFront(currentInput);
-                    }
-                }
+                screen.clear();
+                editor.renderSuggestions(screen);
+                std::cout << screen << std::flush;
             }
-            // Go to newer history.
-            else if (input.first == KeyboardInput::InputType::ARROW_DOWN)
-            {
-                auto v = temp.getNext();
+        }
+        return editor.line();
+    }
 
-                if (v.first)
-                {
-                    currentInput = v.second;
-                    pos = currentInput.length();
-                }
+    std::vector<std::string> CommandProcessorImpl::complete(const std::string &input)
+    {
+        // the word being completed is everything after the last space
+        auto start = input.rfind(' ');
+        if (start == std::string::npos)
+        {
+            // only complete if it is just the command
+            if (!isValidName(input))
+            {
+                return {};
             }
-            // add autocomplete
-            else if(input.first == KeyboardInput::InputType::TAB)
+            RcuReadGuard guard;
+            return d_registry.current().autocomplete.getSuggestions(input);
+        }
+
+        // walk the words before it to find the level to complete at
+        std::string_view line(input);
+        std::string_view word = line.substr(start + 1);
+        std::shared_ptr<const CommandEntry> entry;
+        std::size_t position = 0;
+        while (position < start)
+        {
+            auto end = std::min(line.find(' ', position), start);
+            if (end > position)
             {
-                // only return if it is just the command
-                if(!std::regex_match(currentInput, d_commandPattern))
-                {
-                    continue;
-                }
-                auto suggestions = d_autocomplete.getSuggestions(currentInput);
-                if(suggestions.size() == 0)
+                std::string name(line.substr(position, end - position));
+                if (!entry)
                 {
-                    continue;
+                    entry = d_registry.find(name);
                 }
-                if(suggestions.size() == 1)
+                else
                 {
-                    currentInput = suggestions[0];
-                    pos = currentInput.length();
-                    continue;
+                    auto child = entry->subcommands.find(name);
+                    entry = child == entry->subcommands.end() ? nullptr : child->second;
                 }
-                std::string newline = "\n";
-                for(auto& suggestion: suggestions)
+                if (!entry)
                 {
-                    newline += (suggestion + " ");
+                    return {};
                 }
-                std::cout<<newline<<std::endl;
-                continue;
             }
+            position = end + 1;
+        }
+        if (!entry)
+        {
+            return {};
         }
-        return currentInput;
+
+        std::vector<std::string> suggestions;
+        for (auto it = entry->subcommands.lower_bound(std::string(word)); it != entry->subcommands.end() && it->first.starts_with(word); it++)
+        {
+            suggestions.push_back(it->first);
+        }
+        return suggestions;
     }
 }
-
-//
\ No newline at end of file
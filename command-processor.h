@@ -1,78 +1,131 @@
 #ifndef COMMAND_PROCESSOR_H
 #define COMMAND_PROCESSOR_H
 
-#include <unordered_map>
-#include <map>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
 #include <string>
-#include <regex>
+#include <memory_resource>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include "history.h"
-#include "autocomplete.h"
+#include "memory.h"
+#include "pager.h"
+#include "recording.h"
+#include "plugin.h"
+#include "registry.h"
+#include "scheduler.h"
+#include "threadpool.h"
+#include "watchdog.h"
+#include "rule.h"
+#include "session.h"
 namespace ose4g
 {
-    using Args = std::vector<std::string>;
-    using Command = std::string;
+    /// @brief processors that can be empty: function pointers and std::function, not lambdas
+    template <typename Processor>
+    inline constexpr bool isNullableProcessor = std::is_pointer_v<Processor>;
 
-    /**
-     * Rule class for validation of arguments
-     */
-    class Rule
-    {
-    public:
-        /// apply validation rule on arguments
-        virtual std::pair<bool, std::string> apply(ose4g::Args &args) = 0;
-    };
-
-    /**
-     * @tparam MIN_ARG_COUNT minimum argument count
-     * @tparam MAX_ARG_COUNT maximum argument count
-     */
-    template <int MIN_ARG_COUNT = 1, int MAX_ARG_COUNT = 10>
-    class ArgCountRule : public Rule
-    {
-    public:
-        std::pair<bool, std::string> apply(Args &args)
-        {
-            bool valid = MIN_ARG_COUNT <= args.size() && args.size() <= MAX_ARG_COUNT;
-            std::string message = "";
-            if (!valid)
-            {
-                message = "Number of arguments should be between " + std::to_string(MIN_ARG_COUNT) + " and " + std::to_string(MAX_ARG_COUNT) + " But got " + std::to_string(args.size());
-            }
-            return {valid, message};
-        }
-    };
+    template <typename Signature>
+    inline constexpr bool isNullableProcessor<std::function<Signature>> = true;
 
-    /// @brief User defined rule to apply args
-    class UserRule : public Rule
+    /// @brief one command given to addAll, the same settings as add takes
+    struct CommandDefinition
     {
-    private:
-        std::function<std::pair<bool, std::string>(const Args &)> f;
-
-    public:
-        UserRule(std::function<std::pair<bool, std::string>(const Args &)> func) : f(func) {}
-        std::pair<bool, std::string> apply(Args &args)
-        {
-            return f(args);
-        }
+        Command command;
+        std::function<void(const Args &)> processor;
+        std::string description;
+        std::vector<Rule *> rules;
+        CommandOptions options;
     };
 
     class CommandProcessorImpl
     {
     private:
-        std::unordered_map<Command, std::function<void(const Args &)>> d_commandProcessorMap;
-        std::map<Command, std::string> d_commandDescriptionMap;
-        std::unordered_map<Command, std::vector<Rule *>> d_commandRuleMap;
+        CommandRegistry d_registry;
         std::string d_name;
-        std::regex d_commandPattern;
-        bool isRunning = true;
-        History d_history;
-        AutoComplete d_autocomplete;
+        std::string d_prompt;
+        Session d_session;
+        // reused by every prompt so reading a line does not allocate
+        std::string d_promptBuffer;
+        std::string d_screenBuffer;
+        struct Worker;
+        std::shared_ptr<Worker> d_worker;
+        // workers of commands that did not stop, joined when run() returns
+        std::vector<std::shared_ptr<Worker>> d_abandoned;
+        // what a command runs under besides its session, see executeOnWorker and runParallel
+        struct Context
+        {
+            // requested by Ctrl-C at the console
+            std::stop_token stop;
+            // called from the watchdog thread when a handler ignores its deadline
+            std::function<void()> onRunaway;
+            // one of the calls of parallel, which share the session. No initializer so {} can be a default argument
+            bool parallel;
+        };
+        std::atomic<std::shared_ptr<SessionRecorder>> d_recorder;
+        std::atomic<std::chrono::milliseconds> d_defaultTimeout{std::chrono::milliseconds(0)};
+        std::atomic<std::size_t> d_historyByteLimit{0};
+        PagerOptions d_pagerOptions;
+        Watchdog d_watchdog;
+        // who owns the terminal, output of scheduled commands is only printed when it is safe to
+        enum class TerminalState
+        {
+            DIRECT,
+            PROMPT,
+            BUSY
+        };
+        std::mutex d_terminalMutex;
+        TerminalState d_terminalState = TerminalState::DIRECT;
+        std::string d_scheduledOutput;
+        bool d_scheduledOutputDropped = false;
+        // runs parallel, started by the first one and grown to the largest -j asked for
+        std::mutex d_poolMutex;
+        std::unique_ptr<WorkStealingPool> d_pool;
+        struct ScheduledCommand;
+        // last so it is destroyed first, its jobs use everything above
+        Scheduler d_scheduler;
 
         // private methods
         void clearScreen();
-        std::pair<bool, std::string> validateArgs(const Command &command, Args &args);
-        std::string getUserInput();
+        std::pair<bool, std::string> validateArgs(const CommandEntry &entry, Args &args);
+        void checkPath(const CommandPath &path);
+        void addEntry(const CommandPath &path, CommandEntry entry);
+        void addEntries(std::vector<std::pair<CommandPath, CommandEntry>> entries);
+        void defineMacro(const Command &name, std::vector<Macro::Step> steps, const std::string &description);
+        void printAliases();
+        void runParallel(Session &session, const Args &args, const Context &context);
+        void printMemory(const Session &session);
+        void runEvery(Session &session, bool watch, const Args &args);
+        void printSchedules(const Session &session);
+        Scheduler::Id schedule(Session &owner, std::chrono::milliseconds period, const Command &command, const Args &args, Scheduler::Overrun overrun);
+        // cancels what session scheduled, returns how many were still scheduled
+        std::size_t cancelSchedules(Session &session);
+        void runScheduled(ScheduledCommand &scheduled);
+        void showScheduled(const std::string &output);
+        void setTerminalState(TerminalState state);
+        std::string notFound(const Command &command);
+        std::shared_ptr<const CommandEntry> findEntry(const CommandPath &path);
+        void addProcessor(const CommandPath &path, CommandEntry::Processor processor, const std::vector<Rule *> &validateRules,
+                          const std::string &description, const CommandOptions &options);
+        void printSubcommands(const CommandEntry &entry);
+        std::pair<CommandPath, CommandEntry> makeEntry(const CommandDefinition &definition);
+        const std::string &getUserInput();
+        std::vector<std::string> complete(const std::string &input);
+        void execute(Session &session, const std::string &input, const Context &context = {});
+        void executeOnWorker(const std::string &input);
+        void workerLoop(std::shared_ptr<Worker> worker);
+        void stopWorker();
+        // line is the statement as typed when there is one, builtins that read their own syntax use it
+        void dispatch(Session &session, const Command &command, Args &args, const Context &context = {}, std::string_view line = {});
+        void invoke(const CommandEntry &entry, const Command &command, const Args &args, const Context &context);
+
+        // serves sessions over sockets using the same registry
+        friend class Server;
 
     public:
         /**
@@ -87,18 +140,31 @@ namespace ose4g
          */
         void help();
 
+        /**
+         * @brief prints the description of one command and its subcommands.
+         *
+         * @param path command and subcommand names, prints everything if empty.
+         */
+        void help(const CommandPath &path);
+
         /**
          * @brief adds a new command.
          *
          * @param command Command string.
          * @param processor function to process the command
          * @param description description of command.
+         * @param options timeout and other settings for the command.
          *
          * command should be a string that meets the following requirements
          * - command starts with an alphabet
          * - command has only alphanumeric characters or -
          */
-        void add(const Command &command, std::function<void(const Args &)> processor, const std::string &description = "");
+        template <typename Processor>
+            requires(std::is_invocable_v<Processor, const Args &> && !std::is_invocable_r_v<Stream, Processor, const Args &>)
+        void add(const Command &command, Processor processor, const std::string &description = "", const CommandOptions &options = {})
+        {
+            addSubcommand({command}, std::move(processor), {}, description, options);
+        }
 
         /**
          * @brief adds a new command.
@@ -107,18 +173,332 @@ namespace ose4g
          * @param processor function to process the command
          * @param validateRules rules to validate the arguments
          * @param description description of command.
+         * @param options timeout and other settings for the command.
          *
          * command should be a string that meets the following requirements
          * - command starts with an alphabet
          * - command has only alphanumeric characters or -
          */
-        void add(const Command &command, std::function<void(const Args &)> processor, const std::vector<Rule *> &validateRules, const std::string &description = "");
+        template <typename Processor>
+            requires(std::is_invocable_v<Processor, const Args &> && !std::is_invocable_r_v<Stream, Processor, const Args &>)
+        void add(const Command &command, Processor processor, const std::vector<Rule *> &validateRules, const std::string &description = "", const CommandOptions &options = {})
+        {
+            addSubcommand({command}, std::move(processor), validateRules, description, options);
+        }
+
+        /**
+         * @brief adds a command whose handler can be cancelled.
+         *
+         * The handler should return soon after stop is requested on its
+         * token, which happens when its timeout passes.
+         *
+         * @param command Command string.
+         * @param processor function taking the arguments and a std::stop_token.
+         * @param description description of command.
+         * @param options timeout and other settings for the command.
+         */
+        template <typename CancellableProcessor>
+            requires(std::is_invocable_v<CancellableProcessor, const Args &, std::stop_token> && !std::is_invocable_v<CancellableProcessor, const Args &>)
+        void add(const Command &command, CancellableProcessor processor, const std::string &description = "", const CommandOptions &options = {})
+        {
+            add(command, std::move(processor), {}, description, options);
+        }
+
+        /**
+         * @brief adds a cancellable command with validation rules.
+         *
+         * @param command Command string.
+         * @param processor function taking the arguments and a std::stop_token.
+         * @param validateRules rules to validate the arguments
+         * @param description description of command.
+         * @param options timeout and other settings for the command.
+         */
+        template <typename CancellableProcessor>
+            requires(std::is_invocable_v<CancellableProcessor, const Args &, std::stop_token> && !std::is_invocable_v<CancellableProcessor, const Args &>)
+        void add(const Command &command, CancellableProcessor processor, const std::vector<Rule *> &validateRules, const std::string &description = "", const CommandOptions &options = {})
+        {
+            addProcessor({command}, countedCallable(MemoryCategory::HANDLERS, std::move(processor)), validateRules, description, options);
+        }
+
+        /**
+         * @brief adds a command whose handler is a coroutine streaming its output, see Stream.
+         *
+         * Each chunk is printed as soon as it is produced. When run from the
+         * terminal, Ctrl-C stops the handler at its next co_yield.
+         *
+         * @param command Command string.
+         * @param processor coroutine taking the arguments and returning a Stream.
+         * @param description description of command.
+         * @param options timeout and other settings, a timeout stops the handler at its next co_yield.
+         */
+        template <typename StreamProcessor>
+            requires std::is_invocable_r_v<Stream, StreamProcessor, const Args &>
+        void add(const Command &command, StreamProcessor processor, const std::string &description = "", const CommandOptions &options = {})
+        {
+            add(command, std::move(processor), {}, description, options);
+        }
+
+        /**
+         * @brief adds a streaming command with validation rules.
+         *
+         * @param command Command string.
+         * @param processor coroutine taking the arguments and returning a Stream.
+         * @param validateRules rules to validate the arguments
+         * @param description description of command.
+         * @param options timeout and other settings, a timeout stops the handler at its next co_yield.
+         */
+        template <typename StreamProcessor>
+            requires std::is_invocable_r_v<Stream, StreamProcessor, const Args &>
+        void add(const Command &command, StreamProcessor processor, const std::vector<Rule *> &validateRules, const std::string &description = "", const CommandOptions &options = {})
+        {
+            checkPath({command});
+            addEntry({command}, {.streamProcessor = countedCallable(MemoryCategory::HANDLERS, std::move(processor)), .description = description, .rules = validateRules, .options = options});
+        }
+
+        /**
+         * @brief adds many commands at once, e.g. a vector of CommandDefinition.
+         *
+         * Every definition is validated first and all of them are published
+         * in one registry update, so registering n commands takes time linear
+         * in n instead of copying the registry n times. Either every command
+         * is added or, if one is invalid or already exists, none is.
+         *
+         * @param definitions a range of CommandDefinition.
+         *
+         * @throws std::invalid_argument as add does.
+         */
+        template <std::ranges::input_range Definitions>
+            requires std::convertible_to<std::ranges::range_reference_t<Definitions>, const CommandDefinition &>
+        void addAll(Definitions &&definitions)
+        {
+            std::vector<std::pair<CommandPath, CommandEntry>> entries;
+            if constexpr (std::ranges::sized_range<Definitions>)
+            {
+                entries.reserve(std::ranges::size(definitions));
+            }
+            for (const CommandDefinition &definition : definitions)
+            {
+                entries.push_back(makeEntry(definition));
+            }
+            addEntries(std::move(entries));
+        }
+
+        /**
+         * @brief adds a nested subcommand, e.g. {"cluster", "node", "drain"}.
+         *
+         * Groups on the path that do not exist yet are created without a
+         * processor. Running a group on its own prints its subcommands.
+         * Each level is validated with its own rules.
+         *
+         * @param path names from the top level command down to the subcommand.
+         * @param processor function to process the subcommand
+         * @param description description of subcommand.
+         * @param options timeout and other settings for the subcommand.
+         *
+         * every name on the path must meet the requirements of add.
+         */
+        template <typename Processor>
+            requires(std::is_invocable_v<Processor, const Args &> && !std::is_invocable_r_v<Stream, Processor, const Args &>)
+        void addSubcommand(const CommandPath &path, Processor processor, const std::string &description = "", const CommandOptions &options = {})
+        {
+            addSubcommand(path, std::move(processor), {}, description, options);
+        }
+
+        /**
+         * @brief adds a nested subcommand with validation rules.
+         *
+         * @param path names from the top level command down to the subcommand.
+         * @param processor function to process the subcommand
+         * @param validateRules rules to validate the arguments left after the path
+         * @param description description of subcommand.
+         * @param options timeout and other settings for the subcommand.
+         */
+        template <typename Processor>
+            requires(std::is_invocable_v<Processor, const Args &> && !std::is_invocable_r_v<Stream, Processor, const Args &>)
+        void addSubcommand(const CommandPath &path, Processor processor, const std::vector<Rule *> &validateRules, const std::string &description = "", const CommandOptions &options = {})
+        {
+            if constexpr (isNullableProcessor<Processor>)
+            {
+                if (!processor)
+                {
+                    throw std::invalid_argument("processor must not be empty");
+                }
+            }
+            // the captures are moved to a counted block before std::function erases their type
+            addProcessor(path, countedCallable(MemoryCategory::HANDLERS, [processor = std::move(processor)](const Args &args, std::stop_token)
+                                               { processor(args); }),
+                         validateRules, description, options);
+        }
+
+        /**
+         * @brief creates a group of subcommands or changes its description.
+         *
+         * @param path names from the top level command down to the group.
+         * @param description description shown in help.
+         */
+        void addGroup(const CommandPath &path, const std::string &description);
+
+        /**
+         * @brief removes a subcommand and everything below it.
+         *
+         * @throws std::invalid_argument if the path does not exist.
+         */
+        void removeSubcommand(const CommandPath &path);
+
+        /**
+         * @brief removes a command added with add.
+         *
+         * Safe to call while other threads dispatch commands, a call to the
+         * command that is already running finishes normally.
+         *
+         * @param command Command string.
+         *
+         * @throws std::invalid_argument if the command does not exist or is built in.
+         */
+        void remove(const Command &command);
+
+        /**
+         * @brief defines an alias or macro, e.g. defineAlias("deploy-all", "build; push -l $1; verify").
+         *
+         * The definition is parsed once, calling the alias runs the stored
+         * commands in order and stops at the first failure. $1, $2, ... are
+         * replaced by the alias's arguments and $@ by all of them. Defining an
+         * existing alias replaces it. Also available as the `alias` built in
+         * command: `alias deploy-all = build; push -l $1; verify`.
+         *
+         * @param name name of the alias, must meet the requirements of add.
+         * @param definition commands separated by ;
+         * @param description shown in help, the definition if empty.
+         *
+         * @throws std::invalid_argument if the definition cannot be parsed,
+         *         name is a command that is not an alias or the alias would call itself.
+         */
+        void defineAlias(const Command &name, const std::string &definition, const std::string &description = "");
+
+        /**
+         * @brief runs every line of an rc file as a command, e.g. a list of alias definitions.
+         *
+         * Empty lines and lines starting with # are skipped.
+         *
+         * @throws std::invalid_argument naming the file and line of the first line that fails.
+         */
+        void loadRcFile(const std::string &path);
+
+        /**
+         * @brief registers the commands declared in a plugin manifest, see Plugin.
+         *
+         * Only the manifest is read, the library is opened the first time one
+         * of its commands runs. All the commands are published in one registry
+         * update, so large manifests load in time linear in their size.
+         *
+         * @param manifestPath path of the manifest.
+         * @returns the plugin, e.g. to check whether it has been loaded.
+         *
+         * @throws std::invalid_argument if the manifest cannot be read, a name is
+         *         invalid or a command already exists. Nothing is registered then.
+         */
+        std::shared_ptr<Plugin> loadPlugin(const std::string &manifestPath);
+
+        /**
+         * @brief timeout for commands added without one, zero (the default) means no timeout.
+         */
+        void setDefaultTimeout(std::chrono::milliseconds timeout);
+
+        /**
+         * @brief caps the memory each session's history uses, zero (the default) means no cap.
+         *
+         * Applies to the terminal session and to server sessions opened
+         * afterwards, see History::setByteLimit. Call it before run.
+         */
+        void setHistoryByteLimit(std::size_t bytes);
+
+        /**
+         * @brief how output of commands run from the terminal is paged, see showOutput.
+         *
+         * Output taller than the terminal is shown a page at a time, with
+         * search, and the command is paused while it is far ahead of the
+         * page on screen. Server sessions are never paged. Call it before run.
+         */
+        void setPager(const PagerOptions &options);
+
+        /**
+         * @brief bytes held by the completion index, suggestions, registry,
+         *        handler captures and histories of every processor in the process.
+         *
+         * The accounts are process wide, so this is not what one processor
+         * holds when there are several. Also available as the `mem` built in
+         * command.
+         */
+        static MemoryUsage processMemoryUsage() { return ose4g::memoryUsage(); }
+
+        /**
+         * @brief drops the cached output of a command added with a cacheTtl.
+         *
+         * @throws std::invalid_argument if the command does not exist.
+         */
+        void invalidateCache(const CommandPath &path);
+
+        /**
+         * @brief hit and miss counters of a cached command, all zero if it is not cached.
+         *
+         * @throws std::invalid_argument if the command does not exist.
+         */
+        ResultCache::Stats cacheStats(const CommandPath &path);
+
+        /**
+         * @brief the watchdog enforcing command timeouts, for its statistics and grace period.
+         */
+        Watchdog &watchdog() { return d_watchdog; }
+
+        /**
+         * @brief runs a command line every period from a background thread, as the `every` built in does.
+         *
+         * The line is parsed once here, each run dispatches the parsed
+         * command directly. The schedule belongs to the console session: the
+         * output of a run is collected and printed above the prompt, or once
+         * the command running at the console has finished. Schedules made
+         * with `every` on a Server connection print to that connection and
+         * end with it. The first run is right away. A run that comes due while
+         * the previous one is still going is skipped, or with
+         * Scheduler::Overrun::COALESCE all of them are folded into one run
+         * that starts when the previous one returns.
+         *
+         * @returns the id to cancel it with.
+         * @throws std::invalid_argument if the line does not parse or is not a registered command.
+         */
+        Scheduler::Id schedule(std::chrono::milliseconds period, const std::string &line,
+                               Scheduler::Overrun overrun = Scheduler::Overrun::SKIP);
+
+        /**
+         * @brief stops a scheduled command, a run already going is left to finish.
+         *
+         * @returns false if there is no such schedule.
+         */
+        bool cancelSchedule(Scheduler::Id id);
+
+        /// @brief every scheduled command of every session with its run and skip counts
+        std::vector<Scheduler::Info> schedules() const { return d_scheduler.list(); }
 
         /**
          * @brief starts the command processor process
          */
         void run();
 
+        /**
+         * @brief records every command run from now on, see SessionRecorder.
+         *
+         * Records the parsed command, its args, when it started, how long it
+         * took and the error message if it failed. Replaces any recording in progress.
+         *
+         * @param path file to write the recording to, it is truncated.
+         */
+        void record(const std::string &path);
+
+        /**
+         * @brief stops recording and closes the recording file.
+         */
+        void stopRecording();
+
         /**
          * @brief parses user input
          *
@@ -130,6 +510,31 @@ namespace ose4g
          */
         bool parseStatement(const std::string &input, Command &command, Args &args);
 
+        /**
+         * @brief parses user input into buffers that are reused between calls.
+         *
+         * command and args keep their capacity, so parsing into the same
+         * objects again does not allocate once they are large enough.
+         *
+         * @param input user input.
+         * @param command output command.
+         * @param args arguments
+         * @param scratch memory for temporaries, e.g. a std::pmr::monotonic_buffer_resource released per command.
+         *
+         * @returns boolean telling if parse was successful or not.
+         */
+        bool parseStatement(std::string_view input, Command &command, Args &args, std::pmr::memory_resource *scratch);
+
+        /**
+         * @brief runs a line as if it was typed at the prompt.
+         *
+         * The line is added to history, parsed, recorded and dispatched, and
+         * errors are printed instead of thrown.
+         *
+         * @param input user input.
+         */
+        void execute(const std::string &input);
+
         /**
          * @brief processes a command given its args
          *
@@ -137,6 +542,12 @@ namespace ose4g
          * @param args the arguments to be processed with the command
          */
         void process(const Command &command, Args args);
+
+        /// @brief true for the commands handled by the processor itself, such as help, alias and every
+        static bool isBuiltin(std::string_view command);
+
+        /// @brief true if command is a built in or an alias or macro that runs one, however deeply nested
+        bool reachesBuiltin(const Command &command);
     };
 
     class CommandProcessor : public CommandProcessorImpl
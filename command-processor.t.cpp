@@ -1,6 +1,18 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include "capture.h"
 #include "command-processor.h"
+#include "keyboardinput.h"
+#include "style.h"
+#include "trace.h"
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <memory_resource>
+#include <fstream>
+#include <memory>
+#include <ranges>
+#include <thread>
 
 class AddCommandFailTest : public testing::TestWithParam<ose4g::Command>
 {
@@ -51,6 +63,93 @@ TEST_F(ProcessCommandTest, processShouldCallAddedFunction)
     EXPECT_TRUE(called);
 }
 
+TEST_F(ProcessCommandTest, removeShouldUnregisterCommand)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    auto f = std::bind(&ProcessCommandTest::doStuff, this, std::placeholders::_1);
+    EXPECT_NO_THROW(cp.add("mycommand", f, ""));
+    EXPECT_NO_THROW(cp.remove("mycommand"));
+    EXPECT_THROW(cp.process("mycommand", {}), std::invalid_argument);
+    EXPECT_THROW(cp.remove("mycommand"), std::invalid_argument);
+    EXPECT_NO_THROW(cp.add("mycommand", f, ""));
+}
+
+TEST(CommandProcessorTest, commandShouldRemoveItselfWhileRunning)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    int calls = 0;
+    cp.add("once", [&](const ose4g::Args &)
+           {
+               calls++;
+               cp.remove("once");
+           });
+    EXPECT_NO_THROW(cp.process("once", {}));
+    EXPECT_THROW(cp.process("once", {}), std::invalid_argument);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(CommandProcessorTest, handlerShouldBeStoppedAtItsTimeout)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    bool stopped = false;
+    cp.add("wait", [&](const ose4g::Args &, std::stop_token token)
+           {
+               auto start = std::chrono::steady_clock::now();
+               while (!token.stop_requested() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+                   std::this_thread::sleep_for(std::chrono::milliseconds(1));
+               stopped = token.stop_requested();
+           }, "waits until stopped", {.timeout = std::chrono::milliseconds(20)});
+    EXPECT_THROW(cp.process("wait", {}), std::runtime_error);
+    EXPECT_TRUE(stopped);
+    EXPECT_EQ(cp.watchdog().stats().deadlineMisses, 1u);
+}
+
+TEST(CommandProcessorTest, defaultTimeoutShouldApplyToCommandsWithoutOne)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("quick", [](const ose4g::Args &) {});
+    cp.setDefaultTimeout(std::chrono::seconds(5));
+    EXPECT_NO_THROW(cp.process("quick", {}));
+    EXPECT_EQ(cp.watchdog().stats().watched, 1u);
+    EXPECT_EQ(cp.watchdog().stats().deadlineMisses, 0u);
+}
+
+TEST(SubcommandTest, processShouldWalkTheTreeAndPassRemainingArgs)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    ose4g::Args received;
+    cp.addSubcommand({"cluster", "node", "drain"}, [&](const ose4g::Args &args)
+                     { received = args; }, "drain a node");
+    cp.addSubcommand({"cluster", "status"}, [](const ose4g::Args &) {});
+    EXPECT_NO_THROW(cp.process("cluster", {"node", "drain", "node-1", "--force"}));
+    EXPECT_EQ(received, (ose4g::Args{"node-1", "--force"}));
+    EXPECT_THROW(cp.process("cluster", {"nodes"}), std::invalid_argument);
+}
+
+TEST(SubcommandTest, eachLevelShouldUseItsOwnRules)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    ose4g::ArgCountRule<1, 1> exactlyOne;
+    cp.add("cluster", [](const ose4g::Args &) {});
+    cp.addSubcommand({"cluster", "drain"}, [](const ose4g::Args &) {}, {&exactlyOne});
+    EXPECT_NO_THROW(cp.process("cluster", {}));
+    EXPECT_NO_THROW(cp.process("cluster", {"drain", "node-1"}));
+    EXPECT_THROW(cp.process("cluster", {"drain"}), std::invalid_argument);
+}
+
+TEST(SubcommandTest, addSubcommandShouldFailForInvalidOrExistingPath)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    EXPECT_THROW(cp.addSubcommand({"cluster", "2node"}, [](const ose4g::Args &) {}), std::invalid_argument);
+    EXPECT_THROW(cp.addSubcommand({"help", "node"}, [](const ose4g::Args &) {}), std::invalid_argument);
+    EXPECT_NO_THROW(cp.addSubcommand({"cluster", "node"}, [](const ose4g::Args &) {}));
+    EXPECT_THROW(cp.addSubcommand({"cluster", "node"}, [](const ose4g::Args &) {}), std::invalid_argument);
+    EXPECT_NO_THROW(cp.removeSubcommand({"cluster", "node"}));
+    EXPECT_THROW(cp.removeSubcommand({"cluster", "node"}), std::invalid_argument);
+    EXPECT_THROW(cp.addSubcommand({"cluster", "empty"}, std::function<void(const ose4g::Args &)>()), std::invalid_argument);
+    EXPECT_THROW(cp.addSubcommand({"cluster", "null"}, static_cast<void (*)(const ose4g::Args &)>(nullptr)), std::invalid_argument);
+}
+
 TEST(CommandProcessorTest, processShouldThrowIfFunctionNotAdded)
 {
     ose4g::CommandProcessorImpl cp("name");
@@ -137,6 +236,25 @@ INSTANTIATE_TEST_SUITE_P(TestSuite,
                                  "send",
                                  std::vector<std::string>{"hello world"}}));
 
+TEST(ParseStatementTest, parsingAgainShouldReuseTheBuffers)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    std::array<std::byte, 256> buffer;
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    ose4g::Command command;
+    ose4g::Args args;
+    ASSERT_TRUE(cp.parseStatement("send 'a long argument that does not fit inline' b c", command, args, &arena));
+    const char *first = args[0].data();
+    arena.release();
+    ASSERT_TRUE(cp.parseStatement("list 'another long argument, no allocation'", command, args, &arena));
+    EXPECT_EQ(command, "list");
+    EXPECT_EQ(args, (ose4g::Args{"another long argument, no allocation"}));
+    EXPECT_EQ(args[0].data(), first);
+    ASSERT_TRUE(cp.parseStatement("   ", command, args, &arena));
+    EXPECT_EQ(command, "");
+    EXPECT_TRUE(args.empty());
+}
+
 class TestCout : public testing::Test
 {
 public:
@@ -144,14 +262,15 @@ public:
     std::streambuf *sbuf;
     void SetUp() override
     {
+        ose4g::setColorMode(ose4g::ColorMode::ALWAYS);
         buffer.clear();
-        sbuf = std::cout.rdbuf();
-        std::cout.rdbuf(buffer.rdbuf());
+        sbuf = ose4g::redirectOutput(buffer.rdbuf());
     }
 
     void TearDown() override
     {
-        std::cout.rdbuf(sbuf);
+        ose4g::setColorMode(ose4g::ColorMode::AUTO);
+        ose4g::redirectOutput(sbuf);
     }
 };
 
@@ -162,6 +281,12 @@ TEST_F(TestCout, ShouldPrintsOnlyHelpByDefault)
     helpMessage += "\t\033[1;34mclear\033[0m: clear screen\n";
     helpMessage += "\t\033[1;34mexit\033[0m: exit program\n";
     helpMessage += "\t\033[1;34mhistory\033[0m: print history\n";
+    helpMessage += "\t\033[1;34malias\033[0m: list aliases or define one: alias name = command args; command args\n";
+    helpMessage += "\t\033[1;34mtrace\033[0m: record a timeline: trace start, then trace stop <file>\n";
+    helpMessage += "\t\033[1;34mparallel\033[0m: run a command once per argument: parallel [-j N] [--unordered] command args ::: arg1 arg2\n";
+    helpMessage += "\t\033[1;34mmem\033[0m: print the memory the process uses for commands, completion and history\n";
+    helpMessage += "\t\033[1;34mevery\033[0m: run a command periodically: every [--coalesce] 5s command args, every to list, every cancel id|all\n";
+    helpMessage += "\t\033[1;34mwatch\033[0m: run a command every 2s: watch [--coalesce] command args\n";
     cp.help();
     EXPECT_EQ(buffer.str(), helpMessage);
 }
@@ -175,12 +300,215 @@ TEST_F(TestCout, ShouldPrintDescriptionFromAllOtherCommands)
     helpMessage += "\t\033[1;34mclear\033[0m: clear screen\n";
     helpMessage += "\t\033[1;34mexit\033[0m: exit program\n";
     helpMessage += "\t\033[1;34mhistory\033[0m: print history\n";
+    helpMessage += "\t\033[1;34malias\033[0m: list aliases or define one: alias name = command args; command args\n";
+    helpMessage += "\t\033[1;34mtrace\033[0m: record a timeline: trace start, then trace stop <file>\n";
+    helpMessage += "\t\033[1;34mparallel\033[0m: run a command once per argument: parallel [-j N] [--unordered] command args ::: arg1 arg2\n";
+    helpMessage += "\t\033[1;34mmem\033[0m: print the memory the process uses for commands, completion and history\n";
+    helpMessage += "\t\033[1;34mevery\033[0m: run a command periodically: every [--coalesce] 5s command args, every to list, every cancel id|all\n";
+    helpMessage += "\t\033[1;34mwatch\033[0m: run a command every 2s: watch [--coalesce] command args\n";
     helpMessage += "\t\033[1;34mlist\033[0m: lists all active processes\n";
     helpMessage += "\t\033[1;34msend\033[0m: Usage send name args. Sends arg info\n";
     cp.help();
     EXPECT_EQ(buffer.str(), helpMessage);
 }
 
+TEST_F(TestCout, groupShouldPrintItsSubcommands)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.addGroup({"cluster"}, "manage the cluster");
+    cp.addSubcommand({"cluster", "node", "drain"}, [](const ose4g::Args &args) {}, "drain a node");
+    cp.addSubcommand({"cluster", "node", "add"}, [](const ose4g::Args &args) {}, "add a node");
+    cp.process("cluster", {"node"});
+    EXPECT_EQ(buffer.str(), "\t\t\033[1;34madd\033[0m: add a node\n\t\t\033[1;34mdrain\033[0m: drain a node\n");
+
+    buffer.str("");
+    cp.help({"cluster"});
+    EXPECT_EQ(buffer.str(), "\t\033[1;34mcluster\033[0m: manage the cluster\n\t\t\033[1;34mnode\033[0m: \n");
+}
+
+TEST_F(TestCout, streamingCommandShouldPrintEachChunk)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("count", [](const ose4g::Args &args) -> ose4g::Stream
+           {
+               for (auto &arg : args)
+                   co_yield arg + "\n";
+           }, "counts");
+    EXPECT_THROW(cp.add("count", [](const ose4g::Args &args) {}), std::invalid_argument);
+    cp.process("count", {"1", "2", "3"});
+    EXPECT_EQ(buffer.str(), "1\n2\n3\n");
+}
+
+TEST_F(TestCout, timeoutShouldStopStreamingCommand)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    bool cleanedUp = false;
+    cp.add("forever", [&](const ose4g::Args &) -> ose4g::Stream
+           {
+               std::shared_ptr<void> guard(nullptr, [&](void *) { cleanedUp = true; });
+               while (true)
+               {
+                   co_yield "a";
+                   std::this_thread::sleep_for(std::chrono::milliseconds(1));
+               } }, "", {.timeout = std::chrono::milliseconds(20)});
+    EXPECT_THROW(cp.process("forever", {}), std::runtime_error);
+    EXPECT_TRUE(buffer.str().starts_with("a"));
+    EXPECT_TRUE(cleanedUp);
+}
+
+TEST_F(TestCout, ctrlCShouldOnlyStopConsoleCommands)
+{
+    // Ctrl-C reaches console commands through their stop token, not commands run from anywhere else
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("stream", [&](const ose4g::Args &) -> ose4g::Stream
+           {
+               co_yield "a";
+               std::raise(SIGINT);
+               co_yield "b";
+               co_yield "c";
+           });
+    cp.add("echo", [](const ose4g::Args &args)
+           { std::cout << args[0]; });
+    ose4g::InterruptScope interrupts;
+    EXPECT_NO_THROW(cp.process("stream", {}));
+    EXPECT_NO_THROW(cp.process("parallel", {"echo", ":::", "d"}));
+    EXPECT_EQ(buffer.str(), "abcd\n1 succeeded, 0 failed");
+}
+
+TEST_F(TestCout, cachedCommandShouldReplayOutputUntilInvalidated)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    int calls = 0;
+    cp.add("lookup", [&](const ose4g::Args &args)
+           { std::cout << args[0] << calls++; }, "", {.cacheTtl = std::chrono::minutes(1)});
+    cp.add("write", [](const ose4g::Args &) {}, "", {.invalidates = {{"lookup"}}});
+
+    cp.process("lookup", {"a"});
+    cp.process("lookup", {"a"});
+    cp.process("lookup", {"b"});
+    EXPECT_EQ(buffer.str(), "a0a0b1");
+    EXPECT_EQ(cp.cacheStats({"lookup"}).hits, 1u);
+    EXPECT_EQ(cp.cacheStats({"lookup"}).misses, 2u);
+
+    cp.process("write", {});
+    cp.process("lookup", {"a"});
+    cp.invalidateCache({"lookup"});
+    cp.process("lookup", {"a"});
+    EXPECT_EQ(buffer.str(), "a0a0b1a2a3");
+    EXPECT_THROW(cp.invalidateCache({"missing"}), std::invalid_argument);
+}
+
+TEST_F(TestCout, aliasShouldRunItsCommandsWithArgumentsSubstituted)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("echo", [](const ose4g::Args &args)
+           {
+               for (auto &arg : args)
+                   std::cout << arg << ',';
+               std::cout << ';'; });
+    cp.defineAlias("twice", "echo 'a b' $1; echo $@ last");
+    cp.process("alias", {"e", "=", "echo", "x;", "twice", "$2", "$1"});
+    cp.process("twice", {"1", "2"});
+    EXPECT_EQ(buffer.str(), "a b,1,;1,2,last,;");
+
+    buffer.str("");
+    cp.process("e", {"1", "2"});
+    EXPECT_EQ(buffer.str(), "x,;a b,2,;2,1,last,;");
+
+    // no slots, the arguments go to the last command
+    buffer.str("");
+    cp.defineAlias("ee", "echo -l");
+    cp.process("ee", {"1"});
+    EXPECT_EQ(buffer.str(), "-l,1,;");
+    EXPECT_THROW(cp.process("twice", {}), std::invalid_argument);
+
+    buffer.str("");
+    cp.process("alias", {});
+    EXPECT_EQ(buffer.str(), "\t\033[1;34me\033[0m = echo x; twice $2 $1\n"
+                            "\t\033[1;34mee\033[0m = echo -l\n"
+                            "\t\033[1;34mtwice\033[0m = echo 'a b' $1; echo $@ last\n");
+}
+
+TEST_F(TestCout, aliasTypedAsALineShouldBeSplitLikeDefineAlias)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("echo", [](const ose4g::Args &args)
+           {
+               for (auto &arg : args)
+                   std::cout << arg << ',';
+               std::cout << ';'; });
+    cp.execute("alias x = echo a ;echo b");
+    cp.execute("alias y = echo a;echo b");
+    cp.execute("alias z = echo \"c;\" 'd e'");
+    buffer.str("");
+    cp.process("x", {});
+    cp.process("y", {});
+    cp.process("z", {});
+    EXPECT_EQ(buffer.str(), "a,;b,;a,;b,;c;,d e,;");
+
+    // without a line the arguments are read as if they had been typed
+    buffer.str("");
+    cp.process("alias", {"w", "=", "echo", "a;echo", "b c"});
+    cp.process("w", {});
+    EXPECT_EQ(buffer.str(), "a,;b c,;");
+}
+
+TEST(AliasTest, recursiveAliasesShouldBeRejected)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("list", [](const ose4g::Args &) {});
+    EXPECT_THROW(cp.defineAlias("loop", "list; loop"), std::invalid_argument);
+    cp.defineAlias("a", "list");
+    cp.defineAlias("b", "a");
+    EXPECT_THROW(cp.defineAlias("a", "b"), std::invalid_argument);
+    EXPECT_THROW(cp.defineAlias("list", "a"), std::invalid_argument);
+    EXPECT_NO_THROW(cp.defineAlias("a", "list -l"));
+    EXPECT_NO_THROW(cp.process("b", {}));
+}
+
+TEST(AliasTest, rcFileShouldDefineAliases)
+{
+    std::string path = testing::TempDir() + "aliases.rc";
+    {
+        std::ofstream rc(path);
+        rc << "# comment\n\nalias ll = list -l\nalias broken\n";
+    }
+    ose4g::CommandProcessorImpl cp("name");
+    ose4g::Args received;
+    cp.add("list", [&](const ose4g::Args &args) { received = args; });
+    try
+    {
+        cp.loadRcFile(path);
+        FAIL() << "expected the fourth line to fail";
+    }
+    catch (const std::invalid_argument &exc)
+    {
+        EXPECT_EQ(std::string(exc.what()), path + ":4: usage: alias name = command args; command args");
+    }
+    cp.process("ll", {"/tmp"});
+    EXPECT_EQ(received, (ose4g::Args{"-l", "/tmp"}));
+    std::remove(path.c_str());
+}
+
+TEST_F(TestCout, traceShouldRecordHandlerSpans)
+{
+    std::string path = testing::TempDir() + "commands.json";
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("work", [](const ose4g::Args &)
+           { ose4g::TraceSpan span("inside"); });
+    cp.process("trace", {"start"});
+    cp.process("work", {});
+    cp.process("trace", {"stop", path});
+    EXPECT_EQ(buffer.str(), "tracingwrote 3 spans to " + path);
+
+    std::ifstream file(path);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(json.find("\"name\":\"handler\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"inside\""), std::string::npos);
+    EXPECT_THROW(cp.process("trace", {"stop"}), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
 TEST(ValidateTest, argCountRuleShouldFailWithLessThanRequiredArguments)
 {
     ose4g::ArgCountRule<3> rule;
@@ -229,3 +557,269 @@ TEST(ValidateTest, testUserRuleSuccess)
     auto res = rule.apply(args);
     EXPECT_TRUE(res.first);
 }
+
+static std::string writeManifest(const std::string &name, const std::string &contents)
+{
+    std::string path = testing::TempDir() + name;
+    std::ofstream(path) << contents;
+    return path;
+}
+
+TEST_F(TestCout, pluginShouldLoadOnFirstUse)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    auto plugin = cp.loadPlugin(writeManifest("example.manifest",
+                                              "# example\nlibrary " PLUGIN_DIR "/exampleplugin.so\n"
+                                              "greet say hello\ncount count the arguments\n"));
+    EXPECT_FALSE(plugin->loaded());
+    cp.process("help", {});
+    EXPECT_NE(buffer.str().find("say hello"), std::string::npos);
+    EXPECT_FALSE(plugin->loaded());
+
+    buffer.str("");
+    cp.process("greet", {"bob"});
+    cp.process("count", {"a", "b"});
+    EXPECT_EQ(buffer.str(), "hello bob2");
+    EXPECT_TRUE(plugin->loaded());
+}
+
+TEST_F(TestCout, pluginCommandMissingFromLibraryShouldFail)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.loadPlugin(writeManifest("missing.manifest", "library " PLUGIN_DIR "/exampleplugin.so\nwave wave\n"));
+    EXPECT_THROW(cp.process("wave", {}), std::runtime_error);
+}
+
+TEST(PluginTest, loadPluginShouldRegisterNothingIfManifestIsInvalid)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    EXPECT_THROW(cp.loadPlugin(writeManifest("nolibrary.manifest", "greet say hello\n")), std::invalid_argument);
+    EXPECT_THROW(cp.loadPlugin(writeManifest("badname.manifest", "library x.so\ngreet hi\n2bad name\n")),
+                 std::invalid_argument);
+    cp.add("greet", [](const ose4g::Args &) {});
+    EXPECT_THROW(cp.loadPlugin(writeManifest("clash.manifest", "library x.so\ncount n\ngreet hi\n")),
+                 std::invalid_argument);
+    // count was not left behind by the failed load
+    EXPECT_NO_THROW(cp.loadPlugin(writeManifest("count.manifest", "library x.so\ncount n\n")));
+}
+
+TEST_F(TestCout, parallelShouldRunOncePerArgumentAndPrintInOrder)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    ose4g::ArgCountRule<2, 2> twoArgs;
+    std::atomic<int> running = 0, mostRunning = 0;
+    cp.add("ping", [&](const ose4g::Args &args)
+           {
+        int now = ++running;
+        mostRunning = std::max(mostRunning.load(), now);
+        // later hosts finish first
+        std::this_thread::sleep_for(std::chrono::milliseconds(40 - 10 * std::stoi(args[1])));
+        --running;
+        if (args[1] == "2")
+            throw std::runtime_error("unreachable");
+        std::cout << args[0] << args[1]; }, {&twoArgs});
+
+    EXPECT_THROW(cp.process("parallel", {"-j", "4", "ping", "-c", ":::", "0", "1", "2", "3"}), std::runtime_error);
+    std::ostringstream error;
+    error << ose4g::styled("ping 2: unreachable", ose4g::Style(ose4g::Color::RED));
+    EXPECT_EQ(buffer.str(), "-c0\n-c1\n" + error.str() + "\n-c3\n");
+    EXPECT_GT(mostRunning.load(), 1);
+}
+
+TEST_F(TestCout, parallelShouldValidateEachInvocation)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    ose4g::ArgCountRule<1, 1> oneArg;
+    cp.add("ping", [&](const ose4g::Args &args)
+           { std::cout << args[0]; }, {&oneArg});
+
+    cp.process("parallel", {"--unordered", "ping", ":::", "a", "b"});
+    EXPECT_TRUE(buffer.str() == "a\nb\n2 succeeded, 0 failed" || buffer.str() == "b\na\n2 succeeded, 0 failed");
+    EXPECT_THROW(cp.process("parallel", {"ping", "extra", ":::", "a"}), std::runtime_error);
+    EXPECT_THROW(cp.process("parallel", {"ping", "a"}), std::invalid_argument);
+    EXPECT_THROW(cp.process("parallel", {"-j", "0", "ping", ":::", "a"}), std::invalid_argument);
+    EXPECT_THROW(cp.process("parallel", {"history", ":::", "a"}), std::invalid_argument);
+
+    // nor through an alias, every call shares the session
+    buffer.str("");
+    cp.defineAlias("bye", "ping x; exit");
+    EXPECT_THROW(cp.process("parallel", {"bye", ":::", "a"}), std::runtime_error);
+    EXPECT_NE(buffer.str().find("parallel cannot run exit"), std::string::npos);
+}
+
+TEST_F(TestCout, parallelRunFromAHandlerInsideParallelShouldNotDeadlock)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("leaf", [](const ose4g::Args &args)
+           { std::cout << args[0]; });
+    cp.add("fan", [&](const ose4g::Args &args)
+           { cp.process("parallel", {"leaf", ":::", args[0] + "1", args[0] + "2"}); });
+    cp.process("parallel", {"-j", "2", "fan", ":::", "a", "b"});
+    for (auto output : {"a1", "a2", "b1", "b2"})
+    {
+        EXPECT_NE(buffer.str().find(output), std::string::npos) << output;
+    }
+}
+
+TEST(CommandProcessorTest, unknownCommandShouldSuggestClosestNames)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    for (auto name : {"deploy", "delete", "list", "lint", "last", "status"})
+        cp.add(name, [](const ose4g::Args &) {});
+    try
+    {
+        cp.process("deplyo", {});
+        FAIL();
+    }
+    catch (const std::invalid_argument &exc)
+    {
+        EXPECT_STREQ(exc.what(), "Command deplyo not found, did you mean deploy?");
+    }
+    try
+    {
+        cp.process("hepl", {});
+        FAIL();
+    }
+    catch (const std::invalid_argument &exc)
+    {
+        EXPECT_STREQ(exc.what(), "Command hepl not found, did you mean help?");
+    }
+    // builtins are suggested too, at most three names
+    try
+    {
+        cp.process("lsit", {});
+        FAIL();
+    }
+    catch (const std::invalid_argument &exc)
+    {
+        EXPECT_STREQ(exc.what(), "Command lsit not found, did you mean exit, last, lint?");
+    }
+    cp.remove("status");
+    EXPECT_THROW(
+        {
+            try
+            {
+                cp.process("stats", {});
+            }
+            catch (const std::invalid_argument &exc)
+            {
+                EXPECT_STREQ(exc.what(), "Command stats not found");
+                throw;
+            }
+        },
+        std::invalid_argument);
+}
+
+TEST_F(TestCout, addAllShouldAddEveryCommandOrNone)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    ose4g::ArgCountRule<1, 1> oneArg;
+    std::vector<ose4g::CommandDefinition> definitions;
+    for (int i = 0; i < 1000; i++)
+    {
+        definitions.push_back({.command = "cmd-" + std::to_string(i),
+                               .processor = [i](const ose4g::Args &args)
+                               { std::cout << i << args[0]; },
+                               .description = "command " + std::to_string(i),
+                               .rules = {&oneArg}});
+    }
+    cp.addAll(definitions);
+    cp.process("cmd-42", {"x"});
+    EXPECT_EQ(buffer.str(), "42x");
+    EXPECT_THROW(cp.process("cmd-42", {}), std::invalid_argument);
+    buffer.str("");
+    cp.process("help", {"cmd-999"});
+    EXPECT_NE(buffer.str().find("command 999"), std::string::npos);
+
+    // one bad definition and nothing is added
+    std::vector<ose4g::CommandDefinition> invalid{{.command = "fresh", .processor = [](const ose4g::Args &) {}},
+                                                  {.command = "2bad", .processor = [](const ose4g::Args &) {}}};
+    EXPECT_THROW(cp.addAll(invalid), std::invalid_argument);
+    std::vector<ose4g::CommandDefinition> clash{{.command = "fresh", .processor = [](const ose4g::Args &) {}},
+                                                {.command = "cmd-1", .processor = [](const ose4g::Args &) {}}};
+    EXPECT_THROW(cp.addAll(clash), std::invalid_argument);
+    EXPECT_THROW(cp.process("fresh", {}), std::invalid_argument);
+
+    // any range of definitions works
+    cp.addAll(std::views::iota(0, 3) | std::views::transform([](int i)
+                                                             { return ose4g::CommandDefinition{.command = "view-" + std::to_string(i),
+                                                                                               .processor = [](const ose4g::Args &) {}}; }));
+    EXPECT_NO_THROW(cp.process("view-2", {}));
+}
+
+TEST_F(TestCout, memShouldPrintEveryCategory)
+{
+    ose4g::CommandProcessor cp("test");
+    cp.setHistoryByteLimit(4096);
+    std::string captured(1000, 'x');
+    cp.add("big", [captured](const ose4g::Args &)
+           { std::cout << captured.size(); });
+    auto usage = cp.processMemoryUsage();
+    EXPECT_GE(usage[ose4g::MemoryCategory::HANDLERS].bytes, sizeof(std::string));
+    EXPECT_GT(usage[ose4g::MemoryCategory::REGISTRY].bytes, 0u);
+    EXPECT_GT(usage[ose4g::MemoryCategory::COMPLETION].bytes, 0u);
+    EXPECT_GT(usage[ose4g::MemoryCategory::SUGGESTIONS].bytes, 0u);
+
+    cp.execute("mem");
+    auto output = buffer.str();
+    for (auto name : {"completion", "suggestions", "registry", "handlers", "history", "total"})
+    {
+        EXPECT_NE(output.find(std::string("\033[1;34m") + name + "\033[0m: "), std::string::npos) << name;
+    }
+    EXPECT_NE(output.find("this session's history: 1 lines in "), std::string::npos);
+    EXPECT_NE(output.find(" of 4096"), std::string::npos);
+}
+
+TEST_F(TestCout, everyShouldScheduleRegisteredCommands)
+{
+    ose4g::CommandProcessor cp("test");
+    std::atomic<int> runs{0};
+    std::atomic<bool> go{false};
+    cp.add("tick", [&](const ose4g::Args &args)
+           {
+        // the first run starts right away, keep it from printing while the test does
+        while (!go)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        runs++;
+        std::cout << "tick " << args[0]; });
+    auto waitForRuns = [&](int count)
+    {
+        for (int i = 0; i < 1000 && (runs < count || cp.schedules().empty() || cp.schedules().back().running); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    };
+    EXPECT_THROW(cp.schedule(std::chrono::seconds(1), "history"), std::invalid_argument);
+    EXPECT_THROW(cp.schedule(std::chrono::seconds(1), "tock"), std::invalid_argument);
+
+    cp.execute("every 1h tick once");
+    EXPECT_NE(buffer.str().find("scheduled 1, stop it with every cancel 1"), std::string::npos);
+    go = true;
+    waitForRuns(1);
+    EXPECT_NE(buffer.str().find("\033[1;34mevery 1h: tick once\033[0m\ntick once\n"), std::string::npos);
+
+    buffer.str("");
+    cp.execute("every");
+    EXPECT_NE(buffer.str().find("\t1: \033[1;34mevery 1h\033[0m tick once, 1 runs, 0 skipped\n"), std::string::npos);
+    cp.execute("every cancel 1");
+    EXPECT_TRUE(cp.schedules().empty());
+    buffer.str("");
+    cp.execute("every cancel 1");
+    EXPECT_NE(buffer.str().find("no schedule 1"), std::string::npos);
+    cp.execute("every 0s tick");
+    EXPECT_NE(buffer.str().find("must be more than zero"), std::string::npos);
+    EXPECT_TRUE(cp.schedules().empty());
+
+    go = false;
+    cp.execute("watch --coalesce tick twice");
+    go = true;
+    waitForRuns(2);
+    ASSERT_EQ(cp.schedules().size(), 1u);
+    EXPECT_EQ(cp.schedules()[0].period, std::chrono::seconds(2));
+    EXPECT_EQ(cp.schedules()[0].overrun, ose4g::Scheduler::Overrun::COALESCE);
+    buffer.str("");
+    cp.execute("every cancel all");
+    EXPECT_NE(buffer.str().find("cancelled 1"), std::string::npos);
+}
@@ -0,0 +1,14 @@
+// Example plugin, built as a shared object next to the other targets.
+//
+// A host loads it with CommandProcessor::loadPlugin("exampleplugin.manifest")
+// where the manifest lists the library and the commands below.
+#include "plugin.h"
+#include <iostream>
+
+extern "C" void ose4g_register_plugin(ose4g::PluginRegistrar &registrar)
+{
+    registrar.add("greet", [](const ose4g::Args &args)
+                  { std::cout << "hello " << (args.empty() ? "world" : args[0]); });
+    registrar.add("count", [](const ose4g::Args &args)
+                  { std::cout << args.size(); });
+}
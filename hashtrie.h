@@ -0,0 +1,333 @@
+#ifndef HASHTRIE_H
+#define HASHTRIE_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "memory.h"
+
+namespace ose4g
+{
+    /**
+     * @brief Map from strings to values whose copies share everything they have in common.
+     *
+     * A hash array mapped trie: each level is indexed by the next 5 bits of
+     * the key's hash and a node only holds the slots in use, found with a
+     * bitmap and a popcount. Like AutoComplete's, nodes are immutable once
+     * shared, so copying the map copies one pointer and set and erase copy
+     * only the nodes on the path to the key, a handful even for millions of
+     * keys. Nodes no other copy can reach are changed in place. Keys whose
+     * whole hash is equal end up in one node below the last level and are
+     * told apart by comparing them. Iteration order is by hash, not by key.
+     * Nodes are counted in the category given to the constructor.
+     */
+    template <typename Value, typename Hash = std::hash<std::string>>
+    class HashTrie
+    {
+    public:
+        using Key = std::string;
+        using value_type = std::pair<Key, Value>;
+
+    private:
+        static constexpr unsigned BITS = 5;
+        static constexpr unsigned HASH_BITS = sizeof(std::size_t) * 8;
+
+        struct Node;
+        using NodePointer = std::shared_ptr<const Node>;
+
+        // a key and its value, or the next level down when child is set
+        struct Slot
+        {
+            std::size_t hash = 0;
+            NodePointer child;
+            value_type item;
+        };
+
+        struct Node
+        {
+            // unused below the last level, where slots are kept in a plain list
+            std::uint32_t bitmap = 0;
+            std::vector<Slot, CountingAllocator<Slot>> slots;
+
+            explicit Node(MemoryCategory category) : slots(CountingAllocator<Slot>(category)) {}
+        };
+
+        MemoryCategory d_category;
+        NodePointer d_root;
+        std::size_t d_size = 0;
+
+        static std::uint32_t bitFor(std::size_t hash, unsigned shift)
+        {
+            return std::uint32_t{1} << ((hash >> shift) & ((1u << BITS) - 1));
+        }
+
+        static std::size_t indexOf(std::uint32_t bitmap, std::uint32_t bit)
+        {
+            return std::popcount(bitmap & (bit - 1));
+        }
+
+        /*
+         * A node only this map can reach is changed in place, e.g. when many
+         * keys are set in a row. That takes the node and all its parents
+         * having no other owner, a parent that is copied later on the way up
+         * would still share it with other maps.
+         */
+        std::shared_ptr<Node> own(const NodePointer &node, bool parentsOwned = true) const
+        {
+            if (!node)
+            {
+                return makeCounted<Node>(d_category, d_category);
+            }
+            if (parentsOwned && node.use_count() == 1)
+            {
+                return std::const_pointer_cast<Node>(node);
+            }
+            return makeCounted<Node>(d_category, *node);
+        }
+
+        // returns node with key set, its parents are already owned and it is owned if nothing else holds it
+        NodePointer set(const NodePointer &node, std::size_t hash, unsigned shift, const Key &key, Value &&value, bool &added) const
+        {
+            auto copy = own(node);
+            if (shift >= HASH_BITS)
+            {
+                for (auto &slot : copy->slots)
+                {
+                    if (slot.item.first == key)
+                    {
+                        slot.item.second = std::move(value);
+                        return copy;
+                    }
+                }
+                copy->slots.push_back(Slot{hash, nullptr, {key, std::move(value)}});
+                added = true;
+                return copy;
+            }
+            std::uint32_t bit = bitFor(hash, shift);
+            auto slot = copy->slots.begin() + indexOf(copy->bitmap, bit);
+            if (!(copy->bitmap & bit))
+            {
+                copy->bitmap |= bit;
+                copy->slots.insert(slot, Slot{hash, nullptr, {key, std::move(value)}});
+                added = true;
+            }
+            else if (slot->child)
+            {
+                slot->child = set(slot->child, hash, shift + BITS, key, std::move(value), added);
+            }
+            else if (slot->item.first == key)
+            {
+                slot->item.second = std::move(value);
+            }
+            else
+            {
+                // two keys want the slot, both move a level down
+                bool moved = false;
+                auto child = set(nullptr, slot->hash, shift + BITS, slot->item.first, std::move(slot->item.second), moved);
+                child = set(child, hash, shift + BITS, key, std::move(value), added);
+                *slot = Slot{0, std::move(child), {}};
+            }
+            return copy;
+        }
+
+        // returns node without key, nullptr once it is empty, node itself untouched if key is not there
+        NodePointer erase(const NodePointer &node, std::size_t hash, unsigned shift, const Key &key, bool &erased, bool parentsOwned = true) const
+        {
+            // children are changed before their parent is owned, so ownership is passed down
+            bool owned = parentsOwned && node.use_count() == 1;
+            std::size_t index = 0;
+            NodePointer child;
+            if (shift >= HASH_BITS)
+            {
+                while (index < node->slots.size() && node->slots[index].item.first != key)
+                {
+                    index++;
+                }
+                if (index == node->slots.size())
+                {
+                    return node;
+                }
+                erased = true;
+            }
+            else
+            {
+                std::uint32_t bit = bitFor(hash, shift);
+                if (!(node->bitmap & bit))
+                {
+                    return node;
+                }
+                index = indexOf(node->bitmap, bit);
+                const Slot &slot = node->slots[index];
+                if (slot.child)
+                {
+                    child = erase(slot.child, hash, shift + BITS, key, erased, owned);
+                }
+                else
+                {
+                    erased = slot.item.first == key;
+                }
+                if (!erased)
+                {
+                    return node;
+                }
+            }
+            auto copy = own(node, owned);
+            if (child)
+            {
+                copy->slots[index].child = std::move(child);
+                return copy;
+            }
+            if (shift < HASH_BITS)
+            {
+                copy->bitmap &= ~bitFor(hash, shift);
+            }
+            copy->slots.erase(copy->slots.begin() + index);
+            return copy->slots.empty() ? nullptr : NodePointer(std::move(copy));
+        }
+
+    public:
+        /// @brief visits every key and value, in no particular order
+        class const_iterator
+        {
+        private:
+            // the node and slot at every level down to the current item
+            std::vector<std::pair<const Node *, std::size_t>> d_path;
+
+            // moves to the first item at or after the current position
+            void settle()
+            {
+                while (!d_path.empty())
+                {
+                    auto &[node, index] = d_path.back();
+                    if (index == node->slots.size())
+                    {
+                        d_path.pop_back();
+                        if (!d_path.empty())
+                        {
+                            d_path.back().second++;
+                        }
+                        continue;
+                    }
+                    if (!node->slots[index].child)
+                    {
+                        return;
+                    }
+                    d_path.emplace_back(node->slots[index].child.get(), 0);
+                }
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = HashTrie::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type *;
+            using reference = const value_type &;
+
+            const_iterator() = default;
+
+            explicit const_iterator(const Node *root)
+            {
+                if (root)
+                {
+                    d_path.emplace_back(root, 0);
+                    settle();
+                }
+            }
+
+            reference operator*() const { return d_path.back().first->slots[d_path.back().second].item; }
+            pointer operator->() const { return &**this; }
+
+            const_iterator &operator++()
+            {
+                d_path.back().second++;
+                settle();
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                auto previous = *this;
+                ++*this;
+                return previous;
+            }
+
+            bool operator==(const const_iterator &other) const { return d_path == other.d_path; }
+        };
+
+        explicit HashTrie(MemoryCategory category) : d_category(category) {}
+
+        /// @brief the value of key, nullptr if there is none
+        const Value *find(const Key &key) const
+        {
+            std::size_t hash = Hash{}(key);
+            const Node *node = d_root.get();
+            for (unsigned shift = 0; node; shift += BITS)
+            {
+                if (shift >= HASH_BITS)
+                {
+                    for (auto &slot : node->slots)
+                    {
+                        if (slot.item.first == key)
+                        {
+                            return &slot.item.second;
+                        }
+                    }
+                    return nullptr;
+                }
+                std::uint32_t bit = bitFor(hash, shift);
+                if (!(node->bitmap & bit))
+                {
+                    return nullptr;
+                }
+                const Slot &slot = node->slots[indexOf(node->bitmap, bit)];
+                if (!slot.child)
+                {
+                    return slot.item.first == key ? &slot.item.second : nullptr;
+                }
+                node = slot.child.get();
+            }
+            return nullptr;
+        }
+
+        bool contains(const Key &key) const { return find(key) != nullptr; }
+
+        /// @brief adds key or replaces its value
+        void set(const Key &key, Value value)
+        {
+            bool added = false;
+            d_root = set(d_root, Hash{}(key), 0, key, std::move(value), added);
+            d_size += added;
+        }
+
+        /// @returns false if there was no such key
+        bool erase(const Key &key)
+        {
+            if (!d_root)
+            {
+                return false;
+            }
+            bool erased = false;
+            auto root = erase(d_root, Hash{}(key), 0, key, erased);
+            if (erased)
+            {
+                d_root = std::move(root);
+                d_size--;
+            }
+            return erased;
+        }
+
+        std::size_t size() const { return d_size; }
+        bool empty() const { return d_size == 0; }
+
+        const_iterator begin() const { return const_iterator(d_root.get()); }
+        const_iterator end() const { return const_iterator(); }
+    };
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include "hashtrie.h"
+
+namespace
+{
+    // every key lands in the node below the last level
+    struct SameHash
+    {
+        std::size_t operator()(const std::string &) const { return 42; }
+    };
+
+    // keys share the low bits, so they only split a few levels down
+    struct SharedLowBits
+    {
+        std::size_t operator()(const std::string &key) const { return std::hash<std::string>{}(key) << 20; }
+    };
+
+    template <typename Trie>
+    std::set<std::string> keys(const Trie &trie)
+    {
+        std::set<std::string> found;
+        for (auto &item : trie)
+        {
+            EXPECT_EQ(item.second, static_cast<int>(item.first.size()));
+            found.insert(item.first);
+        }
+        return found;
+    }
+}
+
+TEST(HashTrieTest, shouldSetFindAndEraseKeys)
+{
+    ose4g::HashTrie<int> trie(ose4g::MemoryCategory::REGISTRY);
+    EXPECT_TRUE(trie.empty());
+    EXPECT_EQ(trie.begin(), trie.end());
+    for (int i = 0; i < 5000; i++)
+    {
+        auto key = "command" + std::to_string(i);
+        trie.set(key, key.size());
+    }
+    EXPECT_EQ(trie.size(), 5000u);
+    ASSERT_NE(trie.find("command4999"), nullptr);
+    EXPECT_EQ(*trie.find("command4999"), 11);
+    EXPECT_EQ(trie.find("command5000"), nullptr);
+    EXPECT_EQ(keys(trie).size(), 5000u);
+
+    trie.set("command1", 9);
+    EXPECT_EQ(*trie.find("command1"), 9);
+    EXPECT_EQ(trie.size(), 5000u);
+    trie.set("command1", 8);
+
+    for (int i = 0; i < 5000; i += 2)
+    {
+        EXPECT_TRUE(trie.erase("command" + std::to_string(i)));
+    }
+    EXPECT_FALSE(trie.erase("command0"));
+    EXPECT_EQ(trie.size(), 2500u);
+    EXPECT_EQ(trie.find("command0"), nullptr);
+    EXPECT_NE(trie.find("command1"), nullptr);
+    EXPECT_EQ(keys(trie).size(), 2500u);
+}
+
+TEST(HashTrieTest, copiesShouldNotSeeEachOthersChanges)
+{
+    ose4g::HashTrie<int> trie(ose4g::MemoryCategory::REGISTRY);
+    for (int i = 0; i < 100; i++)
+    {
+        auto key = std::to_string(i);
+        trie.set(key, key.size());
+    }
+    auto copy = trie;
+    copy.set("new", 3);
+    copy.erase("7");
+    trie.erase("8");
+
+    EXPECT_NE(trie.find("7"), nullptr);
+    EXPECT_EQ(trie.find("new"), nullptr);
+    EXPECT_EQ(trie.find("8"), nullptr);
+    EXPECT_EQ(copy.find("7"), nullptr);
+    EXPECT_NE(copy.find("8"), nullptr);
+    EXPECT_EQ(trie.size(), 99u);
+    EXPECT_EQ(copy.size(), 100u);
+    EXPECT_EQ(keys(copy).count("new"), 1u);
+}
+
+TEST(HashTrieTest, keysWithTheSameHashShouldBeToldApart)
+{
+    ose4g::HashTrie<int, SameHash> same(ose4g::MemoryCategory::REGISTRY);
+    ose4g::HashTrie<int, SharedLowBits> shared(ose4g::MemoryCategory::REGISTRY);
+    for (auto key : {"a", "bb", "ccc", "dddd"})
+    {
+        same.set(key, std::string(key).size());
+        shared.set(key, std::string(key).size());
+    }
+    EXPECT_EQ(keys(same), (std::set<std::string>{"a", "bb", "ccc", "dddd"}));
+    EXPECT_EQ(keys(shared), (std::set<std::string>{"a", "bb", "ccc", "dddd"}));
+    EXPECT_EQ(*same.find("ccc"), 3);
+    EXPECT_EQ(same.find("e"), nullptr);
+
+    auto copy = same;
+    EXPECT_TRUE(copy.erase("bb"));
+    EXPECT_TRUE(shared.erase("bb"));
+    EXPECT_EQ(copy.find("bb"), nullptr);
+    EXPECT_NE(same.find("bb"), nullptr);
+    EXPECT_EQ(shared.find("bb"), nullptr);
+    EXPECT_EQ(*shared.find("dddd"), 4);
+    for (auto key : {"a", "ccc", "dddd"})
+    {
+        copy.erase(key);
+    }
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(copy.begin(), copy.end());
+}
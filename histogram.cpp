@@ -0,0 +1,72 @@
+#include "histogram.h"
+#include <algorithm>
+#include <bit>
+
+namespace ose4g
+{
+    /*
+     * Values below 2 * SUB_BUCKETS index their own bucket. Above that a value
+     * is shifted right until it has SUB_BUCKET_BITS + 1 bits, the shift picks
+     * the power of two and the bits below the leading one the bucket in it.
+     */
+    std::size_t LatencyHistogram::bucketOf(std::uint64_t value)
+    {
+        if (value < 2 * SUB_BUCKETS)
+        {
+            return value;
+        }
+        unsigned shift = std::bit_width(value) - SUB_BUCKET_BITS - 1;
+        return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+    }
+
+    std::uint64_t LatencyHistogram::valueOf(std::size_t bucket)
+    {
+        if (bucket < 2 * SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        unsigned shift = bucket / SUB_BUCKETS - 1;
+        std::uint64_t lowest = (bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+        return lowest + (std::uint64_t{1} << shift) / 2;
+    }
+
+    LatencyHistogram::LatencyHistogram() : d_counts(bucketOf(UINT64_MAX) + 1) {}
+
+    void LatencyHistogram::record(std::chrono::nanoseconds latency)
+    {
+        std::uint64_t value = std::max<std::int64_t>(latency.count(), 0);
+        d_counts[bucketOf(value)]++;
+        d_count++;
+        d_max = std::max(d_max, value);
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram &other)
+    {
+        for (std::size_t i = 0; i < d_counts.size(); i++)
+        {
+            d_counts[i] += other.d_counts[i];
+        }
+        d_count += other.d_count;
+        d_max = std::max(d_max, other.d_max);
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::percentile(double p) const
+    {
+        if (d_count == 0)
+        {
+            return std::chrono::nanoseconds(0);
+        }
+        // the same rank as indexing the sorted latencies with p * count
+        std::uint64_t rank = std::min(d_count - 1, static_cast<std::uint64_t>(std::max(p, 0.0) * d_count));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < d_counts.size(); i++)
+        {
+            seen += d_counts[i];
+            if (seen > rank)
+            {
+                return std::chrono::nanoseconds(std::min(valueOf(i), d_max));
+            }
+        }
+        return max();
+    }
+}
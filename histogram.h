@@ -0,0 +1,50 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ose4g
+{
+    /**
+     * @brief Counts latencies in a fixed number of logarithmic buckets.
+     *
+     * Every power of two is split into 128 equal buckets, so a percentile is
+     * within 1% of the latency actually recorded while the histogram stays
+     * the same size however many latencies it holds. Latencies below 256ns
+     * are kept exactly. The largest latency is kept exactly as well.
+     * Histograms of threads recording on their own can be merged afterwards.
+     */
+    class LatencyHistogram
+    {
+    private:
+        static constexpr unsigned SUB_BUCKET_BITS = 7;
+        static constexpr std::uint64_t SUB_BUCKETS = std::uint64_t{1} << SUB_BUCKET_BITS;
+
+        std::vector<std::uint64_t> d_counts;
+        std::uint64_t d_count = 0;
+        std::uint64_t d_max = 0;
+
+        static std::size_t bucketOf(std::uint64_t value);
+        // the middle of the values that fall into bucket
+        static std::uint64_t valueOf(std::size_t bucket);
+
+    public:
+        LatencyHistogram();
+
+        void record(std::chrono::nanoseconds latency);
+
+        /// @brief adds every latency recorded in other
+        void merge(const LatencyHistogram &other);
+
+        std::uint64_t count() const { return d_count; }
+
+        /// @brief the latency p of the recorded ones are below, p in [0, 1], zero if there are none
+        std::chrono::nanoseconds percentile(double p) const;
+
+        std::chrono::nanoseconds max() const { return std::chrono::nanoseconds(d_max); }
+    };
+}
+
+#endif
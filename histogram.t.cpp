@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include "histogram.h"
+
+using namespace std::chrono_literals;
+
+TEST(LatencyHistogramTest, percentilesShouldBeWithinOnePercent)
+{
+    ose4g::LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(0.5), 0ns);
+    for (int i = 1; i <= 100000; i++)
+    {
+        histogram.record(std::chrono::nanoseconds(i * 100));
+    }
+    EXPECT_EQ(histogram.count(), 100000u);
+    EXPECT_EQ(histogram.max(), 10ms);
+    EXPECT_NEAR(histogram.percentile(0.50).count(), 5000000, 50000);
+    EXPECT_NEAR(histogram.percentile(0.99).count(), 9900000, 99000);
+    EXPECT_LE(histogram.percentile(1.0), histogram.max());
+}
+
+TEST(LatencyHistogramTest, smallLatenciesShouldBeExact)
+{
+    ose4g::LatencyHistogram histogram;
+    for (int i = 0; i < 200; i++)
+    {
+        histogram.record(std::chrono::nanoseconds(i));
+    }
+    EXPECT_EQ(histogram.percentile(0.0), 0ns);
+    EXPECT_EQ(histogram.percentile(0.5), 100ns);
+    EXPECT_EQ(histogram.percentile(1.0), 199ns);
+}
+
+TEST(LatencyHistogramTest, mergedHistogramsShouldCountBoth)
+{
+    ose4g::LatencyHistogram fast;
+    ose4g::LatencyHistogram slow;
+    for (int i = 0; i < 90; i++)
+    {
+        fast.record(1us);
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        slow.record(1s);
+    }
+    fast.merge(slow);
+    EXPECT_EQ(fast.count(), 100u);
+    EXPECT_EQ(fast.max(), 1s);
+    EXPECT_NEAR(fast.percentile(0.5).count(), 1000, 10);
+    EXPECT_NEAR(fast.percentile(0.95).count(), 1000000000, 10000000);
+}
@@ -4,14 +4,16 @@ namespace ose4g
 {
     void History::addBack(const std::string &record)
     {
-        d_historyDB.push_back(record);
+        d_historyDB.emplace_back(record, d_historyDB.get_allocator());
         d_iterator = d_historyDB.end();
+        evict();
     }
 
     void History::addFront(const std::string &record)
     {
-        d_historyDB.push_front(record);
+        d_historyDB.emplace_front(record, d_historyDB.get_allocator());
         d_iterator = d_historyDB.begin();
+        evict();
     }
 
     std::pair<bool, const std::string> History::getPrevious()
@@ -22,10 +24,10 @@ namespace ose4g
         }
         if (d_iterator == d_historyDB.begin())
         {
-            return {false, *d_iterator};
+            return {false, std::string(*d_iterator)};
         }
         d_iterator--;
-        return {true, *d_iterator};
+        return {true, std::string(*d_iterator)};
     }
 
     std::pair<bool, const std::string> History::getNext()
@@ -41,7 +43,7 @@ namespace ose4g
             return {false, ""};
         }
         d_iterator++;
-        return {true, *d_iterator};
+        return {true, std::string(*d_iterator)};
     }
 
     void History::edit(const std::string &s)
@@ -49,7 +51,8 @@ namespace ose4g
         // so we know that the iterator is valid
         if(d_historyDB.size() > 0)
         {
-            *d_iterator = s;
+            d_iterator->assign(s);
+            evict();
         }
     }
 
@@ -59,8 +62,41 @@ namespace ose4g
 
         for (auto it = d_historyDB.begin(); it != d_historyDB.end(); it++)
         {
-            s += (*it + "\n");
+            s += *it;
+            s += "\n";
         }
         return s;
     }
+
+    void History::write(std::ostream &out) const
+    {
+        for (auto &record : d_historyDB)
+        {
+            out << record << '\n';
+        }
+    }
+
+    void History::clear()
+    {
+        d_historyDB.clear();
+        d_iterator = d_historyDB.end();
+    }
+
+    void History::setByteLimit(std::size_t bytes)
+    {
+        d_byteLimit = bytes;
+        evict();
+    }
+
+    void History::evict()
+    {
+        while (d_byteLimit > 0 && bytes() > d_byteLimit && d_historyDB.size() > 1)
+        {
+            if (d_iterator == d_historyDB.begin())
+            {
+                d_iterator++;
+            }
+            d_historyDB.pop_front();
+        }
+    }
 }
\ No newline at end of file
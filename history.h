@@ -2,17 +2,36 @@
 #define HISTORY_H
 
 #include <list>
+#include <ostream>
 #include <string>
+#include "memory.h"
 
 namespace ose4g
 {
-
+    /**
+     * List of entered lines navigated with the arrow keys.
+     *
+     * Lines are counted in the history's own MemoryAccount, which also adds
+     * to the process wide MemoryCategory::HISTORY one. With a byte limit set
+     * the oldest lines are dropped once the history holds more than that.
+     */
     class History
     {
-        std::list<std::string> d_historyDB;
-        std::list<std::string>::iterator d_iterator;
+        MemoryAccount d_account{&memoryAccount(MemoryCategory::HISTORY)};
+        std::list<CountedString, CountingAllocator<CountedString>> d_historyDB{CountingAllocator<CountedString>(d_account)};
+        std::list<CountedString, CountingAllocator<CountedString>>::iterator d_iterator;
+        std::size_t d_byteLimit = 0;
+
+        // drops lines from the front until the history fits in d_byteLimit
+        void evict();
 
     public:
+        History() = default;
+
+        // the list allocates from d_account
+        History(const History &) = delete;
+        History &operator=(const History &) = delete;
+
         /// @brief get the previous value from history
         /// @return pair of bool of {success, value}
         std::pair<bool, const std::string> getPrevious();
@@ -22,11 +41,11 @@ namespace ose4g
         std::pair<bool, const std::string> getNext();
 
         /// @brief add record to bottom of history
-        /// @param record 
+        /// @param record
         void addBack(const std::string &record);
 
         /// @brief add record to top of history
-        /// @param record 
+        /// @param record
         void addFront(const std::string &record);
 
         /// @brief edit current position in history
@@ -36,7 +55,29 @@ namespace ose4g
         /// @brief get all values in history
         /// @return string of all values from history
         std::string getAllHistory();
+
+        /// @brief writes every value one per line, without building one string of all of them
+        void write(std::ostream &out) const;
+
+        /// @brief removes every record
+        void clear();
+
+        /**
+         * @brief caps the memory used by the records, zero (the default) means no cap.
+         *
+         * Records are dropped from the top, where the oldest ones are when
+         * records are added with addBack, until the history fits. The bottom
+         * record is kept even if it is larger on its own.
+         */
+        void setByteLimit(std::size_t bytes);
+
+        std::size_t byteLimit() const { return d_byteLimit; }
+
+        /// @brief bytes allocated for the records, list nodes included
+        std::size_t bytes() const { return d_account.bytes(); }
+
+        std::size_t size() const { return d_historyDB.size(); }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
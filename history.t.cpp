@@ -49,4 +49,44 @@ TEST(HistoryTest, getNextShouldReturnCorrectHistory)
     auto f = history.getNext();
     EXPECT_TRUE(f.first);
     EXPECT_EQ(f.second, "history");
-}
\ No newline at end of file
+}
+TEST(HistoryTest, shouldCountTheBytesOfItsRecords)
+{
+    ose4g::History history;
+    EXPECT_EQ(history.bytes(), 0u);
+    history.addBack(std::string(100, 'x'));
+    EXPECT_GT(history.bytes(), 100u);
+    history.clear();
+    EXPECT_EQ(history.bytes(), 0u);
+    EXPECT_EQ(history.size(), 0u);
+}
+
+TEST(HistoryTest, byteLimitShouldDropTheOldestRecords)
+{
+    ose4g::History history;
+    history.addBack(std::string(100, 'a'));
+    std::size_t perRecord = history.bytes();
+    history.setByteLimit(3 * perRecord);
+    history.addBack(std::string(100, 'b'));
+    history.addBack(std::string(100, 'c'));
+    history.addBack(std::string(100, 'd'));
+    EXPECT_EQ(history.size(), 3u);
+    EXPECT_LE(history.bytes(), 3 * perRecord);
+    EXPECT_EQ(history.getAllHistory(), std::string(100, 'b') + "\n" + std::string(100, 'c') + "\n" + std::string(100, 'd') + "\n");
+
+    // navigation still works after the oldest record went away
+    EXPECT_EQ(history.getPrevious().second, std::string(100, 'd'));
+    EXPECT_EQ(history.getPrevious().second, std::string(100, 'c'));
+    EXPECT_EQ(history.getPrevious().second, std::string(100, 'b'));
+    EXPECT_FALSE(history.getPrevious().first);
+}
+
+TEST(HistoryTest, byteLimitShouldKeepTheLastRecord)
+{
+    ose4g::History history;
+    history.setByteLimit(10);
+    history.addBack(std::string(100, 'a'));
+    history.addBack(std::string(100, 'b'));
+    EXPECT_EQ(history.size(), 1u);
+    EXPECT_EQ(history.getPrevious().second, std::string(100, 'b'));
+}
@@ -2,6 +2,42 @@
 
 namespace ose4g
 {
+    namespace
+    {
+        volatile std::sig_atomic_t s_interrupted = 0;
+
+        void onInterrupt(int)
+        {
+            s_interrupted = s_interrupted + 1;
+        }
+    }
+
+    InterruptScope::InterruptScope()
+    {
+        s_interrupted = 0;
+        struct sigaction action{};
+        action.sa_handler = onInterrupt;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &d_previous);
+    }
+
+    InterruptScope::~InterruptScope()
+    {
+        sigaction(SIGINT, &d_previous, nullptr);
+        // handled by whoever held the scope, code running afterwards must not see it
+        s_interrupted = 0;
+    }
+
+    bool InterruptScope::requested()
+    {
+        return s_interrupted != 0;
+    }
+
+    int InterruptScope::count()
+    {
+        return s_interrupted;
+    }
+
     void KeyboardInput::enableKeyboard()
     {
         if (!enabled)
@@ -12,8 +48,9 @@ namespace ose4g
             // create copy of terminal.
             auto raw = original;
             // disables line buffereing for input and echoing to terminal when you input.
-            raw.c_lflag &= ~(ICANON | ECHO); 
-            tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+            // ISIG off so Ctrl-C reaches us as a key instead of killing the program.
+            raw.c_lflag &= ~(ICANON | ECHO | ISIG); 
+            tcsetattr(STDIN_FILENO, TCSADRAIN, &raw);
         }
         enabled = true;
     }
@@ -21,7 +58,7 @@ namespace ose4g
     void KeyboardInput::disableKeyboard()
     {
         // resets he terminal keyboard to original settings. 
-        tcsetattr(STDIN_FILENO, TCSAFLUSH, &original);
+        tcsetattr(STDIN_FILENO, TCSADRAIN, &original);
         enabled = false;
     }
 
@@ -34,51 +71,88 @@ namespace ose4g
 
     KeyboardInput::Input KeyboardInput::getInput()
     {
-        while (true)
+        // decoder is static so a partially read escape sequence survives between calls
+        static KeyDecoder decoder;
+        Input input;
+        char c;
+        while (read(STDIN_FILENO, &c, 1) == 1)
         {
-            char c;
-            if (read(STDIN_FILENO, &c, 1) == 1)
+            if (decoder.feed(c, input))
             {
-                if (c == '\033')
-                { // ESC or start of escape sequence
-                    char seq[2];
-                    if (read(STDIN_FILENO, &seq[0], 1) == 1 &&
-                        read(STDIN_FILENO, &seq[1], 1) == 1)
-                    {
-                        if (seq[0] == '[')
-                        {
-                            switch (seq[1])
-                            {
-                            case 'A':
-                                return {InputType::ARROW_UP, ' '};
-                            case 'B':
-                                return {InputType::ARROW_DOWN, ' '};
-                            case 'C':
-                                return {InputType::ARROW_RIGHT, ' '};
-                            case 'D':
-                                return {InputType::ARROW_LEFT, ' '};
-                            }
-                        }
-                    }
-                }
-                else if (c == '\t')
-                {
-                    return {InputType::TAB, ' '};
-                }
-                else if (c == '\n')
-                {
-                    return {InputType::ENTER, ' '};
-                }
-                else if (c == 127 || c == '\b')
-                {
-                    return {InputType::BACKSPACE, ' '};
-                }
-                else
-                {
-                    return {InputType::ASCII, c};
-                }
+                return input;
             }
         }
         return {InputType::INVALID_INPUT, ' '};
     }
+
+    bool KeyDecoder::feed(char c, KeyboardInput::Input &input)
+    {
+        using InputType = KeyboardInput::InputType;
+        bool afterCarriageReturn = d_afterCarriageReturn;
+        d_afterCarriageReturn = false;
+
+        if (d_state == State::ESCAPE)
+        {
+            d_state = c == '[' ? State::BRACKET : State::NORMAL;
+            return false;
+        }
+        if (d_state == State::BRACKET)
+        {
+            d_state = State::NORMAL;
+            switch (c)
+            {
+            case 'A':
+                input = {InputType::ARROW_UP, ' '};
+                return true;
+            case 'B':
+                input = {InputType::ARROW_DOWN, ' '};
+                return true;
+            case 'C':
+                input = {InputType::ARROW_RIGHT, ' '};
+                return true;
+            case 'D':
+                input = {InputType::ARROW_LEFT, ' '};
+                return true;
+            }
+            return false;
+        }
+
+        if (c == '\033')
+        { // ESC or start of escape sequence
+            d_state = State::ESCAPE;
+            return false;
+        }
+        if (c == '\t')
+        {
+            input = {InputType::TAB, ' '};
+        }
+        else if (c == '\003')
+        {
+            // Ctrl-C with ISIG off
+            input = {InputType::INTERRUPT, ' '};
+        }
+        else if (c == '\r')
+        {
+            // raw sockets and terminals without ICRNL send \r or \r\n for enter
+            d_afterCarriageReturn = true;
+            input = {InputType::ENTER, ' '};
+        }
+        else if (c == '\n')
+        {
+            if (afterCarriageReturn)
+            {
+                return false;
+            }
+            input = {InputType::ENTER, ' '};
+        }
+        else if (c == 127 || c == '\b')
+        {
+            input = {InputType::BACKSPACE, ' '};
+        }
+        else
+        {
+            input = {InputType::ASCII, c};
+        }
+        return true;
+    }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef KEYBOARDINPUT_H
 #define KEYBOARDINPUT_H
 
+#include <csignal>
 #include <termios.h>
 #include <unistd.h>
 #include <iostream>
@@ -28,6 +29,7 @@ namespace ose4g
             ARROW_UP,
             ARROW_DOWN,
             ENTER,
+            INTERRUPT,
             INVALID_INPUT
         };
 
@@ -54,6 +56,49 @@ namespace ose4g
         KeyboardInput(KeyboardInput &&) = delete;
         KeyboardInput &operator=(KeyboardInput &&) = delete;
     };
+
+    /// @brief While alive, Ctrl-C (SIGINT) sets a flag instead of terminating the program.
+    /// The console turns presses into a stop request of the command it is running, see count().
+    class InterruptScope
+    {
+    private:
+        struct sigaction d_previous;
+
+    public:
+        InterruptScope();
+        ~InterruptScope();
+
+        InterruptScope(const InterruptScope &) = delete;
+        InterruptScope &operator=(const InterruptScope &) = delete;
+
+        /// @brief true if Ctrl-C was pressed since the innermost scope was created
+        static bool requested();
+
+        /// @brief how many times Ctrl-C was pressed since the innermost scope was created
+        static int count();
+    };
+
+    /// @brief turns a stream of bytes from a terminal into keyboard inputs.
+    /// Keeps state between calls so escape sequences may be split across reads.
+    class KeyDecoder
+    {
+    private:
+        enum class State
+        {
+            NORMAL,
+            ESCAPE,
+            BRACKET
+        };
+        State d_state = State::NORMAL;
+        bool d_afterCarriageReturn = false;
+
+    public:
+        /// @brief feed one byte to the decoder
+        /// @param c the byte
+        /// @param input set to the decoded input if the byte completes one
+        /// @return true if input was set
+        bool feed(char c, KeyboardInput::Input &input);
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "keyboardinput.h"
+
+using InputType = ose4g::KeyboardInput::InputType;
+
+static std::vector<InputType> decode(ose4g::KeyDecoder &decoder, const std::string &bytes)
+{
+    std::vector<InputType> inputs;
+    ose4g::KeyboardInput::Input input;
+    for (char c : bytes)
+    {
+        if (decoder.feed(c, input))
+            inputs.push_back(input.first);
+    }
+    return inputs;
+}
+
+TEST(KeyDecoderTest, shouldDecodeArrowKeys)
+{
+    ose4g::KeyDecoder decoder;
+    EXPECT_EQ(decode(decoder, "\033[A\033[B\033[C\033[D"),
+              (std::vector{InputType::ARROW_UP, InputType::ARROW_DOWN, InputType::ARROW_RIGHT, InputType::ARROW_LEFT}));
+}
+
+TEST(KeyDecoderTest, shouldDecodeEscapeSequenceSplitAcrossReads)
+{
+    ose4g::KeyDecoder decoder;
+    EXPECT_TRUE(decode(decoder, "\033[").empty());
+    EXPECT_EQ(decode(decoder, "A"), std::vector{InputType::ARROW_UP});
+}
+
+TEST(KeyDecoderTest, carriageReturnNewlineShouldBeOneEnter)
+{
+    ose4g::KeyDecoder decoder;
+    EXPECT_EQ(decode(decoder, "a\r\nb\n"),
+              (std::vector{InputType::ASCII, InputType::ENTER, InputType::ASCII, InputType::ENTER}));
+}
+
+TEST(KeyDecoderTest, ctrlCShouldBeInterrupt)
+{
+    ose4g::KeyDecoder decoder;
+    EXPECT_EQ(decode(decoder, "a\003"), (std::vector{InputType::ASCII, InputType::INTERRUPT}));
+}
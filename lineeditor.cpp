@@ -0,0 +1,140 @@
+#include "lineeditor.h"
+
+namespace ose4g
+{
+    LineEditor::LineEditor(History &history, Completer completer) : d_history(history), d_completer(std::move(completer))
+    {
+        reset();
+    }
+
+    void LineEditor::reset()
+    {
+        d_input.clear();
+        d_pos = 0;
+        d_temp.clear();
+        d_temp.addFront(d_input);
+    }
+
+    LineEditor::Action LineEditor::feed(const KeyboardInput::Input &input)
+    {
+        using InputType = KeyboardInput::InputType;
+
+        // add ascii character to current string
+        if (input.first == InputType::ASCII)
+        {
+            d_input.insert(d_input.begin() + d_pos, input.second);
+            d_temp.edit(d_input);
+            d_pos++;
+        }
+        // remove from current string
+        else if (input.first == InputType::BACKSPACE && d_pos > 0)
+        {
+            d_input.erase(d_pos - 1, 1);
+            d_temp.edit(d_input);
+            d_pos--;
+        }
+        // return complete user input
+        else if (input.first == InputType::ENTER)
+        {
+            d_pos = 0;
+            return d_input.empty() ? Action::NEWLINE : Action::SUBMIT;
+        }
+        // discard the line like a shell does
+        else if (input.first == InputType::INTERRUPT)
+        {
+            reset();
+            return Action::CANCEL;
+        }
+        // move cursor left
+        else if (input.first == InputType::ARROW_LEFT && d_pos > 0)
+        {
+            d_pos--;
+        }
+        // move cursor right
+        else if (input.first == InputType::ARROW_RIGHT && d_pos < d_input.length())
+        {
+            d_pos++;
+        }
+        // go to previous history
+        else if (input.first == InputType::ARROW_UP)
+        {
+            /**
+             * check history for temporary history first
+             * if not then check the permanent history
+             */
+            auto v = d_temp.getPrevious();
+
+            if (v.first)
+            {
+                d_input = v.second;
+                d_pos = d_input.length();
+            }
+            else
+            {
+                auto d = d_history.getPrevious();
+                if (d.first)
+                {
+                    d_input = d.second;
+                    d_pos = d_input.length();
+                    d_temp.addFront(d_input);
+                }
+            }
+        }
+        // Go to newer history.
+        else if (input.first == InputType::ARROW_DOWN)
+        {
+            auto v = d_temp.getNext();
+
+            if (v.first)
+            {
+                d_input = v.second;
+                d_pos = d_input.length();
+            }
+        }
+        // add autocomplete
+        else if (input.first == InputType::TAB && d_completer)
+        {
+            // suggestions replace the word after the last space
+            d_suggestions = d_completer(d_input);
+            if (d_suggestions.size() == 1)
+            {
+                auto space = d_input.rfind(' ');
+                d_input.resize(space == std::string::npos ? 0 : space + 1);
+                d_input += d_suggestions[0];
+                d_pos = d_input.length();
+            }
+            else if (d_suggestions.size() > 1)
+            {
+                return Action::SUGGEST;
+            }
+        }
+        return Action::NONE;
+    }
+
+    void LineEditor::render(std::string &out, std::string_view prompt) const
+    {
+        out += "\r\033[K";
+        out += prompt;
+        out += d_input;
+
+        // move the cursor back in one sequence instead of one per character
+        std::size_t stepsBack = d_input.length() - d_pos;
+        if (stepsBack > 0)
+        {
+            out += "\033[";
+            out += std::to_string(stepsBack);
+            out += 'D';
+        }
+    }
+
+    void LineEditor::renderSuggestions(std::string &out) const
+    {
+        out += '\n';
+        for (auto &suggestion : d_suggestions)
+        {
+            out += suggestion;
+            out += ' ';
+        }
+        out += '\n';
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef LINEEDITOR_H
+#define LINEEDITOR_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "history.h"
+#include "keyboardinput.h"
+
+namespace ose4g
+{
+    /**
+     * @brief Editing state of a single input line.
+     *
+     * Holds the line being typed, the cursor and a scratch history so that
+     * the terminal REPL and remote sessions share the same editing behaviour.
+     * The editor never writes to a stream, callers render it into a buffer.
+     */
+    class LineEditor
+    {
+    public:
+        /// returns the completions of the last word of the line
+        using Completer = std::function<std::vector<std::string>(const std::string &)>;
+
+        enum class Action
+        {
+            NONE,     // line changed or nothing happened, redraw
+            NEWLINE,  // enter on an empty line
+            SUBMIT,   // enter on a non empty line, line() is the input
+            SUGGEST,  // several completions, suggestions() holds them
+            CANCEL    // Ctrl-C, the line was discarded
+        };
+
+    private:
+        History &d_history;
+        Completer d_completer;
+        std::string d_input;
+        std::size_t d_pos = 0;
+        History d_temp;
+        std::vector<std::string> d_suggestions;
+
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param history permanent history navigated with the arrow keys
+         * @param completer returns the completions for the current line
+         */
+        LineEditor(History &history, Completer completer);
+
+        /// @brief start editing a new empty line
+        void reset();
+
+        /// @brief apply a key press to the line
+        Action feed(const KeyboardInput::Input &input);
+
+        /// @brief the current line
+        const std::string &line() const { return d_input; }
+
+        /// @brief completions found by the last TAB press
+        const std::vector<std::string> &suggestions() const { return d_suggestions; }
+
+        /// @brief append the escape sequences that redraw the prompt and line to out
+        void render(std::string &out, std::string_view prompt) const;
+
+        /// @brief append the last suggestions on their own line to out
+        void renderSuggestions(std::string &out) const;
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "lineeditor.h"
+
+using namespace ::testing;
+using InputType = ose4g::KeyboardInput::InputType;
+
+class LineEditorTest : public testing::Test
+{
+public:
+    ose4g::History history;
+    ose4g::LineEditor editor{history, [](const std::string &input)
+                             {
+                                 std::vector<std::string> all = {"send", "seen", "list"};
+                                 std::vector<std::string> matches;
+                                 for (auto &word : all)
+                                     if (word.starts_with(input))
+                                         matches.push_back(word);
+                                 return matches;
+                             }};
+
+    void type(const std::string &text)
+    {
+        for (char c : text)
+            editor.feed({InputType::ASCII, c});
+    }
+};
+
+TEST_F(LineEditorTest, shouldInsertAtCursor)
+{
+    type("sed");
+    editor.feed({InputType::ARROW_LEFT, ' '});
+    type("n");
+    EXPECT_EQ(editor.line(), "send");
+    EXPECT_EQ(editor.feed({InputType::ENTER, ' '}), ose4g::LineEditor::Action::SUBMIT);
+}
+
+TEST_F(LineEditorTest, backspaceAtStartShouldDoNothing)
+{
+    type("ab");
+    editor.feed({InputType::ARROW_LEFT, ' '});
+    editor.feed({InputType::ARROW_LEFT, ' '});
+    editor.feed({InputType::BACKSPACE, ' '});
+    EXPECT_EQ(editor.line(), "ab");
+}
+
+TEST_F(LineEditorTest, enterOnEmptyLineShouldNotSubmit)
+{
+    EXPECT_EQ(editor.feed({InputType::ENTER, ' '}), ose4g::LineEditor::Action::NEWLINE);
+}
+
+TEST_F(LineEditorTest, arrowUpShouldLoadHistory)
+{
+    history.addBack("list");
+    editor.feed({InputType::ARROW_UP, ' '});
+    EXPECT_EQ(editor.line(), "list");
+}
+
+TEST_F(LineEditorTest, tabShouldCompleteOrSuggest)
+{
+    type("l");
+    editor.feed({InputType::TAB, ' '});
+    EXPECT_EQ(editor.line(), "list");
+
+    editor.reset();
+    type("se");
+    EXPECT_EQ(editor.feed({InputType::TAB, ' '}), ose4g::LineEditor::Action::SUGGEST);
+    EXPECT_THAT(editor.suggestions(), UnorderedElementsAre("send", "seen"));
+}
+
+TEST_F(LineEditorTest, renderShouldMoveCursorBackInOneSequence)
+{
+    type("send");
+    editor.feed({InputType::ARROW_LEFT, ' '});
+    editor.feed({InputType::ARROW_LEFT, ' '});
+    std::string screen;
+    editor.render(screen, "> ");
+    EXPECT_EQ(screen, "\r\033[K> send\033[2D");
+}
+
+TEST_F(LineEditorTest, interruptShouldDiscardTheLine)
+{
+    type("send");
+    EXPECT_EQ(editor.feed({InputType::INTERRUPT, '\003'}), ose4g::LineEditor::Action::CANCEL);
+    EXPECT_EQ(editor.line(), "");
+}
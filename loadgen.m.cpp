@@ -0,0 +1,233 @@
+// Load generator for the command processor server.
+//
+// Opens many idle sessions plus a few busy ones that send a command and wait
+// for the prompt to come back, then reports throughput and latency.
+//
+//   ./loadgen --self --idle 5000 --clients 8 --requests 20000
+//   ./loadgen --unix /tmp/app.sock --command "status -l"
+#include "server.h"
+#include "style.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    struct Options
+    {
+        std::string unixPath;
+        int tcpPort = -1;
+        bool self = false;
+        int idle = 1000;
+        int clients = 4;
+        int requests = 10000;
+        std::string command = "echo hello";
+    };
+
+    int connectTo(const Options &options)
+    {
+        int fd;
+        if (!options.unixPath.empty())
+        {
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, options.unixPath.c_str(), sizeof(address.sun_path) - 1);
+            if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+            {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options.tcpPort);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // every response ends with the prompt being redrawn, which starts with this sequence
+    bool readUntilPrompt(int fd, std::string &buffer)
+    {
+        static const std::string redraw = "\r\033[K";
+        char chunk[4096];
+        while (true)
+        {
+            auto found = buffer.find(redraw);
+            if (found != std::string::npos)
+            {
+                buffer.erase(0, found + redraw.size());
+                return true;
+            }
+            ssize_t count = read(fd, chunk, sizeof(chunk));
+            if (count <= 0)
+            {
+                return false;
+            }
+            buffer.append(chunk, count);
+        }
+    }
+
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0;
+        }
+        return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(p * sorted.size()))];
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: loadgen (--unix PATH | --tcp PORT | --self) [--idle N] [--clients N] [--requests N] [--command TEXT]\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--unix" && hasValue)
+            options.unixPath = argv[++i];
+        else if (arg == "--tcp" && hasValue)
+            options.tcpPort = std::stoi(argv[++i]);
+        else if (arg == "--self")
+            options.self = true;
+        else if (arg == "--idle" && hasValue)
+            options.idle = std::stoi(argv[++i]);
+        else if (arg == "--clients" && hasValue)
+            options.clients = std::stoi(argv[++i]);
+        else if (arg == "--requests" && hasValue)
+            options.requests = std::stoi(argv[++i]);
+        else if (arg == "--command" && hasValue)
+            options.command = argv[++i];
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (!options.self && options.unixPath.empty() && options.tcpPort < 0)
+    {
+        usage();
+        return 1;
+    }
+
+    // idle sessions need a descriptor each, twice over when serving ourselves
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    ose4g::setColorMode(ose4g::ColorMode::NEVER);
+    ose4g::CommandProcessorImpl processor("loadgen");
+    std::unique_ptr<ose4g::Server> server;
+    std::thread serverThread;
+    if (options.self)
+    {
+        processor.add("echo", [](const ose4g::Args &args)
+                      {
+            for (auto &arg : args)
+            {
+                std::cout << arg << ' ';
+            } }, "prints its arguments");
+        options.unixPath = "/tmp/loadgen-" + std::to_string(getpid()) + ".sock";
+        server = std::make_unique<ose4g::Server>(processor, ose4g::ServerOptions{options.unixPath});
+        serverThread = std::thread([&server]
+                                   { server->run(); });
+    }
+
+    std::vector<int> idle;
+    for (int i = 0; i < options.idle; i++)
+    {
+        int fd = connectTo(options);
+        if (fd < 0)
+        {
+            std::cerr << "opened " << idle.size() << " idle sessions before connect failed: " << std::strerror(errno) << "\n";
+            break;
+        }
+        idle.push_back(fd);
+    }
+
+    std::string line = options.command + "\n";
+    std::vector<std::vector<double>> latencies(options.clients);
+    std::vector<std::thread> clients;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < options.clients; c++)
+    {
+        clients.emplace_back([&, c]
+                             {
+            int fd = connectTo(options);
+            if (fd < 0)
+            {
+                return;
+            }
+            std::string buffer;
+            readUntilPrompt(fd, buffer);
+            auto &samples = latencies[c];
+            samples.reserve(options.requests);
+            for (int r = 0; r < options.requests; r++)
+            {
+                auto sent = std::chrono::steady_clock::now();
+                if (write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size()) || !readUntilPrompt(fd, buffer))
+                {
+                    break;
+                }
+                samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+            }
+            close(fd); });
+    }
+    for (auto &client : clients)
+    {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    for (auto &samples : latencies)
+    {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << "idle sessions:   " << idle.size() << "\n"
+              << "busy sessions:   " << options.clients << "\n"
+              << "requests:        " << all.size() << "\n"
+              << "throughput:      " << static_cast<long>(all.size() / seconds) << " req/s\n"
+              << "latency p50:     " << percentile(all, 0.50) << " us\n"
+              << "latency p90:     " << percentile(all, 0.90) << " us\n"
+              << "latency p99:     " << percentile(all, 0.99) << " us\n"
+              << "latency max:     " << (all.empty() ? 0 : all.back()) << " us\n";
+
+    for (int fd : idle)
+    {
+        close(fd);
+    }
+    if (server)
+    {
+        server->stop();
+        serverThread.join();
+    }
+    return 0;
+}
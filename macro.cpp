@@ -0,0 +1,119 @@
+#include "macro.h"
+#include <stdexcept>
+
+namespace ose4g
+{
+    int Macro::slotOf(const std::string &arg)
+    {
+        if (arg.size() < 2 || arg[0] != '$')
+        {
+            return LITERAL;
+        }
+        if (arg == "$@")
+        {
+            return ALL;
+        }
+        int index = 0;
+        for (std::size_t i = 1; i < arg.size(); i++)
+        {
+            if (arg[i] < '0' || arg[i] > '9' || index > 1000)
+            {
+                return LITERAL;
+            }
+            index = index * 10 + (arg[i] - '0');
+        }
+        // $1 is the first argument
+        return index > 0 ? index - 1 : LITERAL;
+    }
+
+    Macro::Macro(std::vector<Step> steps)
+    {
+        if (steps.empty())
+        {
+            throw std::invalid_argument("a macro needs at least one command");
+        }
+        d_steps.reserve(steps.size());
+        for (auto &step : steps)
+        {
+            if (step.first.empty())
+            {
+                throw std::invalid_argument("empty command in macro");
+            }
+            CompiledStep compiled{std::move(step.first), {}};
+            compiled.parts.reserve(step.second.size());
+            for (auto &arg : step.second)
+            {
+                int slot = slotOf(arg);
+                d_hasSlots = d_hasSlots || slot != LITERAL;
+                compiled.parts.push_back({std::move(arg), slot});
+            }
+            d_steps.push_back(std::move(compiled));
+        }
+    }
+
+    std::vector<Macro::Step> Macro::expand(const Args &args) const
+    {
+        std::vector<Step> steps;
+        steps.reserve(d_steps.size());
+        for (auto &compiled : d_steps)
+        {
+            Args stepArgs;
+            stepArgs.reserve(compiled.parts.size());
+            for (auto &part : compiled.parts)
+            {
+                if (part.slot == LITERAL)
+                {
+                    stepArgs.push_back(part.text);
+                }
+                else if (part.slot == ALL)
+                {
+                    stepArgs.insert(stepArgs.end(), args.begin(), args.end());
+                }
+                else if (static_cast<std::size_t>(part.slot) < args.size())
+                {
+                    stepArgs.push_back(args[part.slot]);
+                }
+                else
+                {
+                    throw std::invalid_argument("missing argument " + part.text);
+                }
+            }
+            steps.emplace_back(compiled.command, std::move(stepArgs));
+        }
+        if (!d_hasSlots)
+        {
+            auto &last = steps.back().second;
+            last.insert(last.end(), args.begin(), args.end());
+        }
+        return steps;
+    }
+
+    std::vector<Command> Macro::commands() const
+    {
+        std::vector<Command> commands;
+        for (auto &step : d_steps)
+        {
+            commands.push_back(step.command);
+        }
+        return commands;
+    }
+
+    std::string Macro::text() const
+    {
+        std::string text;
+        for (auto &step : d_steps)
+        {
+            if (!text.empty())
+            {
+                text += "; ";
+            }
+            text += step.command;
+            for (auto &part : step.parts)
+            {
+                bool quote = part.text.empty() || part.text.find(' ') != std::string::npos;
+                text += quote ? " '" + part.text + "'" : " " + part.text;
+            }
+        }
+        return text;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef MACRO_H
+#define MACRO_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "rule.h"
+
+namespace ose4g
+{
+    /**
+     * @brief A sequence of commands stored already tokenized.
+     *
+     * Arguments of the form $1, $2, ... are replaced by the arguments the
+     * macro is called with and $@ by all of them. A macro without any such
+     * slot passes its arguments on to its last command, so a plain alias
+     * like `ll = list -l` can be called as `ll /tmp`.
+     */
+    class Macro
+    {
+    public:
+        using Step = std::pair<Command, Args>;
+
+        /**
+         * @brief stores steps that have already been through parseStatement.
+         *
+         * @throws std::invalid_argument if there are no steps.
+         */
+        explicit Macro(std::vector<Step> steps);
+
+        /**
+         * @brief the commands to run for a call with args.
+         *
+         * @throws std::invalid_argument if a slot refers to a missing argument.
+         */
+        std::vector<Step> expand(const Args &args) const;
+
+        /// @brief commands the macro runs, for detecting recursive definitions
+        std::vector<Command> commands() const;
+
+        /// @brief the definition as it would be typed, e.g. "build; push -l"
+        std::string text() const;
+
+    private:
+        // index into the call's arguments, ALL for $@ and LITERAL for plain text
+        static constexpr int ALL = -1;
+        static constexpr int LITERAL = -2;
+
+        struct Part
+        {
+            std::string text;
+            int slot;
+        };
+
+        struct CompiledStep
+        {
+            Command command;
+            std::vector<Part> parts;
+        };
+
+        std::vector<CompiledStep> d_steps;
+        bool d_hasSlots = false;
+
+        static int slotOf(const std::string &arg);
+    };
+}
+
+#endif
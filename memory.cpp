@@ -0,0 +1,61 @@
+#include "memory.h"
+
+namespace ose4g
+{
+    namespace
+    {
+        constexpr std::array<const char *, MEMORY_CATEGORIES> CATEGORY_NAMES{"completion", "suggestions", "registry", "handlers", "history"};
+    }
+
+    const char *memoryCategoryName(MemoryCategory category)
+    {
+        return CATEGORY_NAMES[static_cast<std::size_t>(category)];
+    }
+
+    void MemoryAccount::allocated(std::size_t bytes)
+    {
+        for (auto *account = this; account; account = account->d_parent)
+        {
+            account->d_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            account->d_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void MemoryAccount::deallocated(std::size_t bytes)
+    {
+        for (auto *account = this; account; account = account->d_parent)
+        {
+            account->d_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            account->d_allocations.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    MemoryAccount &memoryAccount(MemoryCategory category)
+    {
+        // never destroyed, static objects may free into them during exit
+        static auto *accounts = new std::array<MemoryAccount, MEMORY_CATEGORIES>();
+        return (*accounts)[static_cast<std::size_t>(category)];
+    }
+
+    MemoryUsage::Counter MemoryUsage::total() const
+    {
+        Counter total;
+        for (auto &category : categories)
+        {
+            total.bytes += category.bytes;
+            total.allocations += category.allocations;
+        }
+        return total;
+    }
+
+    MemoryUsage memoryUsage()
+    {
+        MemoryUsage usage;
+        for (std::size_t i = 0; i < MEMORY_CATEGORIES; i++)
+        {
+            auto &account = memoryAccount(static_cast<MemoryCategory>(i));
+            usage.categories[i] = {account.bytes(), account.allocations()};
+        }
+        return usage;
+    }
+}
@@ -0,0 +1,160 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ose4g
+{
+    /// @brief internal structures whose memory is accounted for
+    enum class MemoryCategory
+    {
+        /// AutoComplete trie nodes
+        COMPLETION,
+        /// BkTree nodes for command suggestions
+        SUGGESTIONS,
+        /// registry maps and command entries
+        REGISTRY,
+        /// state captured by command handlers
+        HANDLERS,
+        /// lines kept in History
+        HISTORY
+    };
+
+    inline constexpr std::size_t MEMORY_CATEGORIES = 5;
+
+    /// @brief lower case name of category, e.g. for the mem built in command
+    const char *memoryCategoryName(MemoryCategory category);
+
+    /**
+     * @brief Bytes and allocations currently held through CountingAllocators.
+     *
+     * Counts are kept with relaxed atomics and may be updated from any
+     * thread. An account with a parent also adds everything to the parent,
+     * e.g. one History's account to the process wide HISTORY one.
+     */
+    class MemoryAccount
+    {
+    private:
+        std::atomic<std::size_t> d_bytes{0};
+        std::atomic<std::size_t> d_allocations{0};
+        MemoryAccount *d_parent;
+
+    public:
+        explicit MemoryAccount(MemoryAccount *parent = nullptr) : d_parent(parent) {}
+
+        MemoryAccount(const MemoryAccount &) = delete;
+        MemoryAccount &operator=(const MemoryAccount &) = delete;
+
+        void allocated(std::size_t bytes);
+        void deallocated(std::size_t bytes);
+
+        std::size_t bytes() const { return d_bytes.load(std::memory_order_relaxed); }
+        std::size_t allocations() const { return d_allocations.load(std::memory_order_relaxed); }
+    };
+
+    /// @brief the process wide account of category
+    MemoryAccount &memoryAccount(MemoryCategory category);
+
+    /**
+     * @brief Standard allocator that reports every allocation to a MemoryAccount.
+     *
+     * The account must outlive everything allocated from it. Allocators
+     * compare equal when they report to the same account.
+     */
+    template <typename T>
+    class CountingAllocator
+    {
+    private:
+        MemoryAccount *d_account;
+
+        template <typename U>
+        friend class CountingAllocator;
+
+    public:
+        using value_type = T;
+
+        explicit CountingAllocator(MemoryAccount &account) noexcept : d_account(&account) {}
+        explicit CountingAllocator(MemoryCategory category) noexcept : d_account(&memoryAccount(category)) {}
+
+        template <typename U>
+        CountingAllocator(const CountingAllocator<U> &other) noexcept : d_account(other.d_account) {}
+
+        T *allocate(std::size_t count)
+        {
+            T *memory = std::allocator<T>().allocate(count);
+            d_account->allocated(count * sizeof(T));
+            return memory;
+        }
+
+        void deallocate(T *memory, std::size_t count) noexcept
+        {
+            d_account->deallocated(count * sizeof(T));
+            std::allocator<T>().deallocate(memory, count);
+        }
+
+        MemoryAccount &account() const { return *d_account; }
+
+        template <typename U>
+        bool operator==(const CountingAllocator<U> &other) const noexcept { return d_account == other.d_account; }
+    };
+
+    template <typename Key, typename Value, typename Compare = std::less<Key>>
+    using CountedMap = std::map<Key, Value, Compare, CountingAllocator<std::pair<const Key, Value>>>;
+
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    using CountedUnorderedMap = std::unordered_map<Key, Value, Hash, std::equal_to<Key>, CountingAllocator<std::pair<const Key, Value>>>;
+
+    using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+    /// @brief make_shared allocating the object and its control block from category
+    template <typename T, typename... Args>
+    std::shared_ptr<T> makeCounted(MemoryCategory category, Args &&...args)
+    {
+        return std::allocate_shared<T>(CountingAllocator<T>(category), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief moves callable to a block counted in category and returns a callable forwarding to it.
+     *
+     * std::function cannot take an allocator, so the captures of a handler
+     * are moved here first and the std::function holding the result only
+     * keeps a pointer to them.
+     */
+    template <typename Callable>
+    auto countedCallable(MemoryCategory category, Callable callable)
+    {
+        auto stored = makeCounted<Callable>(category, std::move(callable));
+        return [stored = std::move(stored)](auto &&...args) -> decltype(auto)
+        { return (*stored)(std::forward<decltype(args)>(args)...); };
+    }
+
+    /// @brief what every category holds, see memoryUsage
+    struct MemoryUsage
+    {
+        struct Counter
+        {
+            std::size_t bytes = 0;
+            std::size_t allocations = 0;
+        };
+
+        std::array<Counter, MEMORY_CATEGORIES> categories;
+
+        const Counter &operator[](MemoryCategory category) const { return categories[static_cast<std::size_t>(category)]; }
+
+        /// @brief sum of all categories
+        Counter total() const;
+    };
+
+    /// @brief reads the process wide accounts, each one is read atomically but not all together
+    MemoryUsage memoryUsage();
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "autocomplete.h"
+#include "memory.h"
+
+TEST(MemoryAccountTest, shouldCountWhatIsStillAllocated)
+{
+    ose4g::MemoryAccount account;
+    {
+        std::vector<int, ose4g::CountingAllocator<int>> numbers{ose4g::CountingAllocator<int>(account)};
+        numbers.reserve(100);
+        EXPECT_EQ(account.bytes(), 100 * sizeof(int));
+        EXPECT_EQ(account.allocations(), 1u);
+    }
+    EXPECT_EQ(account.bytes(), 0u);
+    EXPECT_EQ(account.allocations(), 0u);
+}
+
+TEST(MemoryAccountTest, shouldAddToParent)
+{
+    ose4g::MemoryAccount parent;
+    ose4g::MemoryAccount child(&parent);
+    ose4g::CountedString text(std::string(100, 'x'), ose4g::CountingAllocator<char>(child));
+    EXPECT_GT(child.bytes(), 100u);
+    EXPECT_EQ(parent.bytes(), child.bytes());
+    EXPECT_EQ(parent.allocations(), 1u);
+}
+
+TEST(MemoryAccountTest, containersShouldKeepTheirAccountWhenCopied)
+{
+    ose4g::MemoryAccount account;
+    ose4g::CountedMap<int, int> numbers{ose4g::CountingAllocator<char>(account)};
+    numbers[1] = 1;
+    auto copy = numbers;
+    copy[2] = 2;
+    EXPECT_EQ(&copy.get_allocator().account(), &account);
+    EXPECT_EQ(account.allocations(), 3u);
+}
+
+TEST(MemoryUsageTest, countedCallableShouldCountCaptures)
+{
+    auto before = ose4g::memoryUsage()[ose4g::MemoryCategory::HANDLERS];
+    {
+        std::string captured(1000, 'x');
+        auto callable = ose4g::countedCallable(ose4g::MemoryCategory::HANDLERS, [captured](int add)
+                                               { return captured.size() + add; });
+        EXPECT_EQ(callable(1), 1001u);
+        auto during = ose4g::memoryUsage()[ose4g::MemoryCategory::HANDLERS];
+        EXPECT_GE(during.bytes - before.bytes, sizeof(std::string));
+        EXPECT_EQ(during.allocations, before.allocations + 1);
+    }
+    EXPECT_EQ(ose4g::memoryUsage()[ose4g::MemoryCategory::HANDLERS].bytes, before.bytes);
+}
+
+TEST(MemoryUsageTest, autocompleteShouldCountItsNodes)
+{
+    auto before = ose4g::memoryUsage()[ose4g::MemoryCategory::COMPLETION].bytes;
+    {
+        ose4g::AutoComplete autocomplete;
+        autocomplete.addAll({"deploy", "describe", "delete"});
+        EXPECT_GT(ose4g::memoryUsage()[ose4g::MemoryCategory::COMPLETION].bytes, before);
+    }
+    EXPECT_EQ(ose4g::memoryUsage()[ose4g::MemoryCategory::COMPLETION].bytes, before);
+    EXPECT_EQ(ose4g::memoryCategoryName(ose4g::MemoryCategory::COMPLETION), std::string("completion"));
+}
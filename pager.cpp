@@ -0,0 +1,557 @@
+#include "pager.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace ose4g
+{
+    namespace
+    {
+        // read back from the temporary file at least this much at a time
+        constexpr std::size_t WINDOW_SIZE = 64 * 1024;
+        constexpr std::size_t TAB_WIDTH = 8;
+    }
+
+    OutputSpool::OutputSpool(const PagerOptions &options) : d_options(options)
+    {
+    }
+
+    OutputSpool::~OutputSpool()
+    {
+        if (d_file >= 0)
+        {
+            ::close(d_file);
+        }
+    }
+
+    std::size_t OutputSpool::lineCountLocked() const
+    {
+        // the last start is past the end when the output ends with a newline
+        return d_lineStarts.back() < d_size ? d_lineStarts.size() : d_lineStarts.size() - 1;
+    }
+
+    void OutputSpool::spill()
+    {
+        // unlinked already, the file goes away with the descriptor
+        std::FILE *file = std::tmpfile();
+        if (!file)
+        {
+            d_spillFailed = true;
+            return;
+        }
+        d_file = dup(fileno(file));
+        std::fclose(file);
+        if (d_file < 0)
+        {
+            d_spillFailed = true;
+            return;
+        }
+        writeFile(d_memory);
+        std::string().swap(d_memory);
+    }
+
+    void OutputSpool::writeFile(std::string_view text)
+    {
+        while (!text.empty() && !d_discarded)
+        {
+            ssize_t written = write(d_file, text.data(), text.size());
+            if (written < 0 && errno != EINTR)
+            {
+                // the disk is full, what made it to the file can still be read
+                d_discarded = true;
+            }
+            text.remove_prefix(std::max<ssize_t>(written, 0));
+        }
+    }
+
+    std::string_view OutputSpool::read(std::uint64_t offset, std::size_t size)
+    {
+        if (d_file < 0)
+        {
+            return std::string_view(d_memory).substr(offset, size);
+        }
+        if (offset < d_windowOffset || offset + size > d_windowOffset + d_window.size())
+        {
+            d_windowOffset = offset;
+            d_window.resize(std::max(size, WINDOW_SIZE));
+            std::size_t filled = 0;
+            while (filled < d_window.size())
+            {
+                ssize_t count = pread(d_file, d_window.data() + filled, d_window.size() - filled, offset + filled);
+                if (count < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (count <= 0)
+                {
+                    break;
+                }
+                filled += count;
+            }
+            d_window.resize(filled);
+        }
+        return std::string_view(d_window).substr(offset - d_windowOffset, size);
+    }
+
+    void OutputSpool::append(std::string_view text)
+    {
+        std::unique_lock lock(d_mutex);
+        d_changed.wait(lock, [&]
+                       {
+            std::size_t lines = lineCountLocked();
+            return d_discarded || lines <= d_requested || lines - d_requested <= d_options.lookahead; });
+        if (d_discarded)
+        {
+            return;
+        }
+        if (d_file < 0 && !d_spillFailed && d_memory.size() + text.size() > d_options.memoryLimit)
+        {
+            spill();
+        }
+        if (d_file >= 0)
+        {
+            writeFile(text);
+            if (d_discarded)
+            {
+                return;
+            }
+        }
+        else
+        {
+            d_memory.append(text);
+        }
+        for (const char *c = text.data(), *end = text.data() + text.size();
+             (c = static_cast<const char *>(std::memchr(c, '\n', end - c))); c++)
+        {
+            d_lineStarts.push_back(d_size + (c - text.data()) + 1);
+        }
+        d_size += text.size();
+        d_changed.notify_all();
+    }
+
+    void OutputSpool::close()
+    {
+        std::lock_guard lock(d_mutex);
+        d_closed = true;
+        d_changed.notify_all();
+    }
+
+    void OutputSpool::discard()
+    {
+        std::lock_guard lock(d_mutex);
+        d_discarded = true;
+        d_changed.notify_all();
+    }
+
+    void OutputSpool::request(std::size_t line)
+    {
+        std::lock_guard lock(d_mutex);
+        if (line > d_requested)
+        {
+            d_requested = line;
+            d_changed.notify_all();
+        }
+    }
+
+    bool OutputSpool::waitForOutput(std::uint64_t seen, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock lock(d_mutex);
+        return d_changed.wait_for(lock, timeout, [&]
+                                  { return d_size > seen || d_closed || d_discarded; });
+    }
+
+    std::size_t OutputSpool::lineCount() const
+    {
+        std::lock_guard lock(d_mutex);
+        return lineCountLocked();
+    }
+
+    std::uint64_t OutputSpool::size() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_size;
+    }
+
+    bool OutputSpool::closed() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_closed;
+    }
+
+    bool OutputSpool::spilled() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_file >= 0;
+    }
+
+    std::string OutputSpool::line(std::size_t index)
+    {
+        std::lock_guard lock(d_mutex);
+        if (index >= lineCountLocked())
+        {
+            return "";
+        }
+        std::uint64_t start = d_lineStarts[index];
+        std::uint64_t end = index + 1 < d_lineStarts.size() ? d_lineStarts[index + 1] - 1 : d_size;
+        std::string_view text = read(start, end - start);
+        if (!text.empty() && text.back() == '\r')
+        {
+            text.remove_suffix(1);
+        }
+        return std::string(text);
+    }
+
+    std::string OutputSpool::bytes(std::uint64_t from, std::uint64_t to)
+    {
+        std::lock_guard lock(d_mutex);
+        to = std::min(to, d_size);
+        if (from >= to)
+        {
+            return "";
+        }
+        return std::string(read(from, to - from));
+    }
+
+    Pager::Pager(OutputSpool &spool, std::size_t rows, std::size_t columns)
+        : d_spool(spool), d_rows(std::max<std::size_t>(rows, 2)), d_columns(std::max<std::size_t>(columns, 1))
+    {
+        d_spool.request(pageRows());
+    }
+
+    std::size_t Pager::lastTop() const
+    {
+        std::size_t lines = d_spool.lineCount();
+        return lines > pageRows() ? lines - pageRows() : 0;
+    }
+
+    void Pager::moveTo(std::size_t top)
+    {
+        // asked for first, a writer paused at the bottom may need it to get there
+        d_spool.request(top + pageRows());
+        d_top = std::min(top, lastTop());
+    }
+
+    bool Pager::feed(const KeyboardInput::Input &input)
+    {
+        using InputType = KeyboardInput::InputType;
+        if (d_typingPattern)
+        {
+            if (input.first == InputType::ASCII)
+            {
+                d_pattern += input.second;
+            }
+            else if (input.first == InputType::BACKSPACE && !d_pattern.empty())
+            {
+                d_pattern.pop_back();
+            }
+            else if (input.first == InputType::ENTER)
+            {
+                d_typingPattern = false;
+                if (!d_pattern.empty())
+                {
+                    startSearch(true);
+                }
+            }
+            else if (input.first == InputType::INTERRUPT)
+            {
+                d_typingPattern = false;
+                d_pattern.clear();
+            }
+            return true;
+        }
+
+        d_message.clear();
+        char key = input.first == InputType::ASCII ? input.second : '\0';
+        if (key == 'q' || input.first == InputType::INTERRUPT)
+        {
+            return false;
+        }
+        if (key == '/')
+        {
+            d_typingPattern = true;
+            d_pattern.clear();
+            return true;
+        }
+        if ((key == 'n' || key == 'N') && !d_pattern.empty())
+        {
+            startSearch(key == 'n');
+            return true;
+        }
+        // any other move cancels one still waiting for output
+        if (key == 'G')
+        {
+            d_goal = Goal::END;
+            update();
+            return true;
+        }
+        d_goal = Goal::NONE;
+        if (key == ' ' || key == 'f')
+        {
+            moveTo(d_top + pageRows());
+        }
+        else if (key == 'b')
+        {
+            moveTo(d_top > pageRows() ? d_top - pageRows() : 0);
+        }
+        else if (key == 'j' || input.first == InputType::ENTER || input.first == InputType::ARROW_DOWN)
+        {
+            moveTo(d_top + 1);
+        }
+        else if ((key == 'k' || input.first == InputType::ARROW_UP) && d_top > 0)
+        {
+            moveTo(d_top - 1);
+        }
+        else if (key == 'g')
+        {
+            moveTo(0);
+        }
+        return true;
+    }
+
+    void Pager::startSearch(bool forward)
+    {
+        d_goal = forward ? Goal::SEARCH_FORWARD : Goal::SEARCH_BACKWARD;
+        // the line on top is where the last search stopped
+        d_searchNext = forward ? d_top + 1 : d_top;
+        update();
+    }
+
+    void Pager::update()
+    {
+        // read before the line count, once closed no more lines can appear
+        bool closed = d_spool.closed();
+        std::size_t lines = d_spool.lineCount();
+        switch (d_goal)
+        {
+        case Goal::NONE:
+            break;
+        case Goal::END:
+            d_spool.request(std::numeric_limits<std::size_t>::max());
+            d_top = lastTop();
+            if (closed)
+            {
+                d_goal = Goal::NONE;
+            }
+            break;
+        case Goal::SEARCH_FORWARD:
+            // the last line may still be growing, it is searched once the next one starts
+            for (std::size_t end = closed ? lines : std::max<std::size_t>(lines, 1) - 1; d_searchNext < end; d_searchNext++)
+            {
+                if (d_spool.line(d_searchNext).find(d_pattern) != std::string::npos)
+                {
+                    d_goal = Goal::NONE;
+                    moveTo(d_searchNext);
+                    return;
+                }
+            }
+            if (closed)
+            {
+                d_goal = Goal::NONE;
+                d_message = "Pattern not found";
+            }
+            else
+            {
+                d_spool.request(lines + pageRows());
+            }
+            break;
+        case Goal::SEARCH_BACKWARD:
+            d_goal = Goal::NONE;
+            while (d_searchNext-- > 0)
+            {
+                if (d_spool.line(d_searchNext).find(d_pattern) != std::string::npos)
+                {
+                    moveTo(d_searchNext);
+                    return;
+                }
+            }
+            d_message = "Pattern not found";
+            break;
+        }
+    }
+
+    void Pager::formatLine(std::string &out, std::string_view line) const
+    {
+        std::size_t width = 0;
+        bool styled = false;
+        for (std::size_t i = 0; i < line.size(); i++)
+        {
+            char c = line[i];
+            if (c == '\033')
+            {
+                // keep colours, they take no space on screen
+                std::size_t end = i + 1;
+                if (end < line.size() && line[end] == '[')
+                {
+                    end++;
+                    while (end < line.size() && !(line[end] >= 0x40 && line[end] <= 0x7e))
+                    {
+                        end++;
+                    }
+                }
+                end = std::min(end + 1, line.size());
+                out.append(line.substr(i, end - i));
+                styled = true;
+                i = end - 1;
+                continue;
+            }
+            if (c == '\t')
+            {
+                std::size_t spaces = std::min(TAB_WIDTH - width % TAB_WIDTH, d_columns - width);
+                out.append(spaces, ' ');
+                width += spaces;
+            }
+            // utf-8 continuation bytes belong to the character before them
+            else if ((static_cast<unsigned char>(c) & 0xc0) == 0x80)
+            {
+                out += c;
+                continue;
+            }
+            else if (static_cast<unsigned char>(c) >= 0x20 && c != 0x7f)
+            {
+                out += c;
+                width++;
+            }
+            if (width >= d_columns)
+            {
+                // finish a character cut in the middle
+                while (i + 1 < line.size() && (static_cast<unsigned char>(line[i + 1]) & 0xc0) == 0x80)
+                {
+                    out += line[++i];
+                }
+                break;
+            }
+        }
+        if (styled)
+        {
+            out += "\033[0m";
+        }
+    }
+
+    void Pager::render(std::string &out) const
+    {
+        out += "\033[H";
+        std::size_t lines = d_spool.lineCount();
+        for (std::size_t row = 0; row < pageRows(); row++)
+        {
+            if (d_top + row < lines)
+            {
+                formatLine(out, d_spool.line(d_top + row));
+            }
+            else
+            {
+                out += '~';
+            }
+            out += "\033[K\r\n";
+        }
+        if (d_typingPattern)
+        {
+            out += '/';
+            out += d_pattern;
+            out += "\033[K";
+            return;
+        }
+        std::string status = d_message;
+        if (status.empty())
+        {
+            bool closed = d_spool.closed();
+            std::size_t bottom = std::min(d_top + pageRows(), lines);
+            status = "lines " + std::to_string(lines == 0 ? 0 : d_top + 1) + "-" + std::to_string(bottom) + " of " + std::to_string(lines);
+            status += closed ? (bottom == lines ? " (END)" : "") : " so far";
+            if (d_goal == Goal::SEARCH_FORWARD || d_goal == Goal::END)
+            {
+                status += ", waiting for output";
+            }
+        }
+        out += "\033[7m";
+        out += status;
+        out += "\033[0m\033[K";
+    }
+
+    bool terminalSize(std::size_t &rows, std::size_t &columns)
+    {
+        winsize size{};
+        if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO) || ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_row == 0)
+        {
+            return false;
+        }
+        rows = size.ws_row;
+        columns = size.ws_col > 0 ? size.ws_col : 80;
+        return true;
+    }
+
+    bool showOutput(OutputSpool &spool, std::size_t rows, std::size_t columns, const std::function<bool()> &stop)
+    {
+        // print output as it arrives while it still fits on the screen
+        spool.request(rows);
+        std::uint64_t printed = 0;
+        while (true)
+        {
+            bool closed = spool.closed();
+            std::uint64_t size = spool.size();
+            if (spool.lineCount() >= rows)
+            {
+                break;
+            }
+            if (size > printed)
+            {
+                std::cout << spool.bytes(printed, size) << std::flush;
+                printed = size;
+            }
+            if (closed || stop())
+            {
+                return true;
+            }
+            spool.waitForOutput(printed, std::chrono::milliseconds(50));
+        }
+
+        Pager pager(spool, rows, columns);
+        auto &keyboard = KeyboardInput::getInstance();
+        keyboard.enableKeyboard();
+        std::string screen = "\033[2J";
+        bool dirty = true;
+        std::uint64_t seen = spool.size();
+        bool seenClosed = spool.closed();
+        while (!stop())
+        {
+            if (dirty)
+            {
+                pager.render(screen);
+                std::cout << screen << std::flush;
+                screen.clear();
+                dirty = false;
+            }
+            pollfd keys{STDIN_FILENO, POLLIN, 0};
+            if (poll(&keys, 1, 50) > 0)
+            {
+                if (!pager.feed(keyboard.getInput()))
+                {
+                    break;
+                }
+                dirty = true;
+            }
+            // the writer may have been waiting for the page that was just shown
+            if (spool.size() != seen || spool.closed() != seenClosed)
+            {
+                seenClosed = spool.closed();
+                seen = spool.size();
+                pager.update();
+                dirty = true;
+            }
+        }
+        keyboard.disableKeyboard();
+        // the last page stays on screen above the prompt
+        std::cout << "\r\033[K" << std::flush;
+        if (!spool.closed())
+        {
+            spool.discard();
+            return false;
+        }
+        return true;
+    }
+}
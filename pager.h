@@ -0,0 +1,191 @@
+#ifndef PAGER_H
+#define PAGER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "keyboardinput.h"
+
+namespace ose4g
+{
+    /// @brief how console output longer than the terminal is shown
+    struct PagerOptions
+    {
+        /// page output taller than the terminal, only when stdin and stdout are terminals
+        bool enabled = true;
+        /// output kept in memory, the rest goes to a temporary file
+        std::size_t memoryLimit = 1 << 20;
+        /// lines a command may write past the bottom of the screen before it is paused
+        std::size_t lookahead = 1000;
+    };
+
+    /**
+     * @brief Output of one command, written by the command and read by a Pager.
+     *
+     * Output is kept in memory up to PagerOptions::memoryLimit and moved to
+     * an unlinked temporary file beyond that, only the offset of each line
+     * stays in memory. The writer is paused once it is more than
+     * PagerOptions::lookahead lines past the last line the reader asked
+     * for, so a command producing endless output is throttled by how fast
+     * the reader pages through it instead of being buffered completely.
+     * Thread safe, append is meant for one thread and the rest for another.
+     */
+    class OutputSpool
+    {
+    private:
+        PagerOptions d_options;
+        mutable std::mutex d_mutex;
+        std::condition_variable d_changed;
+        std::string d_memory;
+        int d_file = -1;
+        std::uint64_t d_size = 0;
+        // offset of the first byte of every line, the last one may be incomplete
+        std::vector<std::uint64_t> d_lineStarts{0};
+        std::size_t d_requested = 0;
+        bool d_closed = false;
+        bool d_discarded = false;
+        bool d_spillFailed = false;
+        // last block read back from the file, lines are mostly read in order
+        std::string d_window;
+        std::uint64_t d_windowOffset = 0;
+
+        std::size_t lineCountLocked() const;
+        void spill();
+        void writeFile(std::string_view text);
+        std::string_view read(std::uint64_t offset, std::size_t size);
+
+    public:
+        explicit OutputSpool(const PagerOptions &options = {});
+        ~OutputSpool();
+
+        OutputSpool(const OutputSpool &) = delete;
+        OutputSpool &operator=(const OutputSpool &) = delete;
+
+        /**
+         * @brief adds output, waiting while the writer is too far ahead of the reader.
+         *
+         * Never throws, it is called from inside std::cout. Output stays in
+         * memory if no temporary file can be created and is dropped from
+         * the point where writing to it fails.
+         */
+        void append(std::string_view text);
+
+        /// @brief no more output will be appended
+        void close();
+
+        /// @brief the reader is gone, output is dropped from now on and append never waits
+        void discard();
+
+        /// @brief lets the writer run until line exists, plus the lookahead
+        void request(std::size_t line);
+
+        /**
+         * @brief waits until there is more than seen bytes of output or it is closed.
+         *
+         * @returns false on timeout.
+         */
+        bool waitForOutput(std::uint64_t seen, std::chrono::milliseconds timeout);
+
+        /// @brief lines so far, an incomplete last line included
+        std::size_t lineCount() const;
+        std::uint64_t size() const;
+        bool closed() const;
+
+        /// @brief true once output went to the temporary file
+        bool spilled() const;
+
+        /// @brief line index without its newline, empty if there is no such line
+        std::string line(std::size_t index);
+
+        /// @brief bytes [from, to) of the output, to is clamped to size()
+        std::string bytes(std::uint64_t from, std::uint64_t to);
+    };
+
+    /**
+     * @brief Shows an OutputSpool a screen at a time.
+     *
+     * Keys: space or f next page, b previous page, enter, j or down one line
+     * down, k or up one line up, g top, G end, / searches forward, n and N
+     * repeat the search forwards and backwards, q or Ctrl-C quit.
+     *
+     * Rendering only reads and formats the lines on screen. Lines longer
+     * than the screen are cut, colour escape sequences are kept and do not
+     * count towards the width. Moves past what has been written so far, such
+     * as G or a search, are finished as the output arrives, see update.
+     */
+    class Pager
+    {
+    private:
+        enum class Goal
+        {
+            NONE,
+            END,
+            SEARCH_FORWARD,
+            SEARCH_BACKWARD
+        };
+
+        OutputSpool &d_spool;
+        std::size_t d_rows;
+        std::size_t d_columns;
+        std::size_t d_top = 0;
+        Goal d_goal = Goal::NONE;
+        // next line the pending search looks at, the one after it when searching backwards
+        std::size_t d_searchNext = 0;
+        std::string d_pattern;
+        bool d_typingPattern = false;
+        std::string d_message;
+
+        std::size_t pageRows() const { return d_rows - 1; }
+        std::size_t lastTop() const;
+        void moveTo(std::size_t top);
+        void startSearch(bool forward);
+        void formatLine(std::string &out, std::string_view line) const;
+
+    public:
+        /// @param rows height of the screen including the status line, at least 2.
+        Pager(OutputSpool &spool, std::size_t rows, std::size_t columns);
+
+        /**
+         * @brief handles one key.
+         *
+         * @returns false once the user quits.
+         */
+        bool feed(const KeyboardInput::Input &input);
+
+        /// @brief continues a pending move with output that arrived since the last call
+        void update();
+
+        /// @brief appends escape sequences redrawing the screen to out
+        void render(std::string &out) const;
+
+        /// @brief index of the first line on screen
+        std::size_t top() const { return d_top; }
+    };
+
+    /**
+     * @brief the size of the terminal on stdout.
+     *
+     * @returns false if stdin or stdout is not a terminal.
+     */
+    bool terminalSize(std::size_t &rows, std::size_t &columns);
+
+    /**
+     * @brief prints spool to stdout as it is written and pages it once it is taller than the terminal.
+     *
+     * Output that fits is printed as it arrives, just as without a pager.
+     * Once more lines than the terminal has arrived, the screen is taken
+     * over by a Pager reading keys from stdin until the user quits.
+     *
+     * @param stop polled while waiting, returning true stops showing output, e.g. when the writer was abandoned.
+     * @returns false if the user quit before all output was written, the spool is discarded then.
+     */
+    bool showOutput(OutputSpool &spool, std::size_t rows, std::size_t columns, const std::function<bool()> &stop);
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "pager.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    using InputType = ose4g::KeyboardInput::InputType;
+
+    ose4g::KeyboardInput::Input key(char c)
+    {
+        return {InputType::ASCII, c};
+    }
+
+    void fill(ose4g::OutputSpool &spool, int lines)
+    {
+        for (int i = 0; i < lines; i++)
+        {
+            spool.append("line " + std::to_string(i) + "\n");
+        }
+    }
+
+    std::string screen(const ose4g::Pager &pager)
+    {
+        std::string out;
+        pager.render(out);
+        return out;
+    }
+}
+
+TEST(OutputSpoolTest, shouldSplitOutputIntoLines)
+{
+    ose4g::OutputSpool spool;
+    spool.append("first\nsec");
+    spool.append("ond\r\nthird");
+    EXPECT_EQ(spool.lineCount(), 3u);
+    EXPECT_EQ(spool.line(0), "first");
+    EXPECT_EQ(spool.line(1), "second");
+    EXPECT_EQ(spool.line(2), "third");
+    EXPECT_EQ(spool.line(3), "");
+    EXPECT_EQ(spool.bytes(6, 9), "sec");
+    spool.append("\n");
+    EXPECT_EQ(spool.lineCount(), 3u);
+}
+
+TEST(OutputSpoolTest, shouldSpillToAFileBeyondTheMemoryLimit)
+{
+    ose4g::OutputSpool spool({.memoryLimit = 1000, .lookahead = 1000000});
+    fill(spool, 100);
+    EXPECT_FALSE(spool.spilled());
+    fill(spool, 10000);
+    EXPECT_TRUE(spool.spilled());
+    EXPECT_EQ(spool.lineCount(), 10100u);
+    EXPECT_EQ(spool.line(0), "line 0");
+    EXPECT_EQ(spool.line(10099), "line 9999");
+    EXPECT_EQ(spool.line(5000), "line 4900");
+}
+
+TEST(OutputSpoolTest, writerShouldWaitForTheReader)
+{
+    ose4g::OutputSpool spool({.lookahead = 10});
+    std::atomic<int> written{0};
+    std::thread writer([&]
+                       {
+        for (int i = 0; i < 100; i++)
+        {
+            spool.append("x\n");
+            written++;
+        }
+        spool.close(); });
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(written.load(), 11);
+
+    spool.request(50);
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(written.load(), 61);
+
+    // a reader that quits never leaves the writer stuck
+    spool.discard();
+    writer.join();
+    EXPECT_EQ(written.load(), 100);
+    EXPECT_EQ(spool.lineCount(), 61u);
+}
+
+TEST(PagerTest, shouldRenderOnlyTheLinesOnScreen)
+{
+    ose4g::OutputSpool spool;
+    fill(spool, 100);
+    spool.close();
+    ose4g::Pager pager(spool, 5, 80);
+    auto out = screen(pager);
+    EXPECT_NE(out.find("line 3\033[K"), std::string::npos);
+    EXPECT_EQ(out.find("line 4"), std::string::npos);
+    EXPECT_NE(out.find("lines 1-4 of 100"), std::string::npos);
+
+    pager.feed(key(' '));
+    EXPECT_EQ(pager.top(), 4u);
+    pager.feed({InputType::ARROW_DOWN, ' '});
+    EXPECT_EQ(pager.top(), 5u);
+    pager.feed(key('b'));
+    EXPECT_EQ(pager.top(), 1u);
+    pager.feed(key('G'));
+    EXPECT_EQ(pager.top(), 96u);
+    EXPECT_NE(screen(pager).find("lines 97-100 of 100 (END)"), std::string::npos);
+    pager.feed(key('g'));
+    EXPECT_EQ(pager.top(), 0u);
+    EXPECT_FALSE(pager.feed(key('q')));
+}
+
+TEST(PagerTest, shouldSearchForwardsAndBackwards)
+{
+    ose4g::OutputSpool spool;
+    fill(spool, 100);
+    spool.close();
+    ose4g::Pager pager(spool, 5, 80);
+    for (char c : std::string("/line 4"))
+    {
+        pager.feed(key(c));
+    }
+    EXPECT_NE(screen(pager).find("/line 4\033[K"), std::string::npos);
+    pager.feed({InputType::ENTER, ' '});
+    EXPECT_EQ(pager.top(), 4u);
+    pager.feed(key('n'));
+    EXPECT_EQ(pager.top(), 40u);
+    pager.feed(key('n'));
+    EXPECT_EQ(pager.top(), 41u);
+    pager.feed(key('N'));
+    EXPECT_EQ(pager.top(), 40u);
+
+    for (char c : std::string("/missing"))
+    {
+        pager.feed(key(c));
+    }
+    pager.feed({InputType::ENTER, ' '});
+    EXPECT_EQ(pager.top(), 40u);
+    EXPECT_NE(screen(pager).find("Pattern not found"), std::string::npos);
+}
+
+TEST(PagerTest, searchShouldWaitForOutputStillBeingWritten)
+{
+    ose4g::OutputSpool spool;
+    fill(spool, 10);
+    ose4g::Pager pager(spool, 5, 80);
+    for (char c : std::string("/line 50"))
+    {
+        pager.feed(key(c));
+    }
+    pager.feed({InputType::ENTER, ' '});
+    EXPECT_EQ(pager.top(), 0u);
+    EXPECT_NE(screen(pager).find("waiting for output"), std::string::npos);
+
+    fill(spool, 100);
+    pager.update();
+    EXPECT_EQ(pager.top(), 60u);
+}
+
+TEST(PagerTest, longLinesShouldBeCutWithoutCountingColours)
+{
+    ose4g::OutputSpool spool;
+    spool.append("\033[1;34mblue\033[0m and a long tail\n\tx\n");
+    spool.close();
+    ose4g::Pager pager(spool, 3, 10);
+    auto out = screen(pager);
+    EXPECT_NE(out.find("\033[1;34mblue\033[0m and a\033[0m\033[K"), std::string::npos);
+    EXPECT_NE(out.find("        x\033[K"), std::string::npos);
+}
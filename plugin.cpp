@@ -0,0 +1,106 @@
+#include "plugin.h"
+#include <dlfcn.h>
+#include <fstream>
+#include <stdexcept>
+
+namespace ose4g
+{
+    Plugin::Plugin(const std::string &manifestPath)
+    {
+        std::ifstream manifest(manifestPath);
+        if (!manifest)
+        {
+            throw std::invalid_argument("cannot open " + manifestPath);
+        }
+        auto slash = manifestPath.rfind('/');
+        std::string directory = slash == std::string::npos ? "" : manifestPath.substr(0, slash + 1);
+
+        std::string line;
+        for (int number = 1; std::getline(manifest, line); number++)
+        {
+            auto start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line[start] == '#')
+            {
+                continue;
+            }
+            auto end = line.find_first_of(" \t", start);
+            std::string name = line.substr(start, end - start);
+            auto rest = end == std::string::npos ? std::string::npos : line.find_first_not_of(" \t", end);
+            std::string value = rest == std::string::npos ? "" : line.substr(rest);
+            if (name == "library")
+            {
+                if (value.empty())
+                {
+                    throw std::invalid_argument(manifestPath + ":" + std::to_string(number) + ": library needs a path");
+                }
+                d_library = value[0] == '/' ? value : directory + value;
+            }
+            else
+            {
+                d_commands.push_back({std::move(name), std::move(value)});
+            }
+        }
+        if (d_library.empty())
+        {
+            throw std::invalid_argument(manifestPath + ": no library line");
+        }
+    }
+
+    Plugin::~Plugin()
+    {
+        // the handlers' code lives in the library
+        d_handlers.clear();
+        if (d_handle)
+        {
+            dlclose(d_handle);
+        }
+    }
+
+    bool Plugin::loaded() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_handle != nullptr;
+    }
+
+    void Plugin::load()
+    {
+        void *handle = dlopen(d_library.c_str(), RTLD_LAZY | RTLD_LOCAL);
+        if (!handle)
+        {
+            throw std::runtime_error(std::string("cannot load plugin: ") + dlerror());
+        }
+        auto entry = reinterpret_cast<PluginEntryPoint>(dlsym(handle, PLUGIN_ENTRY_POINT));
+        if (!entry)
+        {
+            dlclose(handle);
+            throw std::runtime_error(d_library + " has no " + PLUGIN_ENTRY_POINT);
+        }
+        PluginRegistrar registrar;
+        entry(registrar);
+        for (auto &handler : registrar.handlers())
+        {
+            d_handlers[handler.first] = std::move(handler.second);
+        }
+        d_handle = handle;
+    }
+
+    void Plugin::call(const Command &command, const Args &args)
+    {
+        PluginRegistrar::Handler *handler;
+        {
+            std::lock_guard lock(d_mutex);
+            if (!d_handle)
+            {
+                load();
+            }
+            auto found = d_handlers.find(command);
+            if (found == d_handlers.end())
+            {
+                throw std::runtime_error(d_library + " does not provide " + command);
+            }
+            // the map is not changed again once loaded
+            handler = &found->second;
+        }
+        (*handler)(args);
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef PLUGIN_H
+#define PLUGIN_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "rule.h"
+
+namespace ose4g
+{
+    /**
+     * @brief Given to a plugin's entry point to bind its handlers.
+     *
+     * Everything here is inline so plugins do not need symbols from the host.
+     */
+    class PluginRegistrar
+    {
+    public:
+        using Handler = std::function<void(const Args &)>;
+
+        void add(const Command &command, Handler handler)
+        {
+            d_handlers.emplace_back(command, std::move(handler));
+        }
+
+        std::vector<std::pair<Command, Handler>> &handlers() { return d_handlers; }
+
+    private:
+        std::vector<std::pair<Command, Handler>> d_handlers;
+    };
+
+    /// @brief name of the function every plugin exports, see PluginEntryPoint
+    inline constexpr const char *PLUGIN_ENTRY_POINT = "ose4g_register_plugin";
+
+    /// @brief extern "C" void ose4g_register_plugin(ose4g::PluginRegistrar &registrar)
+    using PluginEntryPoint = void (*)(PluginRegistrar &);
+
+    /**
+     * @brief A shared object whose commands are declared in a manifest.
+     *
+     * Reading the manifest is all that happens up front. The library is
+     * opened with lazy binding and its handlers bound the first time one of
+     * its commands runs, so plugins cost nothing until they are used.
+     *
+     * A manifest names the library, relative to the manifest, and one command
+     * per line followed by its description:
+     * @code
+     * # network tools
+     * library libnettools.so
+     * ping send an echo request
+     * route show the routing table
+     * @endcode
+     */
+    class Plugin
+    {
+    public:
+        struct ManifestEntry
+        {
+            Command command;
+            std::string description;
+        };
+
+        /**
+         * @throws std::invalid_argument if the manifest cannot be read or has no library line.
+         */
+        explicit Plugin(const std::string &manifestPath);
+        ~Plugin();
+
+        Plugin(const Plugin &) = delete;
+        Plugin &operator=(const Plugin &) = delete;
+
+        const std::string &library() const { return d_library; }
+        const std::vector<ManifestEntry> &commands() const { return d_commands; }
+        bool loaded() const;
+
+        /**
+         * @brief runs a command of the plugin, loading the library first if needed.
+         *
+         * @throws std::runtime_error if the library cannot be loaded or does
+         *         not provide the command.
+         */
+        void call(const Command &command, const Args &args);
+
+    private:
+        std::string d_library;
+        std::vector<ManifestEntry> d_commands;
+        mutable std::mutex d_mutex;
+        void *d_handle = nullptr;
+        std::unordered_map<Command, PluginRegistrar::Handler> d_handlers;
+
+        void load();
+    };
+}
+
+#endif
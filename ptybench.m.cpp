@@ -0,0 +1,154 @@
+// Measures keystroke to screen latency of the REPL under a pseudo-terminal.
+//
+// The REPL of ptyrepl runs on a pty, the same way an operator runs it, and
+// scripted keystrokes are replayed into it: typing, a paste, history
+// navigation and TAB completion. For each keystroke it records the time to
+// the first byte echoed back, the time until the output settles and how
+// many bytes were written.
+//
+//   ./ptybench --keys 400 --commands 2000 --quiet 5
+#include "ptyharness.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Scenario
+    {
+        std::string name;
+        std::vector<ose4g::PtyHarness::Sample> samples;
+    };
+
+    double micros(std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration<double, std::micro>(time).count();
+    }
+
+    void report(const Scenario &scenario)
+    {
+        auto samples = scenario.samples;
+        if (samples.empty())
+        {
+            return;
+        }
+        auto percentile = [&](double p, auto field)
+        {
+            std::vector<double> values;
+            for (auto &sample : samples)
+            {
+                values.push_back(micros(sample.*field));
+            }
+            std::sort(values.begin(), values.end());
+            return values[std::min(values.size() - 1, static_cast<std::size_t>(p * values.size()))];
+        };
+        std::size_t bytes = 0;
+        for (auto &sample : samples)
+        {
+            bytes += sample.bytes;
+        }
+        using Sample = ose4g::PtyHarness::Sample;
+        std::cout << std::left << std::setw(10) << scenario.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(6) << samples.size() << " keys"
+                  << "  first byte p50 " << std::setw(8) << percentile(0.5, &Sample::firstByte) << "us"
+                  << " p99 " << std::setw(8) << percentile(0.99, &Sample::firstByte) << "us"
+                  << "  settled p50 " << std::setw(8) << percentile(0.5, &Sample::settled) << "us"
+                  << " p99 " << std::setw(8) << percentile(0.99, &Sample::settled) << "us"
+                  << "  " << std::setw(8) << static_cast<double>(bytes) / samples.size() << " bytes/key\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int keys = 400;
+    int commands = 2000;
+    int quiet = 5;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc)
+            keys = std::stoi(argv[++i]);
+        else if (arg == "--commands" && i + 1 < argc)
+            commands = std::stoi(argv[++i]);
+        else if (arg == "--quiet" && i + 1 < argc)
+            quiet = std::stoi(argv[++i]);
+        else
+        {
+            std::cerr << "usage: ptybench [--keys N] [--commands N] [--quiet MS]\n";
+            return 1;
+        }
+    }
+
+    ose4g::PtyHarness pty({PTYREPL, "--prompt", "bench", "--commands", std::to_string(commands)});
+    auto settle = std::chrono::milliseconds(quiet);
+    if (!pty.waitFor("bench => ") || !pty.waitForQuiet(settle))
+    {
+        std::cerr << "the REPL did not start\n";
+        return 1;
+    }
+    // clears the line between scenarios without running anything
+    auto discardLine = [&]
+    {
+        pty.send("\003");
+        pty.waitForQuiet(settle);
+    };
+
+    Scenario typing{"typing", {}};
+    const std::string text = "echo the quick brown fox jumps over the lazy dog";
+    for (int i = 0; i < keys; i++)
+    {
+        if (i > 0 && i % text.size() == 0)
+        {
+            discardLine();
+        }
+        typing.samples.push_back(pty.keystroke(text.substr(i % text.size(), 1), settle));
+    }
+    discardLine();
+
+    Scenario paste{"paste", {}};
+    const std::string pasted = "echo " + std::string(1000, 'p');
+    for (int i = 0; i < std::max(1, keys / 20); i++)
+    {
+        paste.samples.push_back(pty.keystroke(pasted, settle));
+        discardLine();
+    }
+
+    Scenario history{"history", {}};
+    for (int i = 0; i < 50; i++)
+    {
+        pty.send("echo " + std::to_string(i) + "\r");
+        pty.waitFor("bench => ");
+        pty.waitForQuiet(settle);
+    }
+    for (int i = 0; i < keys; i++)
+    {
+        // up through the history and back down again
+        history.samples.push_back(pty.keystroke((i / 50) % 2 == 0 ? "\033[A" : "\033[B", settle));
+    }
+    discardLine();
+
+    Scenario tab{"tab", {}};
+    for (int i = 0; i < std::max(1, keys / 20); i++)
+    {
+        // one completion and one list of candidates
+        pty.send("ech");
+        pty.waitForQuiet(settle);
+        tab.samples.push_back(pty.keystroke("\t", settle));
+        discardLine();
+        pty.send("cmd-1");
+        pty.waitForQuiet(settle);
+        tab.samples.push_back(pty.keystroke("\t", settle));
+        discardLine();
+    }
+
+    pty.send("exit\r");
+    pty.wait();
+    for (auto *scenario : {&typing, &paste, &history, &tab})
+    {
+        report(*scenario);
+    }
+    return 0;
+}
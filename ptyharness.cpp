@@ -0,0 +1,170 @@
+#include "ptyharness.h"
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <pty.h>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace ose4g
+{
+    PtyHarness::PtyHarness(const std::vector<std::string> &command, const PtyOptions &options)
+    {
+        if (command.empty())
+        {
+            throw std::invalid_argument("no program to run");
+        }
+        // only exec is safe in the child of a multi-threaded process, so nothing is allocated there
+        std::vector<char *> argv;
+        for (auto &arg : command)
+        {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+        winsize size{};
+        size.ws_row = options.rows;
+        size.ws_col = options.columns;
+        d_child = forkpty(&d_master, nullptr, nullptr, &size);
+        if (d_child < 0)
+        {
+            throw std::runtime_error("forkpty failed");
+        }
+        if (d_child == 0)
+        {
+            execv(argv[0], argv.data());
+            _exit(127);
+        }
+    }
+
+    PtyHarness::~PtyHarness()
+    {
+        if (d_child > 0)
+        {
+            kill(d_child, SIGKILL);
+            waitpid(d_child, nullptr, 0);
+        }
+        if (d_master >= 0)
+        {
+            close(d_master);
+        }
+    }
+
+    void PtyHarness::send(std::string_view keys)
+    {
+        while (!keys.empty())
+        {
+            ssize_t written = write(d_master, keys.data(), keys.size());
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error("cannot write to the terminal");
+            }
+            keys.remove_prefix(written);
+        }
+    }
+
+    std::size_t PtyHarness::readSome(std::chrono::milliseconds timeout)
+    {
+        if (d_closed)
+        {
+            return 0;
+        }
+        pollfd ready{d_master, POLLIN, 0};
+        if (poll(&ready, 1, static_cast<int>(timeout.count())) <= 0)
+        {
+            return 0;
+        }
+        char buffer[4096];
+        ssize_t count = read(d_master, buffer, sizeof(buffer));
+        if (count <= 0)
+        {
+            // EIO once the child has closed its side
+            d_closed = true;
+            return 0;
+        }
+        d_output.append(buffer, count);
+        return count;
+    }
+
+    bool PtyHarness::waitFor(std::string_view text, std::chrono::milliseconds timeout)
+    {
+        auto deadline = Clock::now() + timeout;
+        while (d_output.find(text) == std::string::npos)
+        {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            if (left.count() <= 0 || d_closed)
+            {
+                return false;
+            }
+            readSome(left);
+        }
+        return true;
+    }
+
+    bool PtyHarness::waitForQuiet(std::chrono::milliseconds quiet, std::chrono::milliseconds timeout)
+    {
+        auto deadline = Clock::now() + timeout;
+        while (Clock::now() < deadline)
+        {
+            if (readSome(quiet) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    PtyHarness::Sample PtyHarness::keystroke(std::string_view keys, std::chrono::milliseconds quiet)
+    {
+        Sample sample;
+        auto sent = Clock::now();
+        send(keys);
+        // a slow first response is latency, not quiet
+        auto deadline = sent + std::chrono::seconds(5);
+        while (sample.bytes == 0 && Clock::now() < deadline && !d_closed)
+        {
+            sample.bytes += readSome(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()));
+        }
+        if (sample.bytes == 0)
+        {
+            return sample;
+        }
+        sample.firstByte = sample.settled = Clock::now() - sent;
+        while (std::size_t count = readSome(quiet))
+        {
+            sample.bytes += count;
+            sample.settled = Clock::now() - sent;
+        }
+        return sample;
+    }
+
+    int PtyHarness::wait(std::chrono::milliseconds timeout)
+    {
+        auto deadline = Clock::now() + timeout;
+        while (d_child > 0)
+        {
+            int status;
+            pid_t done = waitpid(d_child, &status, WNOHANG);
+            if (done == d_child)
+            {
+                d_child = -1;
+                return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            }
+            if (Clock::now() >= deadline)
+            {
+                return -1;
+            }
+            // keep draining so the child never blocks on a full terminal
+            if (readSome(std::chrono::milliseconds(10)) == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        return -1;
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef PTYHARNESS_H
+#define PTYHARNESS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace ose4g
+{
+    /// @brief size of the terminal the child sees
+    struct PtyOptions
+    {
+        unsigned short rows = 24;
+        unsigned short columns = 80;
+    };
+
+    /**
+     * @brief Runs a program under a pseudo-terminal and drives it like a user would.
+     *
+     * The child sees a real terminal on stdin and stdout, so raw mode, key
+     * decoding and rendering are exercised exactly as in an interactive
+     * session. Keys are written to the master side and everything the child
+     * prints is collected from it. Needs no display, only /dev/ptmx.
+     */
+    class PtyHarness
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// @brief what one keystroke made the child print
+        struct Sample
+        {
+            /// until the first byte of output
+            std::chrono::nanoseconds firstByte{0};
+            /// until the last byte before the output went quiet
+            std::chrono::nanoseconds settled{0};
+            std::size_t bytes = 0;
+        };
+
+        /**
+         * @brief starts a program on a new pseudo-terminal.
+         *
+         * command is the path of the program followed by its arguments. The
+         * program is executed right after the fork, so it does not inherit
+         * the state of the caller's threads. If it cannot be executed the
+         * child exits with 127.
+         *
+         * @throws std::invalid_argument if command is empty.
+         * @throws std::runtime_error if the terminal cannot be created.
+         */
+        explicit PtyHarness(const std::vector<std::string> &command, const PtyOptions &options = {});
+
+        /// @brief kills the child if it is still running
+        ~PtyHarness();
+
+        PtyHarness(const PtyHarness &) = delete;
+        PtyHarness &operator=(const PtyHarness &) = delete;
+
+        /// @brief types keys, escape sequences such as "\033[A" for the up arrow included
+        void send(std::string_view keys);
+
+        /**
+         * @brief reads output until text appears in it.
+         *
+         * @returns false if it did not appear within timeout or the child exited.
+         */
+        bool waitFor(std::string_view text, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+        /**
+         * @brief reads output until nothing arrives for quiet.
+         *
+         * @returns false if output did not stop within timeout.
+         */
+        bool waitForQuiet(std::chrono::milliseconds quiet, std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+        /**
+         * @brief sends keys and measures the output they cause.
+         *
+         * Output is considered stable once nothing arrives for quiet, which
+         * is not counted in the latencies.
+         */
+        Sample keystroke(std::string_view keys, std::chrono::milliseconds quiet = std::chrono::milliseconds(20));
+
+        /// @brief everything read since the start or the last clearOutput
+        const std::string &output() const { return d_output; }
+        void clearOutput() { d_output.clear(); }
+
+        /**
+         * @brief waits for the child to exit.
+         *
+         * @returns its exit status, or -1 if it did not exit within timeout or was killed by a signal.
+         */
+        int wait(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+
+    private:
+        int d_master = -1;
+        pid_t d_child = -1;
+        bool d_closed = false;
+        std::string d_output;
+
+        // one read with a timeout, returns bytes read, 0 on timeout or end of output
+        std::size_t readSome(std::chrono::milliseconds timeout);
+    };
+}
+
+#endif
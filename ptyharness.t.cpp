@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ptyharness.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    // the REPL of ptyrepl.m.cpp, built next to the tests
+    const std::vector<std::string> REPL{PTYREPL};
+}
+
+TEST(PtyHarnessTest, replShouldRunCommandsTypedAtTheTerminal)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+
+    // a single match is completed in place
+    pty.send("hell\t");
+    ASSERT_TRUE(pty.waitFor("pty => hello"));
+    pty.send(" bob\r");
+    ASSERT_TRUE(pty.waitFor("Hello bob!"));
+
+    // the up arrow brings the last line back
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.clearOutput();
+    pty.send("\033[A");
+    ASSERT_TRUE(pty.waitFor("pty => hello bob"));
+    pty.send("\r");
+    ASSERT_TRUE(pty.waitFor("Hello bob!"));
+
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, ctrlCShouldOnlyDiscardTheLine)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("hello typo\003");
+    ASSERT_TRUE(pty.waitFor("^C"));
+    pty.send("hello\r");
+    ASSERT_TRUE(pty.waitFor("Hello world!"));
+    EXPECT_EQ(pty.output().find("Hello typo"), std::string::npos);
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, ctrlCShouldStopARunningCommand)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("wait\r");
+    ASSERT_TRUE(pty.waitFor("waiting"));
+    pty.send("\003");
+    ASSERT_TRUE(pty.waitFor("Interrupted"));
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, ctrlCShouldStopAStreamingCommand)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("dots\r");
+    ASSERT_TRUE(pty.waitFor("..."));
+    pty.send("\003");
+    ASSERT_TRUE(pty.waitFor("Interrupted"));
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, secondCtrlCShouldLeaveACommandIgnoringItRunning)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("block\r");
+    ASSERT_TRUE(pty.waitFor("blocked"));
+    pty.clearOutput();
+    pty.send("\003");
+    EXPECT_FALSE(pty.waitFor("pty => ", 100ms));
+    pty.send("\003");
+    ASSERT_TRUE(pty.waitFor("left running in the background"));
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("hello\r");
+    ASSERT_TRUE(pty.waitFor("Hello world!"));
+    pty.send("release\r");
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, exitShouldWaitForCommandsLeftRunning)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("block\r");
+    ASSERT_TRUE(pty.waitFor("blocked"));
+    pty.send("\003");
+    std::this_thread::sleep_for(50ms);
+    pty.send("\003");
+    ASSERT_TRUE(pty.waitFor("left running in the background"));
+    pty.send("exit\r");
+    ASSERT_TRUE(pty.waitFor("Waiting for a command left running in the background"));
+    EXPECT_EQ(pty.wait(200ms), -1);
+}
+
+TEST(PtyHarnessTest, keysTypedAheadShouldNotBeLost)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("hello one\rhello two\rexit\r");
+    EXPECT_EQ(pty.wait(), 0);
+    EXPECT_NE(pty.output().find("Hello one!"), std::string::npos);
+    EXPECT_NE(pty.output().find("Hello two!"), std::string::npos);
+}
+
+TEST(PtyHarnessTest, keystrokeShouldMeasureWhatItRenders)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    ASSERT_TRUE(pty.waitForQuiet(20ms));
+    auto sample = pty.keystroke("h");
+    // the line is redrawn: clear, prompt and the input so far
+    EXPECT_GE(sample.bytes, std::string("\r\033[Kpty => h").size());
+    EXPECT_GT(sample.firstByte.count(), 0);
+    EXPECT_GE(sample.settled, sample.firstByte);
+}
+
+TEST(PtyHarnessTest, outputTallerThanTheTerminalShouldBePaged)
+{
+    ose4g::PtyHarness pty(REPL, {.rows = 10, .columns = 40});
+    ASSERT_TRUE(pty.waitFor("pty => "));
+
+    // short output is printed as it is
+    pty.send("count 3\r");
+    ASSERT_TRUE(pty.waitFor("row 2"));
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    EXPECT_EQ(pty.output().find("lines "), std::string::npos);
+
+    pty.clearOutput();
+    pty.send("count 100000\r");
+    ASSERT_TRUE(pty.waitFor("lines 1-9 of "));
+    EXPECT_EQ(pty.output().find("row 9\033"), std::string::npos);
+    pty.send(" ");
+    ASSERT_TRUE(pty.waitFor("lines 10-18 of "));
+    pty.send("/row 500\r");
+    ASSERT_TRUE(pty.waitFor("lines 501-509 of "));
+
+    // quitting stops waiting for the rest of the output
+    pty.clearOutput();
+    pty.send("q");
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("hello\r");
+    ASSERT_TRUE(pty.waitFor("Hello world!"));
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, quittingThePagerShouldGiveUpOnACommandThatKeepsWriting)
+{
+    ose4g::PtyHarness pty(REPL, {.rows = 10, .columns = 40});
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("flood\r");
+    ASSERT_TRUE(pty.waitFor("lines 1-9 of "));
+    pty.clearOutput();
+    pty.send("q");
+    ASSERT_TRUE(pty.waitFor("left running in the background"));
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("release\r");
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, scheduledOutputShouldNotDisturbTheLineBeingTyped)
+{
+    ose4g::PtyHarness pty(REPL);
+    ASSERT_TRUE(pty.waitFor("pty => "));
+    pty.send("every 50ms hello tick\r");
+    ASSERT_TRUE(pty.waitFor("scheduled 1"));
+    ASSERT_TRUE(pty.waitFor("pty => "));
+
+    // each run is printed over the prompt, which is drawn again with what was typed
+    pty.clearOutput();
+    pty.send("hel");
+    ASSERT_TRUE(pty.waitFor("Hello tick!\r\n\r\033[Kpty => hel"));
+    pty.send("lo\r");
+    ASSERT_TRUE(pty.waitFor("Hello world!"));
+
+    pty.send("every cancel all\r");
+    ASSERT_TRUE(pty.waitFor("cancelled 1"));
+    pty.send("exit\r");
+    EXPECT_EQ(pty.wait(), 0);
+}
+
+TEST(PtyHarnessTest, aProgramThatCannotBeRunShouldExitWith127)
+{
+    ose4g::PtyHarness pty({"/nonexistent/repl"});
+    EXPECT_EQ(pty.wait(), 127);
+    EXPECT_THROW(ose4g::PtyHarness({}), std::invalid_argument);
+}
@@ -0,0 +1,78 @@
+// The REPL driven by the pty tests and ptybench.
+//
+// PtyHarness executes it on a pseudo-terminal, so the REPL starts as a new
+// process instead of a fork of a multi-threaded test or benchmark.
+//
+//   ./ptyrepl --prompt bench --commands 2000
+#include "command-processor.h"
+#include "style.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+int main(int argc, char **argv)
+{
+    std::string prompt = "pty";
+    int commands = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--prompt" && i + 1 < argc)
+            prompt = argv[++i];
+        else if (arg == "--commands" && i + 1 < argc)
+            commands = std::stoi(argv[++i]);
+        else
+        {
+            std::cerr << "usage: ptyrepl [--prompt NAME] [--commands N]\n";
+            return 1;
+        }
+    }
+
+    ose4g::setColorMode(ose4g::ColorMode::NEVER);
+    ose4g::CommandProcessor cp(prompt);
+    cp.add("hello", [](const ose4g::Args &args)
+           { std::cout << "Hello " << (args.empty() ? "world" : args[0]) << "!"; });
+    cp.add("echo", [](const ose4g::Args &args)
+           {
+        for (auto &arg : args)
+            std::cout << arg << ' '; });
+    cp.add("count", [](const ose4g::Args &args)
+           {
+        for (int i = 0; i < std::stoi(args[0]); i++)
+            std::cout << "row " << i << '\n'; });
+    cp.add("wait", [](const ose4g::Args &, std::stop_token stop)
+           {
+        std::cout << "waiting" << std::endl;
+        while (!stop.stop_requested())
+            std::this_thread::sleep_for(1ms); });
+    cp.add("dots", [](const ose4g::Args &) -> ose4g::Stream
+           {
+        while (true)
+        {
+            co_yield ".";
+            std::this_thread::sleep_for(1ms);
+        } });
+    // ignores Ctrl-C until release is run
+    static std::atomic<bool> released{false};
+    cp.add("block", [](const ose4g::Args &)
+           {
+        std::cout << "blocked" << std::endl;
+        while (!released)
+            std::this_thread::sleep_for(1ms); });
+    cp.add("flood", [](const ose4g::Args &)
+           {
+        for (int i = 0; !released; i++)
+            std::cout << "flood " << i << '\n'; });
+    cp.add("release", [](const ose4g::Args &)
+           { released = true; });
+    for (int i = 0; i < commands; i++)
+    {
+        cp.add("cmd-" + std::to_string(i), [](const ose4g::Args &) {});
+    }
+    cp.run();
+    return 0;
+}
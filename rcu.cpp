@@ -0,0 +1,179 @@
+#include "rcu.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ose4g
+{
+    namespace
+    {
+        // epoch a reader entered at, 0 while the thread is not reading
+        struct ReaderRecord
+        {
+            std::atomic<std::uint64_t> epoch{0};
+            std::atomic<bool> inUse{false};
+            ReaderRecord *next = nullptr;
+            int nesting = 0;
+        };
+
+        struct Retired
+        {
+            std::uint64_t epoch;
+            std::function<void()> deleter;
+        };
+
+        class Domain
+        {
+        private:
+            std::atomic<ReaderRecord *> d_records{nullptr};
+            std::mutex d_mutex;
+            std::vector<Retired> d_retired;
+
+        public:
+            std::atomic<std::uint64_t> d_epoch{1};
+
+            ~Domain()
+            {
+                // only runs at exit, when nothing reads any more
+                for (auto &retired : d_retired)
+                {
+                    retired.deleter();
+                }
+                auto record = d_records.load();
+                while (record)
+                {
+                    auto next = record->next;
+                    delete record;
+                    record = next;
+                }
+            }
+
+            // records are never freed while running, threads that exit leave theirs for reuse
+            ReaderRecord *acquire()
+            {
+                for (auto record = d_records.load(); record; record = record->next)
+                {
+                    bool expected = false;
+                    if (!record->inUse && record->inUse.compare_exchange_strong(expected, true))
+                    {
+                        return record;
+                    }
+                }
+                auto record = new ReaderRecord;
+                record->inUse = true;
+                record->next = d_records.load();
+                while (!d_records.compare_exchange_weak(record->next, record))
+                {
+                }
+                return record;
+            }
+
+            void retire(std::function<void()> deleter)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(d_mutex);
+                    d_retired.push_back({d_epoch.fetch_add(1), std::move(deleter)});
+                }
+                reclaim();
+            }
+
+            void reclaim()
+            {
+                std::vector<std::function<void()>> ready;
+                {
+                    std::lock_guard<std::mutex> lock(d_mutex);
+                    if (d_retired.empty())
+                    {
+                        return;
+                    }
+                    // pairs with the fence of RcuReadGuard: either the reader's epoch is seen here or
+                    // the reader sees the pointer that replaced the retired one
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                    // anything retired before the oldest active reader entered is unreachable
+                    std::uint64_t oldest = UINT64_MAX;
+                    for (auto record = d_records.load(); record; record = record->next)
+                    {
+                        auto epoch = record->epoch.load();
+                        if (epoch != 0 && epoch < oldest)
+                        {
+                            oldest = epoch;
+                        }
+                    }
+                    auto keep = d_retired.begin();
+                    for (auto &retired : d_retired)
+                    {
+                        if (retired.epoch < oldest)
+                        {
+                            ready.push_back(std::move(retired.deleter));
+                        }
+                        else
+                        {
+                            *keep++ = std::move(retired);
+                        }
+                    }
+                    d_retired.erase(keep, d_retired.end());
+                }
+                // deleters may run user destructors, keep them out of the lock
+                for (auto &deleter : ready)
+                {
+                    deleter();
+                }
+            }
+        };
+
+        Domain &domain()
+        {
+            static Domain instance;
+            return instance;
+        }
+
+        struct ThreadRecord
+        {
+            ReaderRecord *record = domain().acquire();
+            ~ThreadRecord()
+            {
+                record->epoch = 0;
+                record->inUse = false;
+            }
+        };
+
+        ReaderRecord &threadRecord()
+        {
+            static thread_local ThreadRecord record;
+            return *record.record;
+        }
+    }
+
+    RcuReadGuard::RcuReadGuard()
+    {
+        auto &record = threadRecord();
+        if (record.nesting++ == 0)
+        {
+            record.epoch.store(domain().d_epoch.load());
+            // a store followed by a load is only ordered by a full fence, an acquire load of a
+            // protected pointer could otherwise be done before a writer can see the epoch
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    RcuReadGuard::~RcuReadGuard()
+    {
+        auto &record = threadRecord();
+        if (--record.nesting == 0)
+        {
+            record.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    void rcuRetire(std::function<void()> deleter)
+    {
+        domain().retire(std::move(deleter));
+    }
+
+    void rcuReclaim()
+    {
+        domain().reclaim();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef RCU_H
+#define RCU_H
+
+#include <functional>
+
+namespace ose4g
+{
+    /**
+     * @brief Marks the current thread as reading RCU protected data.
+     *
+     * Pointers loaded from RCU protected locations stay valid until the guard
+     * is destroyed. Entering and leaving is a store to a thread local slot,
+     * readers never wait for writers. Guards nest.
+     */
+    class RcuReadGuard
+    {
+    public:
+        RcuReadGuard();
+        ~RcuReadGuard();
+
+        RcuReadGuard(const RcuReadGuard &) = delete;
+        RcuReadGuard &operator=(const RcuReadGuard &) = delete;
+    };
+
+    /**
+     * @brief Schedules deleter to run once no reader can still see the retired object.
+     *
+     * Call after the object has been unpublished. Retired objects are freed
+     * by later calls, or by rcuReclaim, once every reader that started before
+     * them has left. Nothing is freed in between, so the last object retired
+     * stays until one of them runs.
+     */
+    void rcuRetire(std::function<void()> deleter);
+
+    /// @brief frees the retired objects no reader can still see
+    void rcuReclaim();
+
+    template <typename T>
+    void rcuRetire(const T *object)
+    {
+        rcuRetire([object]
+                  { delete object; });
+    }
+}
+
+#endif
@@ -0,0 +1,216 @@
+#include "recording.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace ose4g
+{
+    namespace
+    {
+        template <typename T>
+        void put(std::string &buffer, T value)
+        {
+            buffer.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        void putString(std::string &buffer, std::string_view value)
+        {
+            put<std::uint32_t>(buffer, value.size());
+            buffer.append(value);
+        }
+
+        // bounds checked cursor over a mapped record
+        struct Cursor
+        {
+            const char *position;
+            const char *end;
+
+            template <typename T>
+            bool get(T &value)
+            {
+                if (end - position < static_cast<std::ptrdiff_t>(sizeof(T)))
+                    return false;
+                std::memcpy(&value, position, sizeof(T));
+                position += sizeof(T);
+                return true;
+            }
+
+            bool getString(std::string_view &value)
+            {
+                std::uint32_t size;
+                if (!get(size) || end - position < static_cast<std::ptrdiff_t>(size))
+                    return false;
+                value = {position, size};
+                position += size;
+                return true;
+            }
+        };
+    }
+
+    SessionRecorder::SessionRecorder(const std::string &path) : d_start(std::chrono::steady_clock::now())
+    {
+        d_fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (d_fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        if (write(d_fd, MAGIC.data(), MAGIC.size()) != static_cast<ssize_t>(MAGIC.size()))
+        {
+            int error = errno;
+            close(d_fd);
+            throw std::system_error(error, std::generic_category(), "write " + path);
+        }
+        d_size = MAGIC.size();
+    }
+
+    SessionRecorder::~SessionRecorder()
+    {
+        close(d_fd);
+    }
+
+    void SessionRecorder::record(const Command &command, const Args &args, std::chrono::steady_clock::time_point started,
+                                 std::chrono::nanoseconds duration, bool ok, std::string_view message)
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (d_failed)
+        {
+            return;
+        }
+        d_buffer.clear();
+        put<std::uint32_t>(d_buffer, 0);
+        put<std::uint64_t>(d_buffer, std::chrono::duration_cast<std::chrono::nanoseconds>(started - d_start).count());
+        put<std::uint64_t>(d_buffer, duration.count());
+        put<std::uint8_t>(d_buffer, ok);
+        putString(d_buffer, command);
+        put<std::uint32_t>(d_buffer, args.size());
+        for (auto &arg : args)
+        {
+            putString(d_buffer, arg);
+        }
+        putString(d_buffer, message);
+        std::uint32_t length = d_buffer.size() - sizeof(std::uint32_t);
+        std::memcpy(d_buffer.data(), &length, sizeof(length));
+
+        const char *data = d_buffer.data();
+        std::size_t left = d_buffer.size();
+        while (left > 0)
+        {
+            ssize_t written = write(d_fd, data, left);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                // part of the record may be in the file already and every later one would be read from the middle of
+                // it, so cut it off and stop recording
+                int error = errno;
+                d_failed = true;
+                ftruncate(d_fd, d_size);
+                std::cerr << "recording stopped: " << std::strerror(error) << std::endl;
+                return;
+            }
+            data += written;
+            left -= written;
+        }
+        d_size += d_buffer.size();
+    }
+
+    bool SessionRecorder::failed() const
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        return d_failed;
+    }
+
+    RecordingReader::RecordingReader(const std::string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) < 0)
+        {
+            int error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "stat " + path);
+        }
+        d_size = info.st_size;
+        if (d_size < MAGIC_SIZE)
+        {
+            close(fd);
+            throw std::invalid_argument(path + " is not a recording");
+        }
+        void *data = mmap(nullptr, d_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            throw std::system_error(error, std::generic_category(), "mmap " + path);
+        }
+        // records are read front to back, let the kernel read ahead and drop pages behind us
+        madvise(data, d_size, MADV_SEQUENTIAL);
+        d_data = static_cast<const char *>(data);
+        if (std::string_view(d_data, MAGIC_SIZE) != SessionRecorder::MAGIC)
+        {
+            munmap(data, d_size);
+            throw std::invalid_argument(path + " is not a recording");
+        }
+    }
+
+    RecordingReader::~RecordingReader()
+    {
+        munmap(const_cast<char *>(d_data), d_size);
+    }
+
+    std::size_t RecordingReader::read(std::size_t offset, Record &record) const
+    {
+        Cursor cursor{d_data + offset, d_data + d_size};
+        std::uint32_t length;
+        if (offset >= d_size || !cursor.get(length) || cursor.end - cursor.position < static_cast<std::ptrdiff_t>(length))
+        {
+            return 0;
+        }
+        cursor.end = cursor.position + length;
+
+        std::uint8_t ok;
+        if (!cursor.get(record.start) || !cursor.get(record.duration) || !cursor.get(ok) ||
+            !cursor.getString(record.command) || !cursor.get(record.argCount))
+        {
+            return 0;
+        }
+        record.ok = ok;
+
+        const char *argsStart = cursor.position;
+        for (std::uint32_t i = 0; i < record.argCount; i++)
+        {
+            std::string_view arg;
+            if (!cursor.getString(arg))
+                return 0;
+        }
+        record.encodedArgs = {argsStart, static_cast<std::size_t>(cursor.position - argsStart)};
+        if (!cursor.getString(record.message))
+        {
+            return 0;
+        }
+        return cursor.end - d_data;
+    }
+
+    Args RecordingReader::Record::args() const
+    {
+        Args args;
+        args.reserve(argCount);
+        Cursor cursor{encodedArgs.data(), encodedArgs.data() + encodedArgs.size()};
+        std::string_view arg;
+        while (cursor.getString(arg))
+        {
+            args.emplace_back(arg);
+        }
+        return args;
+    }
+}
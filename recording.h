@@ -0,0 +1,110 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include "rule.h"
+
+namespace ose4g
+{
+    /**
+     * @brief Appends every processed command to a binary log.
+     *
+     * The file starts with an 8 byte magic followed by length prefixed records
+     * in host byte order:
+     *
+     *     u32 length of the rest of the record
+     *     u64 start, nanoseconds since the recording started
+     *     u64 duration in nanoseconds
+     *     u8  1 if the command succeeded
+     *     u32 size + bytes of the command
+     *     u32 argument count, then u32 size + bytes of each argument
+     *     u32 size + bytes of the error message
+     *
+     * Each record is written with a single write so the log can be read
+     * while it is still being recorded, and a torn last record is skipped.
+     * A write that fails part way leaves no such boundary for the records
+     * after it, so the first failure cuts the file back to the last complete
+     * record and nothing more is recorded.
+     */
+    class SessionRecorder
+    {
+    private:
+        mutable std::mutex d_mutex;
+        int d_fd;
+        std::chrono::steady_clock::time_point d_start;
+        std::string d_buffer;
+        // bytes of complete records, magic included
+        std::size_t d_size = 0;
+        bool d_failed = false;
+
+    public:
+        static constexpr std::string_view MAGIC = "OSE4GREC";
+
+        /// @throws std::system_error if the file can not be created
+        explicit SessionRecorder(const std::string &path);
+        ~SessionRecorder();
+
+        SessionRecorder(const SessionRecorder &) = delete;
+        SessionRecorder &operator=(const SessionRecorder &) = delete;
+
+        /// @brief appends one command. Safe to call from several threads.
+        void record(const Command &command, const Args &args, std::chrono::steady_clock::time_point started,
+                    std::chrono::nanoseconds duration, bool ok, std::string_view message);
+
+        /// @brief true once a write failed, nothing is recorded after that
+        bool failed() const;
+    };
+
+    /**
+     * @brief Reads a log written by SessionRecorder through a read only memory map.
+     *
+     * Records are decoded in place so logs larger than memory can be replayed.
+     */
+    class RecordingReader
+    {
+    private:
+        const char *d_data = nullptr;
+        std::size_t d_size = 0;
+
+    public:
+        struct Record
+        {
+            std::uint64_t start;
+            std::uint64_t duration;
+            bool ok;
+            std::string_view command;
+            std::uint32_t argCount;
+            std::string_view encodedArgs;
+            std::string_view message;
+
+            /// @brief decodes the arguments
+            Args args() const;
+        };
+
+        /// @throws std::system_error if the file can not be mapped, std::invalid_argument if it is not a recording
+        explicit RecordingReader(const std::string &path);
+        ~RecordingReader();
+
+        RecordingReader(const RecordingReader &) = delete;
+        RecordingReader &operator=(const RecordingReader &) = delete;
+
+        /// @brief offset of the first record
+        std::size_t begin() const { return MAGIC_SIZE; }
+
+        /**
+         * @brief decodes the record at offset.
+         *
+         * @returns offset of the next record, or 0 if there is no complete record at offset
+         */
+        std::size_t read(std::size_t offset, Record &record) const;
+
+    private:
+        static constexpr std::size_t MAGIC_SIZE = SessionRecorder::MAGIC.size();
+    };
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <csignal>
+#include <fstream>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "recording.h"
+
+class RecordingTest : public testing::Test
+{
+public:
+    std::string path = "/tmp/command-processor-recording-" + std::to_string(getpid()) + ".log";
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+    }
+};
+
+TEST_F(RecordingTest, readerShouldDecodeRecordedCommands)
+{
+    {
+        ose4g::SessionRecorder recorder(path);
+        auto now = std::chrono::steady_clock::now();
+        recorder.record("send", {"-l", "hello world"}, now, std::chrono::microseconds(5), true, "");
+        recorder.record("list", {}, now, std::chrono::microseconds(7), false, "Command list not found");
+    }
+
+    ose4g::RecordingReader reader(path);
+    ose4g::RecordingReader::Record record;
+    auto offset = reader.read(reader.begin(), record);
+    ASSERT_NE(offset, 0);
+    EXPECT_EQ(record.command, "send");
+    EXPECT_EQ(record.args(), (ose4g::Args{"-l", "hello world"}));
+    EXPECT_TRUE(record.ok);
+    EXPECT_EQ(record.duration, 5000);
+
+    offset = reader.read(offset, record);
+    ASSERT_NE(offset, 0);
+    EXPECT_EQ(record.command, "list");
+    EXPECT_TRUE(record.args().empty());
+    EXPECT_FALSE(record.ok);
+    EXPECT_EQ(record.message, "Command list not found");
+
+    EXPECT_EQ(reader.read(offset, record), 0);
+}
+
+TEST_F(RecordingTest, readerShouldSkipATornLastRecord)
+{
+    {
+        ose4g::SessionRecorder recorder(path);
+        recorder.record("send", {"a"}, std::chrono::steady_clock::now(), {}, true, "");
+    }
+    {
+        std::ofstream file(path, std::ios::app | std::ios::binary);
+        file.write("\x40\x00\x00\x00\x01", 5);
+    }
+    ose4g::RecordingReader reader(path);
+    ose4g::RecordingReader::Record record;
+    auto offset = reader.read(reader.begin(), record);
+    ASSERT_NE(offset, 0);
+    EXPECT_EQ(reader.read(offset, record), 0);
+}
+
+TEST_F(RecordingTest, recorderShouldStopAtTheLastCompleteRecordWhenAWriteFails)
+{
+    ose4g::SessionRecorder recorder(path);
+    recorder.record("send", {"a"}, std::chrono::steady_clock::now(), {}, true, "");
+    struct stat info;
+    ASSERT_EQ(stat(path.c_str(), &info), 0);
+    off_t complete = info.st_size;
+
+    // let the next record only partly fit
+    rlimit original;
+    getrlimit(RLIMIT_FSIZE, &original);
+    auto previous = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limited = original;
+    limited.rlim_cur = complete + 10;
+    setrlimit(RLIMIT_FSIZE, &limited);
+    recorder.record("send", {std::string(100, 'b')}, std::chrono::steady_clock::now(), {}, true, "");
+    setrlimit(RLIMIT_FSIZE, &original);
+    std::signal(SIGXFSZ, previous);
+
+    EXPECT_TRUE(recorder.failed());
+    recorder.record("send", {"c"}, std::chrono::steady_clock::now(), {}, true, "");
+    ASSERT_EQ(stat(path.c_str(), &info), 0);
+    EXPECT_EQ(info.st_size, complete);
+
+    ose4g::RecordingReader reader(path);
+    ose4g::RecordingReader::Record record;
+    auto offset = reader.read(reader.begin(), record);
+    ASSERT_NE(offset, 0);
+    EXPECT_EQ(record.args(), ose4g::Args{"a"});
+    EXPECT_EQ(reader.read(offset, record), 0);
+}
+
+TEST_F(RecordingTest, readerShouldRejectOtherFiles)
+{
+    {
+        std::ofstream file(path);
+        file << "not a recording";
+    }
+    EXPECT_THROW(ose4g::RecordingReader reader(path), std::invalid_argument);
+}
@@ -0,0 +1,140 @@
+#include "registry.h"
+#include <stdexcept>
+
+namespace ose4g
+{
+    namespace
+    {
+        using EntryPointer = std::shared_ptr<const CommandEntry>;
+
+        template <typename... Args>
+        std::shared_ptr<CommandEntry> makeEntry(Args &&...args)
+        {
+            return makeCounted<CommandEntry>(MemoryCategory::REGISTRY, std::forward<Args>(args)...);
+        }
+
+        std::string notFound(const CommandPath &path)
+        {
+            std::string message = "Command";
+            for (auto &part : path)
+            {
+                message += " " + part;
+            }
+            return message + " not found";
+        }
+
+        EntryPointer insertAt(const EntryPointer &node, const CommandPath &path, std::size_t depth, const CommandEntry &entry)
+        {
+            auto copy = node ? makeEntry(*node) : makeEntry();
+            if (depth < path.size())
+            {
+                auto &child = copy->subcommands[path[depth]];
+                child = insertAt(child, path, depth + 1, entry);
+                return copy;
+            }
+            if (entry.runnable())
+            {
+                if (copy->runnable())
+                {
+                    throw std::invalid_argument("command already exists");
+                }
+                copy->processor = entry.processor;
+                copy->streamProcessor = entry.streamProcessor;
+                copy->macro = entry.macro;
+                copy->rules = entry.rules;
+                copy->options = entry.options;
+                copy->cache = entry.cache;
+            }
+            if (!entry.description.empty())
+            {
+                copy->description = entry.description;
+            }
+            return copy;
+        }
+
+        EntryPointer eraseAt(const EntryPointer &node, const CommandPath &path, std::size_t depth)
+        {
+            auto child = node->subcommands.find(path[depth]);
+            if (child == node->subcommands.end())
+            {
+                throw std::invalid_argument(notFound(path));
+            }
+            auto copy = makeEntry(*node);
+            if (depth + 1 == path.size())
+            {
+                copy->subcommands.erase(path[depth]);
+            }
+            else
+            {
+                copy->subcommands[path[depth]] = eraseAt(child->second, path, depth + 1);
+            }
+            return copy;
+        }
+    }
+
+    void CommandRegistry::Snapshot::insert(const CommandPath &path, const CommandEntry &entry)
+    {
+        auto top = commands.find(path[0]);
+        bool added = !top;
+        commands.set(path[0], insertAt(top ? *top : nullptr, path, 1, entry));
+        if (added)
+        {
+            autocomplete.add(path[0]);
+            names.add(path[0]);
+        }
+    }
+
+    void CommandRegistry::Snapshot::insertAll(const std::vector<std::pair<CommandPath, CommandEntry>> &entries)
+    {
+        std::vector<std::string> added;
+        for (auto &[path, entry] : entries)
+        {
+            auto top = commands.find(path[0]);
+            if (!top)
+            {
+                added.push_back(path[0]);
+            }
+            commands.set(path[0], insertAt(top ? *top : nullptr, path, 1, entry));
+        }
+        autocomplete.addAll(added);
+        names.addAll(added);
+    }
+
+    void CommandRegistry::Snapshot::erase(const CommandPath &path)
+    {
+        auto top = commands.find(path[0]);
+        if (!top)
+        {
+            throw std::invalid_argument(notFound(path));
+        }
+        if (path.size() == 1)
+        {
+            commands.erase(path[0]);
+            autocomplete.remove(path[0]);
+            names.remove(path[0]);
+            return;
+        }
+        commands.set(path[0], eraseAt(*top, path, 1));
+    }
+
+    CommandRegistry::CommandRegistry() : d_current(new Snapshot)
+    {
+        // creates the RCU domain first, so a static registry is destroyed while it still exists
+        rcuReclaim();
+    }
+
+    CommandRegistry::~CommandRegistry()
+    {
+        // readers of a registry being destroyed are a bug in the owner, free straight away
+        delete d_current.load();
+        // and its snapshots retired since the last update
+        rcuReclaim();
+    }
+
+    std::shared_ptr<const CommandEntry> CommandRegistry::find(const Command &command) const
+    {
+        RcuReadGuard guard;
+        auto entry = current().commands.find(command);
+        return entry ? *entry : nullptr;
+    }
+}
@@ -0,0 +1,197 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string_view>
+#include "autocomplete.h"
+#include "bktree.h"
+#include "hashtrie.h"
+#include "macro.h"
+#include "memory.h"
+#include "rcu.h"
+#include "resultcache.h"
+#include "rule.h"
+#include "stream.h"
+
+namespace ose4g
+{
+    namespace detail
+    {
+        inline constexpr unsigned char NAME_START = 1;
+        inline constexpr unsigned char NAME_PART = 2;
+
+        // what each byte may be in a command name, built at compile time
+        inline constexpr std::array<unsigned char, 256> NAME_CHARACTERS = []
+        {
+            std::array<unsigned char, 256> table{};
+            for (char c = 'a'; c <= 'z'; c++)
+            {
+                table[static_cast<unsigned char>(c)] = table[static_cast<unsigned char>(c - 'a' + 'A')] = NAME_START | NAME_PART;
+            }
+            for (char c = '0'; c <= '9'; c++)
+            {
+                table[static_cast<unsigned char>(c)] = NAME_PART;
+            }
+            table['-'] = NAME_PART;
+            return table;
+        }();
+    }
+
+    /**
+     * @brief true if name can be a command or subcommand name.
+     *
+     * A name starts with a letter and has only letters, digits and -.
+     */
+    constexpr bool isValidName(std::string_view name)
+    {
+        if (name.empty() || !(detail::NAME_CHARACTERS[static_cast<unsigned char>(name[0])] & detail::NAME_START))
+        {
+            return false;
+        }
+        for (char c : name.substr(1))
+        {
+            if (!(detail::NAME_CHARACTERS[static_cast<unsigned char>(c)] & detail::NAME_PART))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(isValidName("send-2") && !isValidName("2send") && !isValidName("send command") && !isValidName(""));
+
+    /// @brief per command settings given to add
+    struct CommandOptions
+    {
+        /// time the handler gets before it is asked to stop, zero uses the processor's default
+        std::chrono::milliseconds timeout{0};
+        /// how long output is reused for the same arguments, zero disables caching
+        std::chrono::milliseconds cacheTtl{0};
+        /// most argument lists remembered when cached
+        std::size_t cacheSize = 1024;
+        /// cached commands cleared after this one succeeds, e.g. a write clearing its reads
+        std::vector<CommandPath> invalidates;
+    };
+
+    /// @brief everything registered for one command, immutable once published
+    struct CommandEntry
+    {
+        /// handlers that take no stop_token are wrapped
+        using Processor = std::function<void(const Args &, std::stop_token)>;
+
+        /// all empty for a group that only holds subcommands
+        Processor processor;
+        std::function<Stream(const Args &)> streamProcessor;
+        /// set for aliases, the commands they run are looked up when called
+        std::shared_ptr<const Macro> macro;
+        std::string description;
+        std::vector<Rule *> rules;
+        CommandOptions options;
+        /// set when options.cacheTtl is, the cache itself is not immutable
+        std::shared_ptr<ResultCache> cache;
+        /// next level of the command tree, ordered for help and completion
+        CountedMap<Command, std::shared_ptr<const CommandEntry>> subcommands{CountingAllocator<char>(MemoryCategory::REGISTRY)};
+
+        /// @brief true if the entry has a handler, false for groups
+        bool runnable() const { return processor || streamProcessor || macro; }
+    };
+
+    /**
+     * @brief Command registry that can change while commands are being dispatched.
+     *
+     * Readers see an immutable Snapshot through a single atomic pointer load
+     * and never take a lock. Writers copy the snapshot, change the copy and
+     * swap it in, the old one is freed with rcuRetire once no reader can
+     * still be looking at it. The command table, the completion trie and the
+     * suggestion tree all share their nodes between snapshots, so a copy
+     * costs a few pointers and a change copies only the nodes it touches,
+     * however many commands there are. Entries and the tables holding them
+     * are counted as MemoryCategory::REGISTRY.
+     */
+    class CommandRegistry
+    {
+    public:
+        struct Snapshot
+        {
+            HashTrie<std::shared_ptr<const CommandEntry>> commands{MemoryCategory::REGISTRY};
+            AutoComplete autocomplete;
+            /// top level names, for suggestions when a command is not found
+            BkTree names;
+
+            /**
+             * @brief adds entry at path, creating empty groups on the way.
+             *
+             * An entry without a processor only sets the description of the
+             * node. Nodes along the path are copied, the rest of the tree is shared.
+             *
+             * @throws std::invalid_argument if the node already has a processor
+             */
+            void insert(const CommandPath &path, const CommandEntry &entry);
+
+            /**
+             * @brief inserts many entries, see insert.
+             *
+             * The completion and suggestion indexes are updated once for all
+             * the new names.
+             *
+             * @throws std::invalid_argument if any node already has a processor
+             */
+            void insertAll(const std::vector<std::pair<CommandPath, CommandEntry>> &entries);
+
+            /**
+             * @brief removes the node at path and all its subcommands
+             *
+             * @throws std::invalid_argument if there is no such node
+             */
+            void erase(const CommandPath &path);
+        };
+
+    private:
+        std::atomic<const Snapshot *> d_current;
+        std::mutex d_writeMutex;
+
+    public:
+        CommandRegistry();
+        ~CommandRegistry();
+
+        CommandRegistry(const CommandRegistry &) = delete;
+        CommandRegistry &operator=(const CommandRegistry &) = delete;
+
+        /**
+         * @brief the current snapshot, only valid while an RcuReadGuard is held
+         */
+        const Snapshot &current() const { return *d_current.load(std::memory_order_acquire); }
+
+        /**
+         * @brief looks up a command. The entry stays valid after the command is removed.
+         *
+         * @returns the entry or nullptr if the command is not registered
+         */
+        std::shared_ptr<const CommandEntry> find(const Command &command) const;
+
+        /**
+         * @brief copies the current snapshot, applies mutate to the copy and publishes it.
+         *
+         * Writers are serialised with each other but never block readers.
+         * Nothing is published if mutate throws. The replaced snapshot is
+         * freed by a later update, by rcuReclaim or with the registry, once
+         * no reader can see it.
+         */
+        template <typename Mutate>
+        void update(Mutate &&mutate)
+        {
+            std::lock_guard<std::mutex> lock(d_writeMutex);
+            auto next = std::make_unique<Snapshot>(*d_current.load());
+            mutate(*next);
+            rcuRetire(d_current.exchange(next.release(), std::memory_order_acq_rel));
+        }
+    };
+}
+
+#endif
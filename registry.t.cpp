@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "registry.h"
+
+TEST(CommandRegistryTest, readersShouldKeepTheirSnapshotWhileWritersPublish)
+{
+    ose4g::CommandRegistry registry;
+    registry.update([](ose4g::CommandRegistry::Snapshot &snapshot)
+                    { snapshot.commands.set("first", std::make_shared<const ose4g::CommandEntry>()); });
+
+    ose4g::RcuReadGuard guard;
+    auto &before = registry.current();
+    registry.update([](ose4g::CommandRegistry::Snapshot &snapshot)
+                    { snapshot.commands.erase("first"); });
+
+    EXPECT_TRUE(before.commands.contains("first"));
+    EXPECT_FALSE(registry.current().commands.contains("first"));
+    EXPECT_EQ(registry.find("first"), nullptr);
+}
+
+TEST(CommandRegistryTest, failedUpdateShouldPublishNothing)
+{
+    ose4g::CommandRegistry registry;
+    EXPECT_THROW(registry.update([](ose4g::CommandRegistry::Snapshot &snapshot)
+                                 {
+        snapshot.commands.set("first", std::make_shared<const ose4g::CommandEntry>());
+        throw std::invalid_argument("rejected"); }),
+                 std::invalid_argument);
+    EXPECT_EQ(registry.find("first"), nullptr);
+}
+
+TEST(CommandRegistryTest, retiredObjectsShouldBeFreedAfterReadersLeave)
+{
+    std::atomic<bool> freed = false;
+    {
+        ose4g::RcuReadGuard guard;
+        ose4g::rcuRetire([&freed]
+                         { freed = true; });
+        EXPECT_FALSE(freed);
+    }
+    // reclamation happens on the next retire
+    ose4g::rcuRetire([] {});
+    EXPECT_TRUE(freed);
+
+    // or when asked for
+    freed = false;
+    {
+        ose4g::RcuReadGuard guard;
+        ose4g::rcuRetire([&freed]
+                         { freed = true; });
+    }
+    EXPECT_FALSE(freed);
+    ose4g::rcuReclaim();
+    EXPECT_TRUE(freed);
+}
+
+TEST(CommandRegistryTest, concurrentWritersAndReadersShouldNotRace)
+{
+    ose4g::CommandRegistry registry;
+    std::atomic<bool> done = false;
+    // every entry is described by its own name, a reader seeing anything else saw a half built entry
+    std::thread writer([&]
+                       {
+        for (int i = 0; i < 2000; i++)
+        {
+            auto name = "command" + std::to_string(i % 50);
+            registry.update([&](ose4g::CommandRegistry::Snapshot &snapshot)
+                            {
+                if (!snapshot.commands.erase(name))
+                {
+                    auto entry = std::make_shared<ose4g::CommandEntry>();
+                    entry->description = name;
+                    snapshot.commands.set(name, std::move(entry));
+                } });
+        }
+        done = true; });
+
+    long lookups = 0;
+    long mismatches = 0;
+    // the writer may finish before the reader gets going, it still reads the end result once
+    do
+    {
+        {
+            ose4g::RcuReadGuard guard;
+            auto &snapshot = registry.current();
+            std::size_t seen = 0;
+            for (auto &command : snapshot.commands)
+            {
+                mismatches += !command.second || command.second->description != command.first;
+                seen++;
+            }
+            // a snapshot never changes while it is being read
+            mismatches += seen != snapshot.commands.size();
+            mismatches += seen > 50;
+        }
+        auto name = "command" + std::to_string(lookups % 50);
+        auto entry = registry.find(name);
+        mismatches += entry && entry->description != name;
+        lookups++;
+    } while (!done);
+    writer.join();
+    EXPECT_GT(lookups, 0);
+    EXPECT_EQ(mismatches, 0);
+
+    // 2000 toggles of 50 names leave each one removed again
+    EXPECT_EQ(registry.current().commands.size(), 0u);
+}
@@ -0,0 +1,112 @@
+#include "replay.h"
+#include "capture.h"
+#include "histogram.h"
+#include "recording.h"
+#include <algorithm>
+#include <thread>
+
+namespace ose4g
+{
+    namespace
+    {
+        double micros(std::chrono::nanoseconds latency)
+        {
+            return std::chrono::duration<double, std::micro>(latency).count();
+        }
+
+        struct CopyResult
+        {
+            LatencyHistogram latencies;
+            std::uint64_t failures = 0;
+            std::uint64_t mismatches = 0;
+        };
+
+        void replayCopy(CommandProcessorImpl &processor, const RecordingReader &reader, const ReplayOptions &options,
+                        std::chrono::steady_clock::time_point start, CopyResult &result)
+        {
+            std::string discarded;
+            OutputCapture capture(discarded);
+            RecordingReader::Record record;
+            for (auto offset = reader.read(reader.begin(), record); offset != 0; offset = reader.read(offset, record))
+            {
+                Command command(record.command);
+                // built ins change the processor's own session, which the copies share
+                if (processor.reachesBuiltin(command))
+                {
+                    continue;
+                }
+                if (options.originalTiming)
+                {
+                    std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.start));
+                }
+
+                Args args = record.args();
+                bool ok = true;
+                auto started = std::chrono::steady_clock::now();
+                try
+                {
+                    processor.process(command, std::move(args));
+                }
+                catch (...)
+                {
+                    ok = false;
+                }
+                auto finished = std::chrono::steady_clock::now();
+                result.latencies.record(finished - started);
+                result.failures += !ok;
+                result.mismatches += ok != record.ok;
+                discarded.clear();
+            }
+        }
+    }
+
+    ReplayReport replay(CommandProcessorImpl &processor, const std::string &path, const ReplayOptions &options)
+    {
+        RecordingReader reader(path);
+        int copies = std::max(1, options.copies);
+        std::vector<CopyResult> results(copies);
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 1; i < copies; i++)
+        {
+            threads.emplace_back([&, i]
+                                 { replayCopy(processor, reader, options, start, results[i]); });
+        }
+        replayCopy(processor, reader, options, start, results[0]);
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        ReplayReport report;
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LatencyHistogram latencies;
+        for (auto &result : results)
+        {
+            latencies.merge(result.latencies);
+            report.failures += result.failures;
+            report.mismatches += result.mismatches;
+        }
+        report.commands = latencies.count();
+        report.throughput = report.seconds > 0 ? report.commands / report.seconds : 0;
+        report.p50 = micros(latencies.percentile(0.50));
+        report.p90 = micros(latencies.percentile(0.90));
+        report.p99 = micros(latencies.percentile(0.99));
+        report.max = micros(latencies.max());
+        return report;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const ReplayReport &report)
+    {
+        return out << "commands:     " << report.commands << "\n"
+                   << "failures:     " << report.failures << "\n"
+                   << "mismatches:   " << report.mismatches << "\n"
+                   << "elapsed:      " << report.seconds << " s\n"
+                   << "throughput:   " << static_cast<long>(report.throughput) << " commands/s\n"
+                   << "latency p50:  " << report.p50 << " us\n"
+                   << "latency p90:  " << report.p90 << " us\n"
+                   << "latency p99:  " << report.p99 << " us\n"
+                   << "latency max:  " << report.max << " us\n";
+    }
+}
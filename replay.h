@@ -0,0 +1,50 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include "command-processor.h"
+
+namespace ose4g
+{
+    struct ReplayOptions
+    {
+        /// keep the gaps between commands from the recording, otherwise replay as fast as possible
+        bool originalTiming = false;
+        /// number of copies of the recording replayed in parallel, one thread each
+        int copies = 1;
+    };
+
+    struct ReplayReport
+    {
+        std::uint64_t commands = 0;
+        std::uint64_t failures = 0;
+        /// commands whose success or failure differs from the recording
+        std::uint64_t mismatches = 0;
+        double seconds = 0;
+        double throughput = 0;
+        /// latencies in microseconds, percentiles within 1% of the measured ones
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    /**
+     * @brief Feeds a recording made with CommandProcessorImpl::record back through process().
+     *
+     * Built in commands and aliases that run one are skipped and handler
+     * output is discarded. The recording is read through a memory map,
+     * copies share the mapping. Latencies in the report are in microseconds.
+     *
+     * @param processor processor with the handlers to exercise
+     * @param path recording to replay
+     * @param options timing and parallelism
+     */
+    ReplayReport replay(CommandProcessorImpl &processor, const std::string &path, const ReplayOptions &options = {});
+
+    /// @brief prints a report in a human readable form
+    std::ostream &operator<<(std::ostream &out, const ReplayReport &report);
+}
+
+#endif
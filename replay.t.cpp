@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <unistd.h>
+#include "replay.h"
+
+class ReplayTest : public testing::Test
+{
+public:
+    std::string path = "/tmp/command-processor-replay-" + std::to_string(getpid()) + ".log";
+
+    void SetUp() override
+    {
+        ose4g::SessionRecorder recorder(path);
+        auto now = std::chrono::steady_clock::now();
+        recorder.record("count", {"1"}, now, {}, true, "");
+        recorder.record("help", {}, now, {}, true, "");
+        recorder.record("alias", {"again", "=", "count", "3"}, now, {}, true, "");
+        recorder.record("count", {"2"}, now + std::chrono::milliseconds(20), {}, true, "");
+        recorder.record("missing", {}, now, {}, false, "Command missing not found");
+    }
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+    }
+};
+
+TEST_F(ReplayTest, shouldReplayEveryCopyThroughProcess)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    std::atomic<int> total = 0;
+    cp.add("count", [&](const ose4g::Args &args)
+           { total += std::stoi(args[0]); });
+
+    auto report = ose4g::replay(cp, path, {.copies = 4});
+    EXPECT_EQ(total, 12);
+    EXPECT_EQ(report.commands, 12);
+    EXPECT_EQ(report.failures, 4);
+    EXPECT_EQ(report.mismatches, 0);
+}
+
+TEST_F(ReplayTest, shouldReportMismatchesAndKeepOriginalTiming)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    cp.add("count", [](const ose4g::Args &)
+           { throw std::runtime_error("backend down"); });
+
+    auto report = ose4g::replay(cp, path, {.originalTiming = true});
+    EXPECT_EQ(report.commands, 3);
+    EXPECT_EQ(report.mismatches, 2);
+    EXPECT_GE(report.seconds, 0.02);
+}
+
+TEST_F(ReplayTest, aliasesRunningBuiltinsShouldBeSkipped)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    std::atomic<int> total = 0;
+    cp.add("count", [&](const ose4g::Args &args)
+           { total += std::stoi(args[0]); });
+    cp.defineAlias("leave", "count 100; exit");
+    cp.defineAlias("outer", "count 10; leave");
+    cp.defineAlias("plain", "count 1");
+    {
+        ose4g::SessionRecorder recorder(path);
+        auto now = std::chrono::steady_clock::now();
+        recorder.record("outer", {}, now, {}, true, "");
+        recorder.record("plain", {}, now, {}, true, "");
+    }
+
+    auto report = ose4g::replay(cp, path, {.copies = 3});
+    EXPECT_EQ(total, 3);
+    EXPECT_EQ(report.commands, 3);
+    EXPECT_TRUE(cp.reachesBuiltin("outer"));
+    EXPECT_FALSE(cp.reachesBuiltin("plain"));
+}
@@ -0,0 +1,122 @@
+#include "resultcache.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace ose4g
+{
+    namespace
+    {
+        constexpr std::size_t MAX_SHARDS = 16;
+    }
+
+    ResultCache::ResultCache(std::chrono::milliseconds ttl, std::size_t capacity)
+        : d_ttl(ttl), d_shardCount(std::clamp<std::size_t>(capacity, 1, MAX_SHARDS)),
+          d_shardCapacity((capacity + d_shardCount - 1) / d_shardCount), d_shards(std::make_unique<Shard[]>(d_shardCount))
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument("cache size must be positive");
+        }
+    }
+
+    std::string ResultCache::key(const Args &args)
+    {
+        std::size_t length = 0;
+        for (auto &arg : args)
+        {
+            length += arg.size() + 1;
+        }
+        std::string key;
+        key.reserve(length + args.size() * 4);
+        for (auto &arg : args)
+        {
+            key += std::to_string(arg.size());
+            key += ':';
+            key += arg;
+        }
+        return key;
+    }
+
+    ResultCache::Shard &ResultCache::shardFor(std::string_view key)
+    {
+        return d_shards[std::hash<std::string_view>{}(key) % d_shardCount];
+    }
+
+    bool ResultCache::lookup(const std::string &key, std::ostream &out)
+    {
+        auto &shard = shardFor(key);
+        std::shared_ptr<const std::string> output;
+        {
+            std::lock_guard lock(shard.mutex);
+            auto found = shard.index.find(key);
+            if (found != shard.index.end())
+            {
+                auto item = found->second;
+                if (item->expires > Clock::now())
+                {
+                    shard.items.splice(shard.items.begin(), shard.items, item);
+                    output = item->output;
+                }
+                else
+                {
+                    shard.index.erase(found);
+                    shard.items.erase(item);
+                }
+            }
+        }
+        if (!output)
+        {
+            d_misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // out may be slow, e.g. a paused pager or a client socket, other keys in the shard do not wait for it
+        out << *output;
+        d_hits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void ResultCache::insert(std::string key, std::string output)
+    {
+        auto &shard = shardFor(key);
+        auto expires = Clock::now() + d_ttl;
+        auto shared = std::make_shared<const std::string>(std::move(output));
+        std::lock_guard lock(shard.mutex);
+        auto found = shard.index.find(key);
+        if (found != shard.index.end())
+        {
+            found->second->output = std::move(shared);
+            found->second->expires = expires;
+            shard.items.splice(shard.items.begin(), shard.items, found->second);
+            return;
+        }
+        if (shard.items.size() >= d_shardCapacity)
+        {
+            shard.index.erase(shard.items.back().key);
+            shard.items.pop_back();
+            d_evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        shard.items.push_front(Item{std::move(key), std::move(shared), expires});
+        shard.index.emplace(shard.items.front().key, shard.items.begin());
+    }
+
+    void ResultCache::clear()
+    {
+        for (std::size_t i = 0; i < d_shardCount; i++)
+        {
+            std::lock_guard lock(d_shards[i].mutex);
+            d_shards[i].index.clear();
+            d_shards[i].items.clear();
+        }
+    }
+
+    ResultCache::Stats ResultCache::stats() const
+    {
+        Stats stats{d_hits.load(), d_misses.load(), d_evictions.load(), 0};
+        for (std::size_t i = 0; i < d_shardCount; i++)
+        {
+            std::lock_guard lock(d_shards[i].mutex);
+            stats.size += d_shards[i].items.size();
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "rule.h"
+
+namespace ose4g
+{
+    /**
+     * @brief Output of a command remembered per argument list.
+     *
+     * Entries live for a fixed time and the least recently used ones are
+     * evicted once the cache is full. Keys are spread over shards with their
+     * own lock so concurrent sessions rarely wait on each other.
+     */
+    class ResultCache
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct Stats
+        {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+            std::size_t size = 0;
+        };
+
+        ResultCache(std::chrono::milliseconds ttl, std::size_t capacity);
+
+        /// @brief key for an argument list, arguments are length prefixed so no two lists share a key
+        static std::string key(const Args &args);
+
+        /**
+         * @brief writes the cached output for key to out.
+         *
+         * @returns false, counting a miss, if there is no live entry.
+         */
+        bool lookup(const std::string &key, std::ostream &out);
+
+        /// @brief stores output for key, replacing any previous entry
+        void insert(std::string key, std::string output);
+
+        /// @brief drops every entry
+        void clear();
+
+        Stats stats() const;
+
+    private:
+        struct Item
+        {
+            std::string key;
+            // shared so a hit can be written out after the shard is unlocked
+            std::shared_ptr<const std::string> output;
+            Clock::time_point expires;
+        };
+
+        struct Shard
+        {
+            std::mutex mutex;
+            // most recently used first
+            std::list<Item> items;
+            // views into the keys of items, list nodes never move
+            std::unordered_map<std::string_view, std::list<Item>::iterator> index;
+        };
+
+        std::chrono::milliseconds d_ttl;
+        std::size_t d_shardCount;
+        std::size_t d_shardCapacity;
+        std::unique_ptr<Shard[]> d_shards;
+        std::atomic<std::uint64_t> d_hits{0};
+        std::atomic<std::uint64_t> d_misses{0};
+        std::atomic<std::uint64_t> d_evictions{0};
+
+        Shard &shardFor(std::string_view key);
+    };
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include "resultcache.h"
+
+using namespace std::chrono_literals;
+
+TEST(ResultCacheTest, shouldReplayStoredOutput)
+{
+    ose4g::ResultCache cache(1min, 8);
+    std::ostringstream out;
+    auto key = ose4g::ResultCache::key({"a", "b"});
+    EXPECT_FALSE(cache.lookup(key, out));
+    cache.insert(key, "result\n");
+    EXPECT_TRUE(cache.lookup(key, out));
+    EXPECT_EQ(out.str(), "result\n");
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.size, 1u);
+}
+
+TEST(ResultCacheTest, keysShouldNotCollideAcrossArgumentBoundaries)
+{
+    EXPECT_NE(ose4g::ResultCache::key({"ab", "c"}), ose4g::ResultCache::key({"a", "bc"}));
+    EXPECT_NE(ose4g::ResultCache::key({"a b"}), ose4g::ResultCache::key({"a", "b"}));
+}
+
+TEST(ResultCacheTest, expiredEntriesShouldMiss)
+{
+    ose4g::ResultCache cache(10ms, 8);
+    std::ostringstream out;
+    cache.insert("k", "old");
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(cache.lookup("k", out));
+    EXPECT_EQ(cache.stats().size, 0u);
+}
+
+TEST(ResultCacheTest, shouldEvictLeastRecentlyUsed)
+{
+    // a single shard so the order is deterministic
+    ose4g::ResultCache cache(1min, 1);
+    std::ostringstream out;
+    cache.insert("first", "1");
+    cache.insert("second", "2");
+    EXPECT_FALSE(cache.lookup("first", out));
+    EXPECT_TRUE(cache.lookup("second", out));
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    cache.clear();
+    EXPECT_EQ(cache.stats().size, 0u);
+}
+
+TEST(ResultCacheTest, aSlowReaderShouldNotHoldUpTheShard)
+{
+    // takes the output only once released
+    struct BlockedBuffer : std::streambuf
+    {
+        std::promise<void> writing;
+        std::shared_future<void> released;
+
+        std::streamsize xsputn(const char *, std::streamsize count) override
+        {
+            writing.set_value();
+            released.wait();
+            return count;
+        }
+    };
+    ose4g::ResultCache cache(1min, 1);
+    cache.insert("slow", "1");
+
+    std::promise<void> release;
+    BlockedBuffer buffer;
+    buffer.released = release.get_future().share();
+    std::ostream blocked(&buffer);
+    std::thread reader([&]
+                       { cache.lookup("slow", blocked); });
+    buffer.writing.get_future().wait();
+
+    auto other = std::async(std::launch::async, [&]
+                            {
+        std::ostringstream out;
+        cache.lookup("slow", out);
+        cache.insert("new", "2");
+        return out.str(); });
+    bool finished = other.wait_for(5s) == std::future_status::ready;
+    release.set_value();
+    reader.join();
+    ASSERT_TRUE(finished);
+    EXPECT_EQ(other.get(), "1");
+}
@@ -0,0 +1,60 @@
+#ifndef RULE_H
+#define RULE_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ose4g
+{
+    using Args = std::vector<std::string>;
+    using Command = std::string;
+    /// path to a nested subcommand, e.g. {"cluster", "node", "drain"}
+    using CommandPath = std::vector<Command>;
+
+    /**
+     * Rule class for validation of arguments
+     */
+    class Rule
+    {
+    public:
+        /// apply validation rule on arguments
+        virtual std::pair<bool, std::string> apply(ose4g::Args &args) = 0;
+    };
+
+    /**
+     * @tparam MIN_ARG_COUNT minimum argument count
+     * @tparam MAX_ARG_COUNT maximum argument count
+     */
+    template <int MIN_ARG_COUNT = 1, int MAX_ARG_COUNT = 10>
+    class ArgCountRule : public Rule
+    {
+    public:
+        std::pair<bool, std::string> apply(Args &args)
+        {
+            bool valid = MIN_ARG_COUNT <= args.size() && args.size() <= MAX_ARG_COUNT;
+            std::string message = "";
+            if (!valid)
+            {
+                message = "Number of arguments should be between " + std::to_string(MIN_ARG_COUNT) + " and " + std::to_string(MAX_ARG_COUNT) + " But got " + std::to_string(args.size());
+            }
+            return {valid, message};
+        }
+    };
+
+    /// @brief User defined rule to apply args
+    class UserRule : public Rule
+    {
+    private:
+        std::function<std::pair<bool, std::string>(const Args &)> f;
+
+    public:
+        UserRule(std::function<std::pair<bool, std::string>(const Args &)> func) : f(func) {}
+        std::pair<bool, std::string> apply(Args &args)
+        {
+            return f(args);
+        }
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "scheduler.h"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+
+namespace ose4g
+{
+    Scheduler::Scheduler(std::size_t runners, std::chrono::milliseconds resolution)
+        : d_resolution(std::max(resolution, std::chrono::milliseconds(1))), d_runnerCount(std::max<std::size_t>(runners, 1)), d_epoch(Clock::now())
+    {
+    }
+
+    Scheduler::~Scheduler()
+    {
+        {
+            std::lock_guard lock(d_mutex);
+            d_stopping = true;
+        }
+        d_wakeup.notify_one();
+        d_ready.notify_all();
+        if (d_timer.joinable())
+        {
+            d_timer.join();
+        }
+        for (auto &runner : d_runners)
+        {
+            runner.join();
+        }
+    }
+
+    std::uint64_t Scheduler::tick(Clock::time_point time) const
+    {
+        return (time - d_epoch) / d_resolution;
+    }
+
+    Scheduler::Id Scheduler::add(std::string name, std::chrono::milliseconds period, Job job, Overrun overrun)
+    {
+        if (period.count() <= 0)
+        {
+            throw std::invalid_argument("period must be positive");
+        }
+        auto entry = std::make_shared<Entry>();
+        entry->info.name = std::move(name);
+        entry->info.period = period;
+        entry->info.overrun = overrun;
+        entry->job = std::move(job);
+        Id id;
+        {
+            std::lock_guard lock(d_mutex);
+            // most processors never schedule anything, so only start the threads when something is
+            if (!d_timer.joinable())
+            {
+                d_timer = std::thread([this]
+                                      { loop(); });
+                for (std::size_t i = 0; i < d_runnerCount; i++)
+                {
+                    d_runners.emplace_back([this]
+                                           { run(); });
+                }
+            }
+            id = d_nextId++;
+            entry->info.id = id;
+            // the wheel may lag behind the clock while the timer thread sleeps, due now means its next advance
+            entry->expiry = tick(Clock::now());
+            entry->timer = d_wheel.schedule(entry->expiry, [this, entry]
+                                            { due(entry); });
+            d_entries.emplace(id, std::move(entry));
+        }
+        d_wakeup.notify_one();
+        return id;
+    }
+
+    bool Scheduler::cancel(Id id)
+    {
+        std::lock_guard lock(d_mutex);
+        auto found = d_entries.find(id);
+        if (found == d_entries.end())
+        {
+            return false;
+        }
+        d_wheel.cancel(found->second->timer);
+        found->second->cancelled = true;
+        found->second->pending = false;
+        d_entries.erase(found);
+        return true;
+    }
+
+    std::size_t Scheduler::clear()
+    {
+        std::lock_guard lock(d_mutex);
+        std::size_t count = d_entries.size();
+        for (auto &[id, entry] : d_entries)
+        {
+            d_wheel.cancel(entry->timer);
+            entry->cancelled = true;
+            entry->pending = false;
+        }
+        d_entries.clear();
+        return count;
+    }
+
+    std::vector<Scheduler::Info> Scheduler::list() const
+    {
+        std::lock_guard lock(d_mutex);
+        std::vector<Info> infos;
+        infos.reserve(d_entries.size());
+        for (auto &[id, entry] : d_entries)
+        {
+            infos.push_back(entry->info);
+        }
+        return infos;
+    }
+
+    std::size_t Scheduler::size() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_entries.size();
+    }
+
+    // timer callbacks run on the timer thread with the mutex held
+    void Scheduler::due(const std::shared_ptr<Entry> &entry)
+    {
+        // fixed rate, runs the timer thread was too late for are skipped rather than run back to back
+        std::uint64_t period = std::max<std::uint64_t>((entry->info.period + d_resolution - std::chrono::milliseconds(1)) / d_resolution, 1);
+        std::uint64_t missed = (d_wheel.now() - entry->expiry) / period;
+        entry->info.skipped += missed;
+        entry->expiry += (missed + 1) * period;
+        entry->timer = d_wheel.schedule(entry->expiry, [this, entry]
+                                        { due(entry); });
+
+        if (entry->info.running)
+        {
+            if (entry->info.overrun == Overrun::COALESCE && !entry->pending)
+            {
+                entry->pending = true;
+            }
+            else
+            {
+                entry->info.skipped++;
+            }
+            return;
+        }
+        entry->info.running = true;
+        d_queue.push_back(entry);
+        d_ready.notify_one();
+    }
+
+    void Scheduler::loop()
+    {
+        std::unique_lock lock(d_mutex);
+        while (!d_stopping)
+        {
+            d_wheel.advance(tick(Clock::now()));
+            auto next = d_wheel.nextWakeup();
+            if (next)
+            {
+                d_wakeup.wait_until(lock, d_epoch + d_resolution * *next);
+            }
+            else
+            {
+                d_wakeup.wait(lock);
+            }
+        }
+    }
+
+    void Scheduler::run()
+    {
+        std::unique_lock lock(d_mutex);
+        while (true)
+        {
+            d_ready.wait(lock, [this]
+                         { return d_stopping || !d_queue.empty(); });
+            if (d_stopping)
+            {
+                return;
+            }
+            auto entry = std::move(d_queue.front());
+            d_queue.pop_front();
+            if (entry->cancelled)
+            {
+                entry->info.running = false;
+                continue;
+            }
+
+            lock.unlock();
+            try
+            {
+                entry->job();
+            }
+            catch (const std::exception &exc)
+            {
+                std::cerr << "scheduler: '" << entry->info.name << "' failed: " << exc.what() << std::endl;
+            }
+            lock.lock();
+
+            entry->info.runs++;
+            if (entry->pending && !entry->cancelled)
+            {
+                entry->pending = false;
+                d_queue.push_back(entry);
+            }
+            else
+            {
+                entry->info.running = false;
+            }
+        }
+    }
+
+    std::chrono::milliseconds parseDuration(std::string_view text)
+    {
+        std::uint64_t value = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end == text.data())
+        {
+            throw std::invalid_argument("invalid period '" + std::string(text) + "', expected e.g. 500ms, 5s, 2m or 1h");
+        }
+        std::string_view unit(end, text.data() + text.size() - end);
+        std::uint64_t scale;
+        if (unit == "ms")
+        {
+            scale = 1;
+        }
+        else if (unit.empty() || unit == "s")
+        {
+            scale = 1000;
+        }
+        else if (unit == "m")
+        {
+            scale = 60 * 1000;
+        }
+        else if (unit == "h")
+        {
+            scale = 60 * 60 * 1000;
+        }
+        else
+        {
+            throw std::invalid_argument("invalid period '" + std::string(text) + "', expected e.g. 500ms, 5s, 2m or 1h");
+        }
+        // a year is plenty and keeps the tick arithmetic far from overflowing
+        if (value == 0 || value > 365ull * 24 * 60 * 60 * 1000 / scale)
+        {
+            throw std::invalid_argument("period '" + std::string(text) + "' must be more than zero and at most a year");
+        }
+        return std::chrono::milliseconds(value * scale);
+    }
+
+    std::string formatDuration(std::chrono::milliseconds duration)
+    {
+        auto ms = duration.count();
+        if (ms % (60 * 60 * 1000) == 0)
+        {
+            return std::to_string(ms / (60 * 60 * 1000)) + "h";
+        }
+        if (ms % (60 * 1000) == 0)
+        {
+            return std::to_string(ms / (60 * 1000)) + "m";
+        }
+        if (ms % 1000 == 0)
+        {
+            return std::to_string(ms / 1000) + "s";
+        }
+        return std::to_string(ms) + "ms";
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "timerwheel.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace ose4g
+{
+    /**
+     * @brief Runs jobs periodically from background threads.
+     *
+     * Due times are kept in a TimerWheel ticking at the scheduler's
+     * resolution, the timer thread only sleeps until the next slot that can
+     * hold a due job, so neither a tick nor a wakeup gets more expensive
+     * with the number of jobs. Jobs are handed to a small pool of runner
+     * threads, a slow job never delays the timer or the others.
+     *
+     * A job runs once when added and then at a fixed rate. A run that comes
+     * due while the previous one is still going is skipped, or with
+     * Overrun::COALESCE all such runs are folded into one that starts as
+     * soon as the previous run returns.
+     */
+    class Scheduler
+    {
+    public:
+        using Id = std::uint64_t;
+        using Clock = std::chrono::steady_clock;
+        using Job = std::function<void()>;
+
+        /// @brief what happens to runs that come due while the job is still running
+        enum class Overrun
+        {
+            SKIP,
+            COALESCE
+        };
+
+        struct Info
+        {
+            Id id = 0;
+            std::string name;
+            std::chrono::milliseconds period{0};
+            Overrun overrun = Overrun::SKIP;
+            std::uint64_t runs = 0;
+            /// due runs that never started, because the job was still running or the scheduler fell behind
+            std::uint64_t skipped = 0;
+            bool running = false;
+        };
+
+        /**
+         * @param runners threads running jobs, at least one.
+         * @param resolution length of a tick, periods are rounded up to whole ticks.
+         */
+        explicit Scheduler(std::size_t runners = 2, std::chrono::milliseconds resolution = std::chrono::milliseconds(10));
+        ~Scheduler();
+
+        Scheduler(const Scheduler &) = delete;
+        Scheduler &operator=(const Scheduler &) = delete;
+
+        /**
+         * @brief runs job now and then every period until cancelled.
+         *
+         * @param name shown by list.
+         * @throws std::invalid_argument if period is not positive.
+         */
+        Id add(std::string name, std::chrono::milliseconds period, Job job, Overrun overrun = Overrun::SKIP);
+
+        /**
+         * @brief stops a job from being run again, a run already going is left to finish.
+         *
+         * @returns false if there is no such job.
+         */
+        bool cancel(Id id);
+
+        /// @brief cancels every job, returns how many there were
+        std::size_t clear();
+
+        /// @brief every job in the order they were added
+        std::vector<Info> list() const;
+
+        std::size_t size() const;
+
+    private:
+        struct Entry
+        {
+            Info info;
+            Job job;
+            TimerWheel::Id timer = 0;
+            std::uint64_t expiry = 0;
+            bool pending = false;
+            bool cancelled = false;
+        };
+
+        std::chrono::milliseconds d_resolution;
+        std::size_t d_runnerCount;
+        Clock::time_point d_epoch;
+        mutable std::mutex d_mutex;
+        std::condition_variable d_wakeup;
+        std::condition_variable d_ready;
+        TimerWheel d_wheel;
+        std::map<Id, std::shared_ptr<Entry>> d_entries;
+        std::deque<std::shared_ptr<Entry>> d_queue;
+        Id d_nextId = 1;
+        bool d_stopping = false;
+        std::thread d_timer;
+        std::vector<std::thread> d_runners;
+
+        std::uint64_t tick(Clock::time_point time) const;
+        void due(const std::shared_ptr<Entry> &entry);
+        void loop();
+        void run();
+    };
+
+    /**
+     * @brief parses a period such as 500ms, 5s, 2m or 1h, a bare number is seconds.
+     *
+     * @throws std::invalid_argument if text is not a positive period.
+     */
+    std::chrono::milliseconds parseDuration(std::string_view text);
+
+    /// @brief the shortest text parseDuration reads back as duration
+    std::string formatDuration(std::chrono::milliseconds duration);
+}
+
+#endif
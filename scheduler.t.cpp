@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+#include "scheduler.h"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    template <typename Predicate>
+    bool eventually(Predicate predicate)
+    {
+        for (int i = 0; i < 200 && !predicate(); i++)
+        {
+            std::this_thread::sleep_for(5ms);
+        }
+        return predicate();
+    }
+}
+
+TEST(SchedulerTest, shouldRunJobsImmediatelyAndThenPeriodically)
+{
+    ose4g::Scheduler scheduler(1, 1ms);
+    std::atomic<int> runs{0};
+    auto id = scheduler.add("count", 20ms, [&]
+                            { runs++; });
+    EXPECT_TRUE(eventually([&]
+                           { return runs.load() >= 1; }));
+    EXPECT_TRUE(eventually([&]
+                           { return runs.load() >= 4; }));
+
+    auto list = scheduler.list();
+    ASSERT_EQ(list.size(), 1u);
+    EXPECT_EQ(list[0].id, id);
+    EXPECT_EQ(list[0].name, "count");
+    EXPECT_EQ(list[0].period, 20ms);
+
+    EXPECT_TRUE(scheduler.cancel(id));
+    EXPECT_FALSE(scheduler.cancel(id));
+    EXPECT_EQ(scheduler.size(), 0u);
+    std::this_thread::sleep_for(30ms);
+    int after = runs.load();
+    std::this_thread::sleep_for(60ms);
+    EXPECT_EQ(runs.load(), after);
+}
+
+TEST(SchedulerTest, overrunningJobsShouldBeSkipped)
+{
+    ose4g::Scheduler scheduler(2, 1ms);
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+    std::atomic<int> runs{0};
+    auto id = scheduler.add("slow", 10ms, [&]
+                            {
+        maxRunning = std::max(maxRunning.load(), ++running);
+        std::this_thread::sleep_for(55ms);
+        running--;
+        runs++; });
+    EXPECT_TRUE(eventually([&]
+                           { return runs.load() >= 2; }));
+    scheduler.cancel(id);
+    EXPECT_EQ(maxRunning.load(), 1);
+    EXPECT_TRUE(eventually([&]
+                           { return running.load() == 0; }));
+}
+
+TEST(SchedulerTest, coalescedRunsShouldStartWhenThePreviousOneReturns)
+{
+    ose4g::Scheduler scheduler(2, 1ms);
+    std::atomic<int> runs{0};
+    std::latch started(1);
+    std::latch release(1);
+    scheduler.add("blocked", 10ms, [&]
+                  {
+        if (runs++ == 0)
+        {
+            started.count_down();
+            release.wait();
+        } }, ose4g::Scheduler::Overrun::COALESCE);
+
+    // many periods pass while the first run is blocked
+    started.wait();
+    EXPECT_TRUE(eventually([&]
+                           { return scheduler.list()[0].skipped >= 3; }));
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_TRUE(scheduler.list()[0].running);
+
+    release.count_down();
+    EXPECT_TRUE(eventually([&]
+                           { return runs.load() >= 2; }));
+    EXPECT_EQ(scheduler.clear(), 1u);
+    EXPECT_EQ(scheduler.size(), 0u);
+}
+
+TEST(SchedulerTest, failingJobsShouldKeepBeingScheduled)
+{
+    ose4g::Scheduler scheduler(1, 1ms);
+    std::atomic<int> runs{0};
+    scheduler.add("failing", 5ms, [&]
+                  {
+        runs++;
+        throw std::runtime_error("failed"); });
+    EXPECT_TRUE(eventually([&]
+                           { return runs.load() >= 3; }));
+    EXPECT_THROW(scheduler.add("never", 0ms, [] {}), std::invalid_argument);
+}
+
+TEST(SchedulerTest, shouldParseAndFormatDurations)
+{
+    EXPECT_EQ(ose4g::parseDuration("500ms"), 500ms);
+    EXPECT_EQ(ose4g::parseDuration("5s"), 5s);
+    EXPECT_EQ(ose4g::parseDuration("5"), 5s);
+    EXPECT_EQ(ose4g::parseDuration("2m"), 2min);
+    EXPECT_EQ(ose4g::parseDuration("1h"), 1h);
+    EXPECT_THROW(ose4g::parseDuration("0s"), std::invalid_argument);
+    EXPECT_THROW(ose4g::parseDuration("s"), std::invalid_argument);
+    EXPECT_THROW(ose4g::parseDuration("5d"), std::invalid_argument);
+    EXPECT_THROW(ose4g::parseDuration("-5"), std::invalid_argument);
+    EXPECT_THROW(ose4g::parseDuration("100000h"), std::invalid_argument);
+
+    EXPECT_EQ(ose4g::formatDuration(1500ms), "1500ms");
+    EXPECT_EQ(ose4g::formatDuration(5s), "5s");
+    EXPECT_EQ(ose4g::formatDuration(120s), "2m");
+    EXPECT_EQ(ose4g::formatDuration(1h), "1h");
+}
@@ -0,0 +1,399 @@
+#include "server.h"
+#include "capture.h"
+#include "style.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace ose4g
+{
+    namespace
+    {
+        // stop reading from a client that does not read its output
+        constexpr std::size_t MAX_PENDING_OUTPUT = 1 << 20;
+
+        constexpr Style PROMPT_STYLE(Color::GREEN);
+
+        [[noreturn]] void throwSystemError(const char *what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        // a socket has no tty to turn \n into \r\n, do it here so raw clients render properly
+        void appendTerminalOutput(std::string &out, const std::string &text)
+        {
+            char previous = out.empty() ? '\0' : out.back();
+            for (char c : text)
+            {
+                if (c == '\n' && previous != '\r')
+                {
+                    out += '\r';
+                }
+                out += c;
+                previous = c;
+            }
+        }
+    }
+
+    struct Server::Connection
+    {
+        int fd;
+        KeyDecoder decoder;
+        Session session;
+        std::string outbox;
+        std::size_t sent = 0;
+        unsigned events = EPOLLIN;
+        bool closing = false;
+        // the client no longer takes output, what it sent is still run
+        bool hungUp = false;
+
+        Connection(int socket, LineEditor::Completer completer) : fd(socket), session(std::move(completer)) {}
+    };
+
+    Server::Server(CommandProcessorImpl &processor, const ServerOptions &options) : d_processor(processor), d_options(options)
+    {
+        formatStyled(std::back_inserter(d_prompt), styled(processor.d_prompt, PROMPT_STYLE));
+
+        d_epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (d_epoll < 0)
+            throwSystemError("epoll_create1");
+        d_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (d_wakeup < 0)
+            throwSystemError("eventfd");
+        watch(d_wakeup, EPOLLIN, EPOLL_CTL_ADD);
+
+        if (!options.unixPath.empty())
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if (options.unixPath.size() >= sizeof(address.sun_path))
+            {
+                throw std::invalid_argument("unix socket path is too long");
+            }
+            std::strcpy(address.sun_path, options.unixPath.c_str());
+            d_unixListener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (d_unixListener < 0)
+                throwSystemError("socket");
+            // a socket file left behind by a previous run would make bind fail
+            unlink(options.unixPath.c_str());
+            if (bind(d_unixListener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+                throwSystemError("bind");
+            if (listen(d_unixListener, SOMAXCONN) < 0)
+                throwSystemError("listen");
+            watch(d_unixListener, EPOLLIN, EPOLL_CTL_ADD);
+        }
+
+        if (options.tcpPort >= 0)
+        {
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(options.tcpPort);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            d_tcpListener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (d_tcpListener < 0)
+                throwSystemError("socket");
+            int reuse = 1;
+            setsockopt(d_tcpListener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (bind(d_tcpListener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+                throwSystemError("bind");
+            if (listen(d_tcpListener, SOMAXCONN) < 0)
+                throwSystemError("listen");
+            socklen_t length = sizeof(address);
+            getsockname(d_tcpListener, reinterpret_cast<sockaddr *>(&address), &length);
+            d_tcpPort = ntohs(address.sin_port);
+            watch(d_tcpListener, EPOLLIN, EPOLL_CTL_ADD);
+        }
+    }
+
+    Server::~Server()
+    {
+        for (auto &connection : d_connections)
+        {
+            endSchedules(*connection.second);
+            ::close(connection.first);
+        }
+        if (d_unixListener >= 0)
+        {
+            ::close(d_unixListener);
+            unlink(d_options.unixPath.c_str());
+        }
+        if (d_tcpListener >= 0)
+            ::close(d_tcpListener);
+        if (d_wakeup >= 0)
+            ::close(d_wakeup);
+        if (d_epoll >= 0)
+            ::close(d_epoll);
+    }
+
+    void Server::watch(int fd, unsigned events, int op)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(d_epoll, op, fd, &event) < 0)
+            throwSystemError("epoll_ctl");
+    }
+
+    void Server::run()
+    {
+        d_running = true;
+        epoll_event events[256];
+        while (d_running)
+        {
+            int count = epoll_wait(d_epoll, events, 256, -1);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throwSystemError("epoll_wait");
+            }
+            for (int i = 0; i < count; i++)
+            {
+                int fd = events[i].data.fd;
+                if (fd == d_wakeup)
+                {
+                    uint64_t value;
+                    read(d_wakeup, &value, sizeof(value));
+                    showScheduled();
+                    continue;
+                }
+                if (fd == d_unixListener || fd == d_tcpListener)
+                {
+                    accept(fd);
+                    continue;
+                }
+                auto it = d_connections.find(fd);
+                if (it == d_connections.end())
+                {
+                    continue;
+                }
+                Connection &connection = *it->second;
+                // a client that hung up may still have sent lines, they are read before closing
+                if (events[i].events & EPOLLOUT)
+                {
+                    onWritable(connection);
+                }
+                else if (events[i].events & EPOLLIN)
+                {
+                    onReadable(connection);
+                }
+                else if (events[i].events & (EPOLLERR | EPOLLHUP))
+                {
+                    close(connection);
+                }
+            }
+        }
+    }
+
+    void Server::stop()
+    {
+        d_running = false;
+        uint64_t value = 1;
+        write(d_wakeup, &value, sizeof(value));
+    }
+
+    void Server::accept(int listener)
+    {
+        while (true)
+        {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                // EAGAIN once the backlog is drained, anything else is per connection
+                return;
+            }
+            auto connection = std::make_unique<Connection>(fd, [this](const std::string &input)
+                                                           { return d_processor.complete(input); });
+            Connection &added = *connection;
+            added.session.history.setByteLimit(d_processor.d_historyByteLimit.load());
+            added.session.schedules->sink = [this, fd](const std::string &output)
+            {
+                {
+                    std::lock_guard lock(d_scheduledMutex);
+                    d_scheduledOutput.emplace_back(fd, output);
+                }
+                uint64_t value = 1;
+                write(d_wakeup, &value, sizeof(value));
+            };
+            d_connections.emplace(fd, std::move(connection));
+            d_sessionCount = d_connections.size();
+            watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+
+            added.session.editor.render(added.outbox, d_prompt);
+            onWritable(added);
+        }
+    }
+
+    void Server::onReadable(Connection &connection)
+    {
+        char buffer[4096];
+        ssize_t count = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (count == 0)
+        {
+            // the client sent everything, close once it has the output
+            connection.closing = true;
+            onWritable(connection);
+            return;
+        }
+        if (count < 0 && errno != EAGAIN && errno != EINTR)
+        {
+            close(connection);
+            return;
+        }
+
+        LineEditor &editor = connection.session.editor;
+        std::string output;
+        KeyboardInput::Input input;
+        for (ssize_t i = 0; i < count && !connection.closing; i++)
+        {
+            if (!connection.decoder.feed(buffer[i], input))
+            {
+                continue;
+            }
+            switch (editor.feed(input))
+            {
+            case LineEditor::Action::NEWLINE:
+                connection.outbox += "\r\n";
+                break;
+            case LineEditor::Action::CANCEL:
+                connection.outbox += "^C\r\n";
+                break;
+            case LineEditor::Action::SUGGEST:
+                output.clear();
+                editor.renderSuggestions(output);
+                appendTerminalOutput(connection.outbox, output);
+                break;
+            case LineEditor::Action::SUBMIT:
+            {
+                connection.outbox += "\r\n";
+                output.clear();
+                {
+                    OutputCapture capture(output);
+                    d_processor.execute(connection.session, editor.line());
+                }
+                appendTerminalOutput(connection.outbox, output);
+                connection.closing = !connection.session.isRunning;
+                editor.reset();
+                break;
+            }
+            case LineEditor::Action::NONE:
+                break;
+            }
+        }
+
+        // redraw once per read instead of once per key
+        if (!connection.closing)
+        {
+            editor.render(connection.outbox, d_prompt);
+        }
+        onWritable(connection);
+    }
+
+    void Server::onWritable(Connection &connection)
+    {
+        while (!connection.hungUp && connection.sent < connection.outbox.size())
+        {
+            ssize_t count = send(connection.fd, connection.outbox.data() + connection.sent,
+                                 connection.outbox.size() - connection.sent, MSG_NOSIGNAL);
+            if (count < 0)
+            {
+                if (errno == EAGAIN)
+                {
+                    break;
+                }
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (connection.closing)
+                {
+                    close(connection);
+                    return;
+                }
+                // lines it sent before hanging up are still read, a zero byte read then closes it
+                connection.hungUp = true;
+            }
+            else
+            {
+                connection.sent += count;
+            }
+        }
+        if (connection.hungUp)
+        {
+            connection.sent = connection.outbox.size();
+        }
+
+        if (connection.sent == connection.outbox.size())
+        {
+            connection.outbox.clear();
+            connection.sent = 0;
+            if (connection.closing)
+            {
+                close(connection);
+                return;
+            }
+        }
+
+        // wait for the client to read, and stop reading from it if it falls far behind or is closing
+        std::size_t pending = connection.outbox.size() - connection.sent;
+        unsigned events = pending == 0 ? EPOLLIN : pending > MAX_PENDING_OUTPUT || connection.closing ? EPOLLOUT : EPOLLIN | EPOLLOUT;
+        if (events != connection.events)
+        {
+            connection.events = events;
+            watch(connection.fd, events, EPOLL_CTL_MOD);
+        }
+    }
+
+    void Server::showScheduled()
+    {
+        std::vector<std::pair<int, std::string>> pending;
+        {
+            std::lock_guard lock(d_scheduledMutex);
+            pending.swap(d_scheduledOutput);
+        }
+        for (auto &[fd, output] : pending)
+        {
+            auto it = d_connections.find(fd);
+            if (it == d_connections.end() || it->second->closing)
+            {
+                continue;
+            }
+            // print over the prompt, then draw it again with what was typed so far
+            Connection &connection = *it->second;
+            connection.outbox += "\r\033[K";
+            appendTerminalOutput(connection.outbox, output);
+            connection.session.editor.render(connection.outbox, d_prompt);
+            onWritable(connection);
+        }
+    }
+
+    // the fd is reused by the next connection, so nothing of this one may be left queued under it
+    void Server::endSchedules(Connection &connection)
+    {
+        d_processor.cancelSchedules(connection.session);
+        {
+            std::lock_guard lock(connection.session.schedules->mutex);
+            connection.session.schedules->sink = nullptr;
+        }
+        std::lock_guard lock(d_scheduledMutex);
+        std::erase_if(d_scheduledOutput, [&](const std::pair<int, std::string> &scheduled)
+                      { return scheduled.first == connection.fd; });
+    }
+
+    void Server::close(Connection &connection)
+    {
+        endSchedules(connection);
+        int fd = connection.fd;
+        epoll_ctl(d_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        d_connections.erase(fd);
+        d_sessionCount = d_connections.size();
+    }
+}
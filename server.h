@@ -0,0 +1,98 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "command-processor.h"
+
+namespace ose4g
+{
+    struct ServerOptions
+    {
+        /// path of the unix domain socket to listen on, empty to disable
+        std::string unixPath;
+        /// port to listen on at 127.0.0.1, -1 to disable, 0 picks a free port
+        int tcpPort = -1;
+    };
+
+    /**
+     * @brief Serves the commands of one command processor to many connections.
+     *
+     * Every connection gets its own Session (history, line editor, exit state)
+     * while the registered commands are shared. Connections are multiplexed
+     * with epoll on the thread that calls run(), so handlers run one at a time
+     * and their std::cout output is sent back to the connection that ran them.
+     * Commands a connection schedules with `every` print to that connection
+     * above its prompt and are cancelled when it closes.
+     *
+     * Clients are expected to behave like a terminal in raw mode, e.g.
+     * `socat -,raw,echo=0 UNIX-CONNECT:/tmp/app.sock`. Line based clients such
+     * as `nc` also work, they just see each line echoed back.
+     */
+    class Server
+    {
+    private:
+        struct Connection;
+
+        CommandProcessorImpl &d_processor;
+        ServerOptions d_options;
+        std::string d_prompt;
+        int d_epoll = -1;
+        int d_wakeup = -1;
+        int d_unixListener = -1;
+        int d_tcpListener = -1;
+        int d_tcpPort = -1;
+        std::atomic<bool> d_running{false};
+        std::atomic<std::size_t> d_sessionCount{0};
+        std::unordered_map<int, std::unique_ptr<Connection>> d_connections;
+        // output of scheduled runs by connection, handed over from the scheduler threads
+        std::mutex d_scheduledMutex;
+        std::vector<std::pair<int, std::string>> d_scheduledOutput;
+
+        void watch(int fd, unsigned events, int op);
+        void showScheduled();
+        void endSchedules(Connection &connection);
+        void accept(int listener);
+        void onReadable(Connection &connection);
+        void onWritable(Connection &connection);
+        void close(Connection &connection);
+
+    public:
+        /**
+         * @brief Constructor. Binds the sockets straight away.
+         *
+         * @param processor command processor whose commands are served
+         * @param options where to listen
+         *
+         * @throws std::system_error if a socket can not be set up
+         */
+        Server(CommandProcessorImpl &processor, const ServerOptions &options);
+        ~Server();
+
+        Server(const Server &) = delete;
+        Server &operator=(const Server &) = delete;
+
+        /**
+         * @brief serves connections until stop() is called
+         */
+        void run();
+
+        /**
+         * @brief makes run() return. Safe to call from any thread.
+         */
+        void stop();
+
+        /// @brief tcp port actually bound, -1 if tcp is disabled
+        int tcpPort() const { return d_tcpPort; }
+
+        /// @brief number of open sessions
+        std::size_t sessionCount() const { return d_sessionCount; }
+    };
+}
+
+#endif
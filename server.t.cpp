@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "server.h"
+#include "style.h"
+
+class ServerTest : public testing::Test
+{
+public:
+    ose4g::CommandProcessorImpl cp{"name"};
+    std::string path = "/tmp/command-processor-test-" + std::to_string(getpid()) + ".sock";
+    std::unique_ptr<ose4g::Server> server;
+    std::thread loop;
+
+    void SetUp() override
+    {
+        ose4g::setColorMode(ose4g::ColorMode::NEVER);
+        cp.add("echo", [](const ose4g::Args &args)
+               {
+                   for (auto &arg : args)
+                       std::cout << arg;
+               });
+        server = std::make_unique<ose4g::Server>(cp, ose4g::ServerOptions{path});
+        loop = std::thread([this]
+                           { server->run(); });
+    }
+
+    void TearDown() override
+    {
+        server->stop();
+        loop.join();
+        ose4g::setColorMode(ose4g::ColorMode::AUTO);
+    }
+
+    int connect()
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+        return fd;
+    }
+
+    // read until the output ends with the prompt, or the server closes the connection
+    std::string readResponse(int fd)
+    {
+        std::string response;
+        char buffer[1024];
+        while (!response.ends_with("name => "))
+        {
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            if (count <= 0)
+                break;
+            response.append(buffer, count);
+        }
+        return response;
+    }
+};
+
+TEST_F(ServerTest, shouldRunCommandAndSendOutputToConnection)
+{
+    int fd = connect();
+    readResponse(fd);
+    write(fd, "echo hello\n", 11);
+    auto response = readResponse(fd);
+    EXPECT_NE(response.find("hello"), std::string::npos);
+    close(fd);
+}
+
+TEST_F(ServerTest, sessionsShouldHaveSeparateHistory)
+{
+    int first = connect();
+    int second = connect();
+    readResponse(first);
+    readResponse(second);
+
+    write(first, "echo one\n", 9);
+    readResponse(first);
+    write(second, "history\n", 8);
+    auto response = readResponse(second);
+    EXPECT_EQ(response.find("echo one"), std::string::npos);
+    EXPECT_NE(response.find("history"), std::string::npos);
+    EXPECT_EQ(server->sessionCount(), 2);
+    close(first);
+    close(second);
+}
+
+TEST_F(ServerTest, tabShouldCompleteSubcommands)
+{
+    cp.addSubcommand({"cluster", "node", "drain"}, [](const ose4g::Args &)
+                     { std::cout << "drained"; });
+    int fd = connect();
+    readResponse(fd);
+    write(fd, "cluster no\t dr\t\n", 16);
+    auto response = readResponse(fd);
+    EXPECT_NE(response.find("drained"), std::string::npos);
+    close(fd);
+}
+
+TEST_F(ServerTest, commandsSentBeforeHangingUpShouldStillRun)
+{
+    int fd = connect();
+    write(fd, "echo hello\n", 11);
+    shutdown(fd, SHUT_WR);
+    std::string response;
+    char buffer[1024];
+    ssize_t count;
+    while ((count = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        response.append(buffer, count);
+    }
+    EXPECT_NE(response.find("hello"), std::string::npos);
+    close(fd);
+
+    // one that closes altogether does not get the output, the command still runs
+    std::atomic<bool> ran{false};
+    cp.add("mark", [&](const ose4g::Args &)
+           { ran = true; });
+    fd = connect();
+    write(fd, "mark\n", 5);
+    close(fd);
+    for (int i = 0; i < 200 && !ran; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(ran);
+}
+
+TEST_F(ServerTest, exitShouldCloseOnlyThatSession)
+{
+    int fd = connect();
+    readResponse(fd);
+    write(fd, "exit\n", 5);
+    readResponse(fd);
+    char c;
+    EXPECT_EQ(read(fd, &c, 1), 0);
+    close(fd);
+}
+
+TEST_F(ServerTest, scheduledOutputShouldGoToTheConnectionThatScheduledIt)
+{
+    int first = connect();
+    int second = connect();
+    readResponse(first);
+    readResponse(second);
+
+    std::string line = "every 20ms echo tick\n";
+    write(first, line.data(), line.size());
+    std::string response;
+    while (response.find("tick\r\n\r\033[Kname => ") == std::string::npos)
+    {
+        auto more = readResponse(first);
+        if (more.empty())
+            break;
+        response += more;
+    }
+    EXPECT_NE(response.find("scheduled 1"), std::string::npos);
+    EXPECT_NE(response.find("tick\r\n\r\033[Kname => "), std::string::npos);
+
+    // another connection neither sees nor cancels it
+    write(second, "every\n", 6);
+    EXPECT_NE(readResponse(second).find("nothing scheduled"), std::string::npos);
+    line = "every cancel 1\n";
+    write(second, line.data(), line.size());
+    EXPECT_NE(readResponse(second).find("no schedule 1"), std::string::npos);
+    EXPECT_EQ(cp.schedules().size(), 1u);
+
+    // closing the connection ends its schedules
+    close(first);
+    for (int i = 0; i < 200 && !cp.schedules().empty(); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(cp.schedules().empty());
+    close(second);
+}
@@ -0,0 +1,74 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "history.h"
+#include "lineeditor.h"
+#include "rule.h"
+#include "scheduler.h"
+
+namespace ose4g
+{
+    /**
+     * @brief State owned by one operator.
+     *
+     * The terminal REPL has one session, the server creates one per
+     * connection. Everything else in the command processor is shared.
+     */
+    struct Session
+    {
+        /**
+         * @brief Working memory for one command at a time.
+         *
+         * The parsed command and arguments keep their capacity between
+         * commands. Temporaries go to the arena, which is released after each
+         * command so a warmed up session runs commands without touching the
+         * global allocator.
+         */
+        struct Scratch
+        {
+            Command command;
+            Args args;
+            Args recordedArgs;
+            std::array<std::byte, 4096> buffer;
+            std::pmr::monotonic_buffer_resource arena{buffer.data(), buffer.size()};
+        };
+
+        /**
+         * @brief The commands a session scheduled and where their output goes.
+         *
+         * Runs happen on scheduler threads and may finish after the session
+         * is gone, so they share this with it. Output of runs after sink is
+         * cleared is dropped.
+         */
+        struct Schedules
+        {
+            std::mutex mutex;
+            // called with the output of each run, under mutex
+            std::function<void(const std::string &)> sink;
+            std::vector<Scheduler::Id> ids;
+        };
+
+        History history;
+        LineEditor editor;
+        bool isRunning = true;
+        // a pointer so a command left running in the background can keep its own
+        std::unique_ptr<Scratch> scratch = std::make_unique<Scratch>();
+        std::shared_ptr<Schedules> schedules = std::make_shared<Schedules>();
+
+        Session(LineEditor::Completer completer) : editor(history, std::move(completer)) {}
+
+        // the editor keeps a reference to history
+        Session(const Session &) = delete;
+        Session &operator=(const Session &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <coroutine>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ose4g
+{
+    /**
+     * @brief Coroutine type for handlers that produce output in chunks.
+     *
+     * A streaming handler `co_yield`s its output a chunk at a time. The
+     * processor prints each chunk as soon as it is produced and stops
+     * resuming the handler when the user presses Ctrl-C. Stopping destroys
+     * the coroutine frame, so locals are cleaned up as if the handler returned.
+     *
+     * @code
+     * cp.add("scan", [](const ose4g::Args &args) -> ose4g::Stream {
+     *     for (auto &row : table)
+     *         co_yield row.toString() + "\n";
+     * });
+     * @endcode
+     */
+    class Stream
+    {
+    public:
+        struct promise_type
+        {
+            std::string chunk;
+            std::exception_ptr exception;
+
+            Stream get_return_object() { return Stream(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { exception = std::current_exception(); }
+
+            // copies into a buffer that keeps its capacity between chunks
+            std::suspend_always yield_value(std::string_view value)
+            {
+                chunk.assign(value);
+                return {};
+            }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> d_handle;
+
+        explicit Stream(std::coroutine_handle<promise_type> handle) : d_handle(handle) {}
+
+    public:
+        Stream(Stream &&other) noexcept : d_handle(std::exchange(other.d_handle, nullptr)) {}
+        Stream &operator=(Stream &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (d_handle)
+                    d_handle.destroy();
+                d_handle = std::exchange(other.d_handle, nullptr);
+            }
+            return *this;
+        }
+        ~Stream()
+        {
+            if (d_handle)
+                d_handle.destroy();
+        }
+
+        /**
+         * @brief runs the handler until its next chunk.
+         *
+         * @returns false once the handler has finished
+         * @throws whatever the handler threw
+         */
+        bool next()
+        {
+            if (!d_handle || d_handle.done())
+            {
+                return false;
+            }
+            d_handle.resume();
+            if (d_handle.promise().exception)
+            {
+                std::rethrow_exception(std::exchange(d_handle.promise().exception, nullptr));
+            }
+            return !d_handle.done();
+        }
+
+        /// @brief the chunk produced by the last successful next()
+        const std::string &chunk() const { return d_handle.promise().chunk; }
+    };
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include "stream.h"
+
+static ose4g::Stream count(int n, bool &cleanedUp)
+{
+    struct Cleanup
+    {
+        bool &flag;
+        ~Cleanup() { flag = true; }
+    } cleanup{cleanedUp};
+    for (int i = 0; i < n; i++)
+    {
+        co_yield std::to_string(i);
+    }
+}
+
+TEST(StreamTest, shouldProduceChunksInOrder)
+{
+    bool cleanedUp = false;
+    auto stream = count(3, cleanedUp);
+    std::string all;
+    while (stream.next())
+    {
+        all += stream.chunk();
+    }
+    EXPECT_EQ(all, "012");
+    EXPECT_TRUE(cleanedUp);
+}
+
+TEST(StreamTest, destroyingShouldCancelAndCleanUp)
+{
+    bool cleanedUp = false;
+    {
+        auto stream = count(1000, cleanedUp);
+        EXPECT_TRUE(stream.next());
+        EXPECT_FALSE(cleanedUp);
+    }
+    EXPECT_TRUE(cleanedUp);
+}
+
+TEST(StreamTest, nextShouldRethrowHandlerExceptions)
+{
+    auto stream = []() -> ose4g::Stream
+    {
+        co_yield "first";
+        throw std::runtime_error("backend down");
+    }();
+    EXPECT_TRUE(stream.next());
+    EXPECT_THROW(stream.next(), std::runtime_error);
+    EXPECT_FALSE(stream.next());
+}
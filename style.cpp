@@ -0,0 +1,59 @@
+#include "style.h"
+#include <atomic>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace ose4g
+{
+    namespace
+    {
+        std::atomic<ColorMode> s_colorMode{ColorMode::AUTO};
+
+        bool terminalSupportsColor()
+        {
+            // https://no-color.org: any non empty value disables colour
+            const char *noColor = std::getenv("NO_COLOR");
+            if (noColor != nullptr && noColor[0] != '\0')
+            {
+                return false;
+            }
+            return isatty(STDOUT_FILENO);
+        }
+    }
+
+    void setColorMode(ColorMode mode)
+    {
+        s_colorMode = mode;
+    }
+
+    bool colorEnabled()
+    {
+        switch (s_colorMode.load(std::memory_order_relaxed))
+        {
+        case ColorMode::ALWAYS:
+            return true;
+        case ColorMode::NEVER:
+            return false;
+        default:
+            break;
+        }
+        // the environment does not change while we run so only check once
+        static const bool autoColor = terminalSupportsColor();
+        return autoColor;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const StyledText &value)
+    {
+        bool color = !value.style.empty() && colorEnabled();
+        if (color)
+        {
+            out.write(value.style.sequence().data(), value.style.sequence().size());
+        }
+        out.write(value.text.data(), value.text.size());
+        if (color)
+        {
+            out.write(Style::reset().data(), Style::reset().size());
+        }
+        return out;
+    }
+}
@@ -0,0 +1,213 @@
+#ifndef STYLE_H
+#define STYLE_H
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "util.h"
+
+namespace ose4g
+{
+    /// @brief text attributes that can be combined with a colour
+    enum class Attribute : unsigned
+    {
+        NONE = 0,
+        BOLD = 1,
+        DIM = 2,
+        ITALIC = 4,
+        UNDERLINE = 8
+    };
+
+    constexpr Attribute operator|(Attribute lhs, Attribute rhs)
+    {
+        return static_cast<Attribute>(static_cast<unsigned>(lhs) | static_cast<unsigned>(rhs));
+    }
+
+    /// @brief controls whether escape sequences are written at all
+    enum class ColorMode
+    {
+        AUTO,   // colour only when stdout is a terminal and NO_COLOR is not set
+        ALWAYS,
+        NEVER
+    };
+
+    /// @brief set the colour mode used by every styled write
+    void setColorMode(ColorMode mode);
+
+    /// @brief true if styled output should currently contain escape sequences
+    bool colorEnabled();
+
+    /**
+     * @brief An escape sequence built at compile time.
+     *
+     * A Style only stores the bytes to write, so styling a span of text is a
+     * copy of the sequence, the text and the reset code into the output.
+     */
+    class Style
+    {
+    private:
+        static constexpr std::size_t MAX_LENGTH = 48;
+        std::array<char, MAX_LENGTH> d_sequence{};
+        std::size_t d_length = 0;
+        bool d_hasParameter = false;
+
+        constexpr void append(std::string_view value)
+        {
+            for (char c : value)
+            {
+                d_sequence[d_length++] = c;
+            }
+        }
+
+        constexpr void appendParameter(unsigned value)
+        {
+            append(d_hasParameter ? ";" : "\033[");
+            d_hasParameter = true;
+            char digits[3];
+            int count = 0;
+            do
+            {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            while (count > 0)
+            {
+                d_sequence[d_length++] = digits[--count];
+            }
+        }
+
+        constexpr void appendAttributes(Attribute attributes)
+        {
+            auto bits = static_cast<unsigned>(attributes);
+            if (bits & static_cast<unsigned>(Attribute::BOLD))
+                appendParameter(1);
+            if (bits & static_cast<unsigned>(Attribute::DIM))
+                appendParameter(2);
+            if (bits & static_cast<unsigned>(Attribute::ITALIC))
+                appendParameter(3);
+            if (bits & static_cast<unsigned>(Attribute::UNDERLINE))
+                appendParameter(4);
+        }
+
+        constexpr Style &close()
+        {
+            if (d_hasParameter)
+            {
+                append("m");
+            }
+            return *this;
+        }
+
+    public:
+        /// @brief plain style, writes no escape sequences
+        constexpr Style() = default;
+
+        /// @brief one of the basic terminal colours, bold by default like addColor
+        constexpr Style(Color color, Attribute attributes = Attribute::BOLD)
+        {
+            appendAttributes(attributes);
+            appendParameter(color);
+            close();
+        }
+
+        /// @brief attributes only, keeps the terminal's colour
+        constexpr Style(Attribute attributes)
+        {
+            appendAttributes(attributes);
+            close();
+        }
+
+        /// @brief colour from the 256 colour palette
+        static constexpr Style palette(unsigned char index, Attribute attributes = Attribute::NONE)
+        {
+            Style style;
+            style.appendAttributes(attributes);
+            style.appendParameter(38);
+            style.appendParameter(5);
+            style.appendParameter(index);
+            return style.close();
+        }
+
+        /// @brief 24 bit colour
+        static constexpr Style rgb(unsigned char red, unsigned char green, unsigned char blue, Attribute attributes = Attribute::NONE)
+        {
+            Style style;
+            style.appendAttributes(attributes);
+            style.appendParameter(38);
+            style.appendParameter(2);
+            style.appendParameter(red);
+            style.appendParameter(green);
+            style.appendParameter(blue);
+            return style.close();
+        }
+
+        /// @brief escape sequence that turns the style on
+        constexpr std::string_view sequence() const { return {d_sequence.data(), d_length}; }
+
+        /// @brief escape sequence that turns every style off
+        static constexpr std::string_view reset() { return "\033[0m"; }
+
+        constexpr bool empty() const { return d_length == 0; }
+    };
+
+    /// @brief a span of text paired with the style it should be written in
+    struct StyledText
+    {
+        std::string_view text;
+        Style style;
+    };
+
+    constexpr StyledText styled(std::string_view text, const Style &style)
+    {
+        return {text, style};
+    }
+
+    /**
+     * @brief writes styled text to an output iterator.
+     *
+     * Escape sequences are left out when colour is disabled.
+     */
+    template <typename OutputIt>
+    OutputIt formatStyled(OutputIt out, const StyledText &value)
+    {
+        bool color = !value.style.empty() && colorEnabled();
+        if (color)
+        {
+            out = std::copy(value.style.sequence().begin(), value.style.sequence().end(), out);
+        }
+        out = std::copy(value.text.begin(), value.text.end(), out);
+        if (color)
+        {
+            out = std::copy(Style::reset().begin(), Style::reset().end(), out);
+        }
+        return out;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const StyledText &value);
+}
+
+/// @brief lets styled text be used directly in std::format, e.g. std::format("{:>10}", styled(...))
+/// the format spec applies to the text, not to the escape sequences.
+template <>
+struct std::formatter<ose4g::StyledText> : std::formatter<std::string_view>
+{
+    auto format(const ose4g::StyledText &value, std::format_context &ctx) const
+    {
+        bool color = !value.style.empty() && ose4g::colorEnabled();
+        if (color)
+        {
+            ctx.advance_to(std::copy(value.style.sequence().begin(), value.style.sequence().end(), ctx.out()));
+        }
+        auto out = std::formatter<std::string_view>::format(value.text, ctx);
+        if (color)
+        {
+            out = std::copy(ose4g::Style::reset().begin(), ose4g::Style::reset().end(), out);
+        }
+        return out;
+    }
+};
+
+#endif
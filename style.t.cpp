@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "style.h"
+
+class StyleTest : public testing::Test
+{
+public:
+    void TearDown() override
+    {
+        ose4g::setColorMode(ose4g::ColorMode::AUTO);
+    }
+};
+
+TEST_F(StyleTest, sequencesShouldBeBuiltAtCompileTime)
+{
+    static_assert(ose4g::Style(ose4g::Color::BLUE).sequence() == "\033[1;34m");
+    static_assert(ose4g::Style(ose4g::Color::RED, ose4g::Attribute::NONE).sequence() == "\033[31m");
+    static_assert(ose4g::Style(ose4g::Attribute::BOLD | ose4g::Attribute::DIM).sequence() == "\033[1;2m");
+    static_assert(ose4g::Style::palette(208).sequence() == "\033[38;5;208m");
+    static_assert(ose4g::Style::rgb(255, 0, 10, ose4g::Attribute::UNDERLINE).sequence() == "\033[4;38;2;255;0;10m");
+    static_assert(ose4g::Style().empty());
+}
+
+TEST_F(StyleTest, shouldWriteEscapeSequencesWhenColorIsEnabled)
+{
+    ose4g::setColorMode(ose4g::ColorMode::ALWAYS);
+    std::stringstream out;
+    out << ose4g::styled("help", ose4g::Style(ose4g::Color::BLUE));
+    EXPECT_EQ(out.str(), "\033[1;34mhelp\033[0m");
+    EXPECT_EQ(ose4g::addColor("help", ose4g::Color::BLUE), "\033[1;34mhelp\033[0m");
+}
+
+TEST_F(StyleTest, shouldStripEscapeSequencesWhenColorIsDisabled)
+{
+    ose4g::setColorMode(ose4g::ColorMode::NEVER);
+    std::stringstream out;
+    out << ose4g::styled("help", ose4g::Style(ose4g::Color::BLUE));
+    EXPECT_EQ(out.str(), "help");
+    EXPECT_EQ(ose4g::addColor("help", ose4g::Color::BLUE), "help");
+}
+
+TEST_F(StyleTest, formatStyledShouldWriteIntoOutputIterator)
+{
+    ose4g::setColorMode(ose4g::ColorMode::ALWAYS);
+    std::string buffer = "=> ";
+    ose4g::formatStyled(std::back_inserter(buffer), ose4g::styled("ok", ose4g::Style::palette(2)));
+    EXPECT_EQ(buffer, "=> \033[38;5;2mok\033[0m");
+}
@@ -0,0 +1,265 @@
+#include "threadpool.h"
+#include <algorithm>
+#include <utility>
+
+namespace ose4g
+{
+    namespace
+    {
+        // the pool whose batch the current thread is working on, if any
+        thread_local const WorkStealingPool *t_pool = nullptr;
+    }
+
+    WorkStealingPool::WorkStealingPool(std::size_t threads)
+    {
+        threads = std::max<std::size_t>(threads, 1);
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            d_queues.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            d_threads.emplace_back([this, i]
+                                   { loop(i); });
+        }
+        d_size = threads;
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard lock(d_mutex);
+            d_stopping = true;
+        }
+        d_wakeup.notify_all();
+        for (auto &thread : d_threads)
+        {
+            thread.join();
+        }
+    }
+
+    bool WorkStealingPool::inside() const
+    {
+        return t_pool == this;
+    }
+
+    void WorkStealingPool::runInline(std::size_t count, const Task &task, const Done &done)
+    {
+        std::exception_ptr error;
+        for (std::size_t index = 0; index < count; index++)
+        {
+            try
+            {
+                task(index);
+            }
+            catch (...)
+            {
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+            try
+            {
+                if (done)
+                {
+                    done(index);
+                }
+            }
+            catch (...)
+            {
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void WorkStealingPool::forEach(std::size_t count, const Task &task, const Done &done, std::size_t threads)
+    {
+        if (inside())
+        {
+            runInline(count, task, done);
+            return;
+        }
+        std::lock_guard call(d_callMutex);
+        if (count == 0)
+        {
+            return;
+        }
+        // done runs on this thread while the batch holds the pool
+        struct Enter
+        {
+            const WorkStealingPool *previous;
+            explicit Enter(const WorkStealingPool *pool) : previous(std::exchange(t_pool, pool)) {}
+            ~Enter() { t_pool = previous; }
+        } enter(this);
+        threads = threads == 0 ? d_queues.size() : std::min(threads, d_queues.size());
+        // contiguous runs so each thread starts on its own part of the batch
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            std::lock_guard lock(d_queues[i]->mutex);
+            for (std::size_t index = count * i / threads; index < count * (i + 1) / threads; index++)
+            {
+                d_queues[i]->items.push_back(index);
+            }
+        }
+        {
+            std::lock_guard lock(d_mutex);
+            d_task = &task;
+            d_width = threads;
+            d_done.clear();
+            d_error = nullptr;
+            d_generation++;
+        }
+        d_wakeup.notify_all();
+
+        std::size_t finished = 0;
+        std::vector<std::size_t> ready;
+        std::unique_lock lock(d_mutex);
+        while (true)
+        {
+            d_finished.wait(lock, [&]
+                            { return !d_done.empty() || (finished == count && d_active == 0); });
+            if (d_done.empty())
+            {
+                break;
+            }
+            ready.swap(d_done);
+            finished += ready.size();
+            lock.unlock();
+            for (std::size_t index : ready)
+            {
+                try
+                {
+                    if (done)
+                    {
+                        done(index);
+                    }
+                }
+                catch (...)
+                {
+                    // the batch still has to finish before task can go out of scope
+                    std::lock_guard errorLock(d_mutex);
+                    if (!d_error)
+                    {
+                        d_error = std::current_exception();
+                    }
+                }
+            }
+            ready.clear();
+            lock.lock();
+        }
+        // no thread can pick up this batch any more
+        d_task = nullptr;
+        auto error = std::exchange(d_error, nullptr);
+        lock.unlock();
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void WorkStealingPool::reserve(std::size_t threads)
+    {
+        if (inside())
+        {
+            return;
+        }
+        // no batch is running, idle threads do not look at the queues
+        std::lock_guard call(d_callMutex);
+        while (d_queues.size() < threads)
+        {
+            std::size_t self = d_queues.size();
+            d_queues.push_back(std::make_unique<Queue>());
+            d_threads.emplace_back([this, self]
+                                   { loop(self); });
+        }
+        d_size = d_threads.size();
+    }
+
+    bool WorkStealingPool::take(std::size_t self, std::size_t width, std::size_t &index)
+    {
+        {
+            auto &own = *d_queues[self];
+            std::lock_guard lock(own.mutex);
+            if (!own.items.empty())
+            {
+                index = own.items.front();
+                own.items.pop_front();
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < width; i++)
+        {
+            auto &victim = *d_queues[(self + i) % width];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.items.empty())
+            {
+                // the far end, furthest from what the owner is working on
+                index = victim.items.back();
+                victim.items.pop_back();
+                d_steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::loop(std::size_t self)
+    {
+        t_pool = this;
+        std::uint64_t seen = 0;
+        while (true)
+        {
+            const Task *task;
+            std::size_t width;
+            {
+                std::unique_lock lock(d_mutex);
+                d_wakeup.wait(lock, [&]
+                              { return d_stopping || d_generation != seen; });
+                if (d_stopping)
+                {
+                    return;
+                }
+                seen = d_generation;
+                task = d_task;
+                width = d_width;
+                if (!task || self >= width)
+                {
+                    // woke after the batch already finished, or the batch is not for this thread
+                    continue;
+                }
+                d_active++;
+            }
+            std::size_t index;
+            while (take(self, width, index))
+            {
+                std::exception_ptr error;
+                try
+                {
+                    (*task)(index);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                std::lock_guard lock(d_mutex);
+                if (error && !d_error)
+                {
+                    d_error = error;
+                }
+                d_done.push_back(index);
+                d_finished.notify_one();
+            }
+            std::lock_guard lock(d_mutex);
+            d_active--;
+            d_finished.notify_one();
+        }
+    }
+}
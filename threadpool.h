@@ -0,0 +1,99 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ose4g
+{
+    /**
+     * @brief Fixed set of threads running batches of indexed tasks.
+     *
+     * Each batch is split into contiguous runs, one queue per thread. A
+     * thread takes from the front of its own queue, so neighbouring tasks
+     * finish close together, and when it runs out it steals from the back
+     * of the others. Slow tasks therefore never leave threads idle while
+     * work is still queued elsewhere.
+     */
+    class WorkStealingPool
+    {
+    public:
+        using Task = std::function<void(std::size_t)>;
+        using Done = std::function<void(std::size_t)>;
+
+        /// @param threads number of threads, at least one is started.
+        explicit WorkStealingPool(std::size_t threads);
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        /**
+         * @brief runs task(0) ... task(count - 1) on the pool and waits for all of them.
+         *
+         * Batches from different callers run one after the other. A task or
+         * done callback of this pool that starts a batch of its own would wait
+         * for itself, such a batch runs on the calling thread instead.
+         *
+         * @param done called on the calling thread with each index as its task
+         *        finishes, in the order they finish.
+         * @param threads how many of the pool's threads take part, all of them if 0.
+         *
+         * @throws the first exception thrown by a task, after every task has run.
+         */
+        void forEach(std::size_t count, const Task &task, const Done &done = {}, std::size_t threads = 0);
+
+        /// @brief starts threads until there are at least threads, once the running batch is done.
+        /// Does nothing when called from a task or done callback of this pool.
+        void reserve(std::size_t threads);
+
+        std::size_t size() const { return d_size.load(std::memory_order_relaxed); }
+
+        /// @brief tasks run by a thread other than the one they were queued for
+        std::uint64_t steals() const { return d_steals.load(std::memory_order_relaxed); }
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::size_t> items;
+        };
+
+        std::vector<std::unique_ptr<Queue>> d_queues;
+        std::vector<std::thread> d_threads;
+        std::atomic<std::uint64_t> d_steals{0};
+        std::atomic<std::size_t> d_size{0};
+
+        // serialises forEach calls, the batch state below belongs to the running one
+        std::mutex d_callMutex;
+
+        std::mutex d_mutex;
+        std::condition_variable d_wakeup;
+        std::condition_variable d_finished;
+        std::uint64_t d_generation = 0;
+        // threads taking part in the current batch, the first ones
+        std::size_t d_width = 0;
+        // threads still taking tasks of the current batch
+        std::size_t d_active = 0;
+        bool d_stopping = false;
+        const Task *d_task = nullptr;
+        std::vector<std::size_t> d_done;
+        std::exception_ptr d_error;
+
+        bool take(std::size_t self, std::size_t width, std::size_t &index);
+        // true on the pool's threads and on a thread inside forEach
+        bool inside() const;
+        void runInline(std::size_t count, const Task &task, const Done &done);
+        void loop(std::size_t self);
+    };
+}
+
+#endif
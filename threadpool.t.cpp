@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "threadpool.h"
+
+using namespace std::chrono_literals;
+
+TEST(WorkStealingPoolTest, shouldRunEveryTaskOnce)
+{
+    ose4g::WorkStealingPool pool(4);
+    std::vector<std::atomic<int>> runs(1000);
+    std::vector<std::size_t> done;
+    pool.forEach(runs.size(), [&](std::size_t index)
+                 { runs[index]++; }, [&](std::size_t index)
+                 { done.push_back(index); });
+    for (auto &count : runs)
+    {
+        EXPECT_EQ(count.load(), 1);
+    }
+    EXPECT_EQ(done.size(), runs.size());
+}
+
+TEST(WorkStealingPoolTest, idleThreadsShouldStealFromBusyOnes)
+{
+    ose4g::WorkStealingPool pool(2);
+    // the first half is all queued for one thread and slow
+    pool.forEach(20, [](std::size_t index)
+                 {
+        if (index < 10)
+            std::this_thread::sleep_for(5ms); });
+    EXPECT_GT(pool.steals(), 0u);
+}
+
+TEST(WorkStealingPoolTest, shouldRethrowAfterTheBatchFinishes)
+{
+    ose4g::WorkStealingPool pool(3);
+    std::atomic<int> runs = 0;
+    EXPECT_THROW(pool.forEach(30, [&](std::size_t index)
+                              {
+        runs++;
+        if (index == 7)
+            throw std::runtime_error("failed"); }),
+                 std::runtime_error);
+    EXPECT_EQ(runs.load(), 30);
+
+    // the pool is still usable
+    runs = 0;
+    pool.forEach(5, [&](std::size_t)
+                 { runs++; });
+    EXPECT_EQ(runs.load(), 5);
+}
+
+TEST(WorkStealingPoolTest, batchesShouldUseAsManyThreadsAsAskedFor)
+{
+    ose4g::WorkStealingPool pool(1);
+    pool.reserve(4);
+    EXPECT_EQ(pool.size(), 4u);
+    std::atomic<int> running = 0, mostRunning = 0;
+    auto task = [&](std::size_t)
+    {
+        int now = ++running;
+        mostRunning = std::max(mostRunning.load(), now);
+        std::this_thread::sleep_for(2ms);
+        --running;
+    };
+    pool.forEach(40, task, {}, 2);
+    EXPECT_LE(mostRunning.load(), 2);
+    pool.forEach(40, task);
+    EXPECT_GT(mostRunning.load(), 2);
+}
+
+TEST(WorkStealingPoolTest, batchesStartedFromInsideABatchShouldRunInline)
+{
+    ose4g::WorkStealingPool pool(2);
+    std::atomic<int> runs{0};
+    pool.forEach(4, [&](std::size_t)
+                 {
+        pool.reserve(8);
+        pool.forEach(3, [&](std::size_t)
+                     { runs++; }); }, [&](std::size_t)
+                 { pool.forEach(2, [&](std::size_t)
+                                { runs++; }); });
+    EXPECT_EQ(runs.load(), 4 * 3 + 4 * 2);
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_THROW(pool.forEach(2, [&](std::size_t)
+                              { pool.forEach(1, [](std::size_t)
+                                             { throw std::runtime_error("nested"); }); }),
+                 std::runtime_error);
+}
@@ -0,0 +1,139 @@
+#include "timerwheel.h"
+#include <algorithm>
+
+namespace ose4g
+{
+    TimerWheel::TimerWheel(std::uint64_t now) : d_now(now)
+    {
+    }
+
+    TimerWheel::Id TimerWheel::schedule(std::uint64_t expiry, Callback callback)
+    {
+        Id id = d_nextId++;
+        d_timers.emplace(id, Timer{expiry, std::move(callback)});
+        // the current tick has already been handled, anything due goes in the next one
+        place(id, std::max(expiry, d_now + 1));
+        return id;
+    }
+
+    bool TimerWheel::cancel(Id id)
+    {
+        return d_timers.erase(id) > 0;
+    }
+
+    void TimerWheel::place(Id id, std::uint64_t expiry)
+    {
+        std::uint64_t delta = expiry - d_now;
+        unsigned level = 0;
+        while (level + 1 < LEVELS && delta >= (std::uint64_t{1} << (BITS * (level + 1))))
+        {
+            level++;
+        }
+        // timers beyond the top level wrap around and are placed again when their slot cascades
+        d_slots[level][(expiry >> (BITS * level)) & (SLOTS - 1)].push_back(id);
+    }
+
+    void TimerWheel::cascade(unsigned level)
+    {
+        auto ids = std::move(d_slots[level][(d_now >> (BITS * level)) & (SLOTS - 1)]);
+        d_slots[level][(d_now >> (BITS * level)) & (SLOTS - 1)].clear();
+        for (Id id : ids)
+        {
+            auto timer = d_timers.find(id);
+            if (timer != d_timers.end())
+            {
+                place(id, timer->second.expiry);
+            }
+        }
+    }
+
+    std::size_t TimerWheel::fireDue()
+    {
+        auto ids = std::move(d_slots[0][d_now & (SLOTS - 1)]);
+        d_slots[0][d_now & (SLOTS - 1)].clear();
+        std::size_t fired = 0;
+        for (Id id : ids)
+        {
+            auto timer = d_timers.find(id);
+            if (timer == d_timers.end())
+            {
+                continue;
+            }
+            if (timer->second.expiry > d_now)
+            {
+                place(id, timer->second.expiry);
+                continue;
+            }
+            auto callback = std::move(timer->second.callback);
+            d_timers.erase(timer);
+            callback();
+            fired++;
+        }
+        return fired;
+    }
+
+    std::size_t TimerWheel::advance(std::uint64_t now)
+    {
+        std::size_t fired = 0;
+        while (d_now < now)
+        {
+            if (d_timers.empty())
+            {
+                // nothing to fire, drop ids of cancelled timers and jump
+                for (auto &level : d_slots)
+                {
+                    for (auto &slot : level)
+                    {
+                        slot.clear();
+                    }
+                }
+                d_now = now;
+                break;
+            }
+            d_now++;
+            // move timers down from the highest level whose slot boundary was crossed
+            unsigned level = 1;
+            while (level < LEVELS && (d_now & ((std::uint64_t{1} << (BITS * level)) - 1)) == 0)
+            {
+                level++;
+            }
+            while (--level > 0)
+            {
+                cascade(level);
+            }
+            fired += fireDue();
+        }
+        return fired;
+    }
+
+    std::optional<std::uint64_t> TimerWheel::nextExpiry() const
+    {
+        std::optional<std::uint64_t> next;
+        for (auto &timer : d_timers)
+        {
+            if (!next || timer.second.expiry < *next)
+            {
+                next = timer.second.expiry;
+            }
+        }
+        return next;
+    }
+
+    std::optional<std::uint64_t> TimerWheel::nextWakeup() const
+    {
+        if (d_timers.empty())
+        {
+            return std::nullopt;
+        }
+        // slots may hold ids of cancelled timers, waking early for them is harmless
+        std::uint64_t rotationEnd = (d_now | (SLOTS - 1)) + 1;
+        for (std::uint64_t tick = d_now + 1; tick < rotationEnd; tick++)
+        {
+            if (!d_slots[0][tick & (SLOTS - 1)].empty())
+            {
+                return tick;
+            }
+        }
+        return rotationEnd;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace ose4g
+{
+    /**
+     * @brief Hierarchical timer wheel.
+     *
+     * Time is measured in ticks chosen by the owner. Scheduling and
+     * cancelling are O(1); a timer is moved down a level at most once per
+     * level before it fires. Not thread safe, the owner serialises access.
+     */
+    class TimerWheel
+    {
+    public:
+        using Id = std::uint64_t;
+        using Callback = std::function<void()>;
+
+        explicit TimerWheel(std::uint64_t now = 0);
+
+        /**
+         * @brief runs callback during the first advance that reaches expiry.
+         *
+         * Timers already due fire on the next advance. Callbacks may
+         * schedule and cancel timers.
+         */
+        Id schedule(std::uint64_t expiry, Callback callback);
+
+        /// @brief returns false if the timer already fired or was cancelled
+        bool cancel(Id id);
+
+        /// @brief moves time forward to now and fires every due timer, returns how many fired
+        std::size_t advance(std::uint64_t now);
+
+        /// @brief expiry of the earliest pending timer
+        std::optional<std::uint64_t> nextExpiry() const;
+
+        /**
+         * @brief a tick no later than the earliest expiry, to sleep until before the next advance.
+         *
+         * Looks at the rest of the current lowest level rotation only, so it
+         * costs the same however many timers there are. Without a timer due
+         * in it, the answer is the start of the next rotation.
+         */
+        std::optional<std::uint64_t> nextWakeup() const;
+
+        std::uint64_t now() const { return d_now; }
+        std::size_t size() const { return d_timers.size(); }
+
+    private:
+        static constexpr unsigned BITS = 6;
+        static constexpr unsigned SLOTS = 1u << BITS;
+        static constexpr unsigned LEVELS = 4;
+
+        struct Timer
+        {
+            std::uint64_t expiry;
+            Callback callback;
+        };
+
+        std::uint64_t d_now;
+        Id d_nextId = 1;
+        // cancelled timers are only erased here, their ids are skipped when the slot is reached
+        std::unordered_map<Id, Timer> d_timers;
+        std::array<std::array<std::vector<Id>, SLOTS>, LEVELS> d_slots;
+
+        void place(Id id, std::uint64_t expiry);
+        void cascade(unsigned level);
+        std::size_t fireDue();
+    };
+}
+
+#endif
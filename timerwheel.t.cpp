@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "timerwheel.h"
+
+TEST(TimerWheelTest, shouldFireTimersInOrderAtTheirExpiry)
+{
+    ose4g::TimerWheel wheel;
+    std::vector<int> fired;
+    // spread across every level
+    wheel.schedule(5, [&] { fired.push_back(5); });
+    wheel.schedule(100, [&] { fired.push_back(100); });
+    wheel.schedule(5000, [&] { fired.push_back(5000); });
+    wheel.schedule(300000, [&] { fired.push_back(300000); });
+
+    EXPECT_EQ(wheel.advance(4), 0u);
+    EXPECT_EQ(wheel.advance(5), 1u);
+    EXPECT_EQ(wheel.advance(99), 0u);
+    EXPECT_EQ(wheel.advance(100), 1u);
+    EXPECT_EQ(wheel.advance(4999), 0u);
+    EXPECT_EQ(wheel.advance(299999), 1u);
+    EXPECT_EQ(wheel.advance(300000), 1u);
+    EXPECT_EQ(fired, (std::vector{5, 100, 5000, 300000}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, cancelledTimersShouldNotFire)
+{
+    ose4g::TimerWheel wheel;
+    bool fired = false;
+    auto id = wheel.schedule(10, [&] { fired = true; });
+    EXPECT_EQ(wheel.nextExpiry(), 10u);
+    EXPECT_TRUE(wheel.cancel(id));
+    EXPECT_FALSE(wheel.cancel(id));
+    wheel.advance(20);
+    EXPECT_FALSE(fired);
+    EXPECT_FALSE(wheel.nextExpiry());
+}
+
+TEST(TimerWheelTest, callbacksShouldBeAbleToReschedule)
+{
+    ose4g::TimerWheel wheel(1000);
+    int count = 0;
+    std::function<void()> tick = [&]
+    {
+        if (++count < 3)
+            wheel.schedule(wheel.now() + 10, tick);
+    };
+    // already due, fires on the next advance
+    wheel.schedule(0, tick);
+    wheel.advance(1001);
+    EXPECT_EQ(count, 1);
+    wheel.advance(1021);
+    EXPECT_EQ(count, 3);
+}
+
+TEST(TimerWheelTest, timersBeyondTheTopLevelShouldWrapAround)
+{
+    ose4g::TimerWheel wheel;
+    std::uint64_t expiry = (std::uint64_t{1} << 25) + 7;
+    bool fired = false;
+    wheel.schedule(expiry, [&] { fired = true; });
+    wheel.advance(expiry - 1);
+    EXPECT_FALSE(fired);
+    wheel.advance(expiry);
+    EXPECT_TRUE(fired);
+}
+
+TEST(TimerWheelTest, nextWakeupShouldNeverBeLaterThanTheEarliestExpiry)
+{
+    ose4g::TimerWheel wheel;
+    EXPECT_FALSE(wheel.nextWakeup().has_value());
+
+    // only the rest of the current rotation is looked at
+    auto far = wheel.schedule(1000, [] {});
+    EXPECT_EQ(wheel.nextWakeup(), std::optional<std::uint64_t>(64));
+    wheel.schedule(10, [] {});
+    EXPECT_EQ(wheel.nextWakeup(), std::optional<std::uint64_t>(10));
+
+    wheel.advance(10);
+    wheel.cancel(far);
+    EXPECT_FALSE(wheel.nextWakeup().has_value());
+}
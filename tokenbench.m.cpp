@@ -0,0 +1,141 @@
+// Measures parseStatement throughput in GB/s on long machine generated lines.
+//
+// The line carries an unquoted base64-like blob and a quoted JSON document,
+// the payloads findSeparator is meant to skip. It is parsed by the byte at a
+// time parser parseStatement used to have and by parseStatement at every
+// scan level the CPU supports.
+//
+//   ./tokenbench --bytes 4000000 --iterations 50
+#include "command-processor.h"
+#include "tokenizer.h"
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool byteAtATime(std::string_view input, ose4g::Command &command, ose4g::Args &args)
+    {
+        std::vector<std::string> seen;
+        std::string temp;
+        std::size_t i = 0;
+        std::size_t n = input.size();
+        while (i < n)
+        {
+            if (input[i] == '"' || input[i] == '\'')
+            {
+                std::size_t start = i;
+                char c = input[i];
+                i++;
+                while (i < n && input[i] != c)
+                {
+                    i++;
+                }
+                if (i == n)
+                {
+                    return false;
+                }
+                seen.emplace_back(input.substr(start + 1, i - start - 1));
+            }
+            else if (input[i] == ' ')
+            {
+                if (temp != "")
+                {
+                    seen.push_back(temp);
+                    temp.clear();
+                }
+            }
+            else
+            {
+                temp += input[i];
+            }
+            i++;
+        }
+        if (temp != "")
+        {
+            seen.push_back(temp);
+        }
+        command = seen.empty() ? "" : seen[0];
+        args.assign(seen.begin() + (seen.empty() ? 0 : 1), seen.end());
+        return true;
+    }
+
+    std::string makeLine(std::size_t bytes)
+    {
+        const std::string base64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::string line = "upload --name payload.bin --data ";
+        for (std::size_t i = 0; line.size() < bytes / 2; i++)
+        {
+            line += base64[(i * 7) % base64.size()];
+        }
+        line += " --meta '{";
+        for (int i = 0; line.size() < bytes; i++)
+        {
+            line += "\"field" + std::to_string(i) + "\": \"value " + std::to_string(i) + "\", ";
+        }
+        line += "\"end\": true}'";
+        return line;
+    }
+
+    template <typename Parse>
+    void measure(const char *name, const std::string &line, int iterations, Parse parse)
+    {
+        ose4g::Command command;
+        ose4g::Args args;
+        // warm up so the argument buffers are large enough
+        parse(line, command, args);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            parse(line, command, args);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << static_cast<double>(line.size()) * iterations / seconds / 1e9 << " GB/s ("
+                  << args.size() << " args)\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::size_t bytes = 4'000'000;
+    int iterations = 50;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--bytes" && i + 1 < argc)
+            bytes = std::stoul(argv[++i]);
+        else if (arg == "--iterations" && i + 1 < argc)
+            iterations = std::stoi(argv[++i]);
+        else
+        {
+            std::cerr << "usage: tokenbench [--bytes N] [--iterations N]\n";
+            return 1;
+        }
+    }
+
+    std::string line = makeLine(bytes);
+    std::cout << "line of " << line.size() << " bytes\n";
+    measure("byte at a time", line, iterations, byteAtATime);
+
+    ose4g::CommandProcessorImpl processor("tokenbench");
+    std::pmr::unsynchronized_pool_resource scratch;
+    const std::array<std::pair<ose4g::ScanLevel, const char *>, 3> levels{{
+        {ose4g::ScanLevel::SCALAR, "scalar"},
+        {ose4g::ScanLevel::SSE2, "sse2"},
+        {ose4g::ScanLevel::AVX2, "avx2"},
+    }};
+    for (auto &[level, name] : levels)
+    {
+        if (ose4g::setScanLevel(level) != level)
+        {
+            continue;
+        }
+        measure(name, line, iterations, [&](std::string_view input, ose4g::Command &command, ose4g::Args &args)
+                { return processor.parseStatement(input, command, args, &scratch); });
+    }
+    ose4g::setScanLevel(ose4g::supportedScanLevel());
+    return 0;
+}
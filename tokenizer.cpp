@@ -0,0 +1,150 @@
+#include "tokenizer.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OSE4G_X86 1
+#endif
+
+namespace ose4g
+{
+    namespace
+    {
+        bool isSeparator(char c)
+        {
+            return c == ' ' || c == '"' || c == '\'';
+        }
+
+        std::size_t findScalar(const char *data, std::size_t size)
+        {
+            std::size_t i = 0;
+            while (i < size && !isSeparator(data[i]))
+            {
+                i++;
+            }
+            return i;
+        }
+
+#ifdef OSE4G_X86
+        // SSE2 is part of x86-64, AVX2 is only used after checking the CPU
+        __attribute__((target("sse2"))) std::size_t findSse2(const char *data, std::size_t size)
+        {
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i doubleQuote = _mm_set1_epi8('"');
+            const __m128i singleQuote = _mm_set1_epi8('\'');
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, doubleQuote)),
+                                             _mm_cmpeq_epi8(bytes, singleQuote));
+                if (unsigned mask = _mm_movemask_epi8(found))
+                {
+                    return i + __builtin_ctz(mask);
+                }
+            }
+            return i + findScalar(data + i, size - i);
+        }
+
+        __attribute__((target("avx2"))) std::size_t findAvx2(const char *data, std::size_t size)
+        {
+            const __m256i space = _mm256_set1_epi8(' ');
+            const __m256i doubleQuote = _mm256_set1_epi8('"');
+            const __m256i singleQuote = _mm256_set1_epi8('\'');
+            std::size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                __m256i found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, space), _mm256_cmpeq_epi8(bytes, doubleQuote)),
+                                                _mm256_cmpeq_epi8(bytes, singleQuote));
+                if (unsigned mask = _mm256_movemask_epi8(found))
+                {
+                    return i + __builtin_ctz(mask);
+                }
+            }
+            // the tail is shorter than a register, finish it with SSE2
+            return i + findSse2(data + i, size - i);
+        }
+#endif
+
+        using Finder = std::size_t (*)(const char *, std::size_t);
+
+        Finder finderFor(ScanLevel level)
+        {
+            switch (level)
+            {
+#ifdef OSE4G_X86
+            case ScanLevel::AVX2:
+                return findAvx2;
+            case ScanLevel::SSE2:
+                return findSse2;
+#endif
+            default:
+                return findScalar;
+            }
+        }
+
+        std::size_t findFirstTime(const char *data, std::size_t size);
+
+        // constant initialized, so parsing works from static initializers of other files too
+        constinit std::atomic<Finder> s_finder{findFirstTime};
+        constinit std::atomic<ScanLevel> s_level{ScanLevel::SCALAR};
+
+        // picks the best finder unless setScanLevel already chose one
+        void installBestFinder()
+        {
+            ScanLevel level = supportedScanLevel();
+            Finder expected = findFirstTime;
+            if (s_finder.compare_exchange_strong(expected, finderFor(level)))
+            {
+                s_level = level;
+            }
+        }
+
+        std::size_t findFirstTime(const char *data, std::size_t size)
+        {
+            installBestFinder();
+            return s_finder.load()(data, size);
+        }
+    }
+
+    std::size_t findSeparator(const char *data, std::size_t size)
+    {
+        return s_finder.load(std::memory_order_relaxed)(data, size);
+    }
+
+    ScanLevel scanLevel()
+    {
+        if (s_finder.load() == findFirstTime)
+        {
+            installBestFinder();
+        }
+        return s_level.load();
+    }
+
+    ScanLevel supportedScanLevel()
+    {
+#ifdef OSE4G_X86
+        // may run from a static initializer, before the runtime has probed the CPU
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return ScanLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return ScanLevel::SSE2;
+        }
+#endif
+        return ScanLevel::SCALAR;
+    }
+
+    ScanLevel setScanLevel(ScanLevel level)
+    {
+        level = std::min(level, supportedScanLevel());
+        s_level = level;
+        s_finder = finderFor(level);
+        return level;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <cstddef>
+
+namespace ose4g
+{
+    /// @brief instruction sets findSeparator can use, in increasing width
+    enum class ScanLevel
+    {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    /**
+     * @brief position of the first space, ' or " in data, or size if there is none.
+     *
+     * Compares 16 (SSE2) or 32 (AVX2) bytes at a time, picked once from what
+     * the CPU supports, so long unquoted payloads are skipped at memory speed.
+     */
+    std::size_t findSeparator(const char *data, std::size_t size);
+
+    /// @brief the level findSeparator currently uses
+    ScanLevel scanLevel();
+
+    /// @brief best level the CPU supports
+    ScanLevel supportedScanLevel();
+
+    /**
+     * @brief makes findSeparator use level, e.g. to compare levels in tests and benchmarks.
+     *
+     * @returns the level used, which is lowered to supportedScanLevel() if needed.
+     */
+    ScanLevel setScanLevel(ScanLevel level);
+}
+
+#endif
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "command-processor.h"
+#include "tokenizer.h"
+
+namespace
+{
+    // runs while the statics of this file are initialized, possibly before those of tokenizer.cpp
+    const std::size_t s_earlySeparator = ose4g::findSeparator("early parse", 11);
+
+    // the byte at a time parser findSeparator replaced
+    bool referenceParse(const std::string &input, ose4g::Command &command, ose4g::Args &args)
+    {
+        std::vector<std::string> seen;
+        std::string temp;
+        std::size_t i = 0;
+        while (i < input.size())
+        {
+            if (input[i] == '"' || input[i] == '\'')
+            {
+                std::size_t close = input.find(input[i], i + 1);
+                if (close == std::string::npos)
+                    return false;
+                seen.push_back(input.substr(i + 1, close - i - 1));
+                i = close;
+            }
+            else if (input[i] == ' ')
+            {
+                if (!temp.empty())
+                    seen.push_back(std::exchange(temp, ""));
+            }
+            else
+            {
+                temp += input[i];
+            }
+            i++;
+        }
+        if (!temp.empty())
+            seen.push_back(temp);
+        command = seen.empty() ? "" : seen[0];
+        args.assign(seen.begin() + std::min<std::size_t>(1, seen.size()), seen.end());
+        return true;
+    }
+}
+
+class FindSeparatorTest : public testing::TestWithParam<ose4g::ScanLevel>
+{
+protected:
+    ose4g::ScanLevel d_previous = ose4g::scanLevel();
+
+    void SetUp() override
+    {
+        if (ose4g::setScanLevel(GetParam()) != GetParam())
+        {
+            GTEST_SKIP() << "not supported by this CPU";
+        }
+    }
+
+    void TearDown() override { ose4g::setScanLevel(d_previous); }
+};
+INSTANTIATE_TEST_SUITE_P(TestSuite,
+                         FindSeparatorTest,
+                         testing::Values(ose4g::ScanLevel::SCALAR, ose4g::ScanLevel::SSE2, ose4g::ScanLevel::AVX2));
+
+TEST_P(FindSeparatorTest, shouldFindFirstSeparatorAtEveryOffset)
+{
+    // cover every position in and across 16 and 32 byte blocks, and the tails
+    for (std::size_t size = 0; size < 100; size++)
+    {
+        std::string text(size, 'x');
+        EXPECT_EQ(ose4g::findSeparator(text.data(), text.size()), size);
+        for (std::size_t at = 0; at < size; at++)
+        {
+            for (char separator : {' ', '"', '\''})
+            {
+                text[at] = separator;
+                ASSERT_EQ(ose4g::findSeparator(text.data(), text.size()), at) << size << ' ' << at;
+                text[at] = 'x';
+            }
+        }
+    }
+}
+
+TEST_P(FindSeparatorTest, parseShouldMatchByteAtATimeParserOnRandomLines)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    std::mt19937 random(7);
+    const std::string alphabet = "ab= '\"";
+    for (int line = 0; line < 500; line++)
+    {
+        std::string input(random() % 200, ' ');
+        for (auto &c : input)
+        {
+            c = alphabet[random() % alphabet.size()];
+        }
+        ose4g::Command expectedCommand;
+        ose4g::Args expectedArgs;
+        bool expected = referenceParse(input, expectedCommand, expectedArgs);
+
+        ose4g::Command command;
+        ose4g::Args args;
+        ASSERT_EQ(cp.parseStatement(input, command, args), expected) << input;
+        if (expected)
+        {
+            EXPECT_EQ(command, expectedCommand) << input;
+            EXPECT_EQ(args, expectedArgs) << input;
+        }
+    }
+}
+
+TEST(TokenizerTest, parseShouldKeepLongPayloadsIntact)
+{
+    ose4g::CommandProcessorImpl cp("name");
+    std::string blob(1 << 20, 'Q');
+    std::string json = "{\"key\": \"value\", \"list\": [1, 2, 3]}";
+    ose4g::Command command;
+    ose4g::Args args;
+    ASSERT_TRUE(cp.parseStatement("upload " + blob + " '" + json + "' ab'cd'ef", command, args));
+    EXPECT_EQ(command, "upload");
+    ASSERT_EQ(args.size(), 4u);
+    EXPECT_EQ(args[0], blob);
+    EXPECT_EQ(args[1], json);
+    // a quoted part is its own argument and the word around it is joined, as before
+    EXPECT_EQ(args[2], "cd");
+    EXPECT_EQ(args[3], "abef");
+}
+
+TEST(TokenizerTest, findSeparatorShouldWorkDuringStaticInitialization)
+{
+    EXPECT_EQ(s_earlySeparator, 5u);
+}
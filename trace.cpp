@@ -0,0 +1,252 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace ose4g
+{
+    namespace
+    {
+        struct Event
+        {
+            const char *name;
+            std::uint64_t start;
+            std::uint64_t duration;
+            char detail[48];
+        };
+
+        // written by one thread at a time, read by stopTracing after recording stops
+        struct ThreadBuffer
+        {
+            static constexpr std::size_t CAPACITY = 1 << 16;
+
+            std::unique_ptr<Event[]> events;
+            std::atomic<std::size_t> count{0};
+            std::atomic<std::uint64_t> dropped{0};
+            std::atomic<std::uint64_t> generation{0};
+            int tid = 0;
+            std::atomic<bool> inUse{false};
+            ThreadBuffer *next = nullptr;
+        };
+
+        class Tracer
+        {
+        private:
+            std::atomic<ThreadBuffer *> d_buffers{nullptr};
+            std::atomic<int> d_nextTid{1};
+
+        public:
+            std::atomic<bool> d_enabled{false};
+            // bumped by every start, buffers from an older trace are cleared by their owner
+            std::atomic<std::uint64_t> d_generation{0};
+            std::mutex d_controlMutex;
+
+            ~Tracer()
+            {
+                auto buffer = d_buffers.load();
+                while (buffer)
+                {
+                    auto next = buffer->next;
+                    delete buffer;
+                    buffer = next;
+                }
+            }
+
+            // buffers are never freed while running, threads that exit leave theirs for reuse
+            ThreadBuffer *acquire()
+            {
+                for (auto buffer = d_buffers.load(); buffer; buffer = buffer->next)
+                {
+                    bool expected = false;
+                    if (!buffer->inUse && buffer->inUse.compare_exchange_strong(expected, true))
+                    {
+                        buffer->tid = d_nextTid++;
+                        return buffer;
+                    }
+                }
+                auto buffer = new ThreadBuffer;
+                buffer->inUse = true;
+                buffer->tid = d_nextTid++;
+                buffer->next = d_buffers.load();
+                while (!d_buffers.compare_exchange_weak(buffer->next, buffer))
+                {
+                }
+                return buffer;
+            }
+
+            ThreadBuffer *buffers() const { return d_buffers.load(); }
+        };
+
+        Tracer &tracer()
+        {
+            static Tracer instance;
+            return instance;
+        }
+
+        struct ThreadSlot
+        {
+            ThreadBuffer *buffer = nullptr;
+
+            ~ThreadSlot()
+            {
+                if (buffer)
+                {
+                    buffer->inUse = false;
+                }
+            }
+        };
+
+        thread_local ThreadSlot t_slot;
+
+        std::uint64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void append(const char *name, std::uint64_t start, std::uint64_t end, const char *detail)
+        {
+            auto &slot = t_slot;
+            if (!slot.buffer)
+            {
+                slot.buffer = tracer().acquire();
+            }
+            ThreadBuffer &buffer = *slot.buffer;
+            std::uint64_t generation = tracer().d_generation.load(std::memory_order_acquire);
+            if (buffer.generation.load(std::memory_order_relaxed) != generation)
+            {
+                buffer.count.store(0, std::memory_order_relaxed);
+                buffer.dropped.store(0, std::memory_order_relaxed);
+                buffer.generation.store(generation, std::memory_order_relaxed);
+            }
+            if (!buffer.events)
+            {
+                buffer.events = std::make_unique<Event[]>(ThreadBuffer::CAPACITY);
+            }
+            std::size_t index = buffer.count.load(std::memory_order_relaxed);
+            if (index == ThreadBuffer::CAPACITY)
+            {
+                buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Event &event = buffer.events[index];
+            event.name = name;
+            event.start = start;
+            event.duration = end - start;
+            std::memcpy(event.detail, detail, sizeof(event.detail));
+            buffer.count.store(index + 1, std::memory_order_release);
+        }
+
+        void writeEscaped(std::ostream &out, std::string_view text)
+        {
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\' << c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    out << code;
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+        }
+    }
+
+    TraceSpan::TraceSpan(const char *name, std::string_view detail) : d_name(name), d_start(0), d_active(tracingEnabled())
+    {
+        if (!d_active)
+        {
+            return;
+        }
+        std::size_t length = std::min(detail.size(), sizeof(d_detail) - 1);
+        std::memcpy(d_detail, detail.data(), length);
+        std::memset(d_detail + length, 0, sizeof(d_detail) - length);
+        d_start = now();
+    }
+
+    TraceSpan::~TraceSpan()
+    {
+        if (d_active)
+        {
+            append(d_name, d_start, now(), d_detail);
+        }
+    }
+
+    bool tracingEnabled()
+    {
+        return tracer().d_enabled.load(std::memory_order_relaxed);
+    }
+
+    void startTracing()
+    {
+        auto &instance = tracer();
+        std::lock_guard lock(instance.d_controlMutex);
+        instance.d_generation.fetch_add(1, std::memory_order_release);
+        instance.d_enabled = true;
+    }
+
+    std::size_t stopTracing(const std::string &path)
+    {
+        auto &instance = tracer();
+        std::lock_guard lock(instance.d_controlMutex);
+        if (!instance.d_enabled.exchange(false))
+        {
+            throw std::invalid_argument("tracing is not on");
+        }
+        std::ofstream out(path);
+        if (!out)
+        {
+            throw std::invalid_argument("cannot write " + path);
+        }
+
+        // spans still open when tracing stopped may land after the counts are read, they are left out
+        std::uint64_t generation = instance.d_generation.load();
+        int pid = getpid();
+        std::size_t written = 0;
+        std::uint64_t dropped = 0;
+        out << "{\"traceEvents\":[";
+        for (auto buffer = instance.buffers(); buffer; buffer = buffer->next)
+        {
+            std::size_t count = buffer->count.load(std::memory_order_acquire);
+            if (buffer->generation.load() != generation)
+            {
+                continue;
+            }
+            dropped += buffer->dropped;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const Event &event = buffer->events[i];
+                out << (written++ ? ",\n" : "\n") << "{\"name\":\"";
+                writeEscaped(out, event.name);
+                out << "\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                    << ",\"ts\":" << event.start / 1000 << '.' << event.start % 1000 / 100
+                    << ",\"dur\":" << event.duration / 1000 << '.' << event.duration % 1000 / 100;
+                if (event.detail[0] != '\0')
+                {
+                    out << ",\"args\":{\"detail\":\"";
+                    writeEscaped(out, event.detail);
+                    out << "\"}";
+                }
+                out << '}';
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedSpans\":" << dropped << "}}\n";
+        if (!out)
+        {
+            throw std::invalid_argument("cannot write " + path);
+        }
+        return written;
+    }
+}
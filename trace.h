@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ose4g
+{
+    /**
+     * @brief Times a scope and records it as a span while tracing is on.
+     *
+     * Spans are written to a buffer owned by the current thread without
+     * locking and exported as Chrome trace-event JSON, which Perfetto and
+     * chrome://tracing show as a timeline. Spans on a thread nest by time, so
+     * a handler's own spans appear under the command that ran it. When tracing
+     * is off a span costs one relaxed atomic load.
+     *
+     * @code
+     * cp.add("query", [](const ose4g::Args &args) {
+     *     ose4g::TraceSpan span("query", args.at(0));
+     *     ...
+     * });
+     * @endcode
+     */
+    class TraceSpan
+    {
+    private:
+        const char *d_name;
+        std::uint64_t d_start;
+        // only names and details of spans that are recorded are kept
+        char d_detail[48];
+        bool d_active;
+
+    public:
+        /**
+         * @param name must outlive the trace, normally a string literal.
+         * @param detail copied, shown as the span's argument, truncated to 47 bytes.
+         */
+        explicit TraceSpan(const char *name, std::string_view detail = {});
+        ~TraceSpan();
+
+        TraceSpan(const TraceSpan &) = delete;
+        TraceSpan &operator=(const TraceSpan &) = delete;
+    };
+
+    /// @brief drops any previous trace and starts recording spans on every thread
+    void startTracing();
+
+    /**
+     * @brief stops recording and writes the spans as Chrome trace-event JSON.
+     *
+     * @returns the number of spans written.
+     * @throws std::invalid_argument if tracing is not on or the file cannot be written.
+     */
+    std::size_t stopTracing(const std::string &path);
+
+    bool tracingEnabled();
+}
+
+#endif
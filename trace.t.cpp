@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "trace.h"
+
+static std::string readFile(const std::string &path)
+{
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static std::size_t count(const std::string &text, const std::string &needle)
+{
+    std::size_t found = 0;
+    for (auto at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1))
+        found++;
+    return found;
+}
+
+TEST(TraceTest, spansShouldOnlyBeRecordedWhileTracing)
+{
+    std::string path = testing::TempDir() + "trace.json";
+    {
+        ose4g::TraceSpan before("before");
+    }
+    ose4g::startTracing();
+    EXPECT_TRUE(ose4g::tracingEnabled());
+    {
+        ose4g::TraceSpan outer("outer", "with \"detail\"");
+        ose4g::TraceSpan inner("inner");
+    }
+    std::thread([]
+                { ose4g::TraceSpan span("worker"); })
+        .join();
+    EXPECT_EQ(ose4g::stopTracing(path), 3u);
+    EXPECT_FALSE(ose4g::tracingEnabled());
+    {
+        ose4g::TraceSpan after("after");
+    }
+
+    auto json = readFile(path);
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(count(json, "\"ph\":\"X\""), 3u);
+    EXPECT_NE(json.find("\"name\":\"outer\""), std::string::npos);
+    EXPECT_NE(json.find("\"detail\":\"with \\\"detail\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"worker\""), std::string::npos);
+    EXPECT_EQ(json.find("before"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(TraceTest, startingAgainShouldDropThePreviousTrace)
+{
+    std::string path = testing::TempDir() + "trace.json";
+    ose4g::startTracing();
+    {
+        ose4g::TraceSpan span("first");
+    }
+    ose4g::startTracing();
+    {
+        ose4g::TraceSpan span("second");
+    }
+    EXPECT_EQ(ose4g::stopTracing(path), 1u);
+    EXPECT_EQ(readFile(path).find("first"), std::string::npos);
+    EXPECT_THROW(ose4g::stopTracing(path), std::invalid_argument);
+    std::remove(path.c_str());
+}
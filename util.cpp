@@ -1,9 +1,11 @@
 #include "util.h"
-#include <sstream>
+#include "style.h"
 
 std::string ose4g::addColor(const std::string &s, Color color)
 {
-    std::stringstream ss;
-    ss << "\033[1;" << std::to_string(color) << "m" << s << "\033[0m";
-    return ss.str();
-}
\ No newline at end of file
+    std::string result;
+    Style style(color);
+    result.reserve(style.sequence().size() + s.size() + Style::reset().size());
+    formatStyled(std::back_inserter(result), styled(s, style));
+    return result;
+}
@@ -0,0 +1,167 @@
+#include "watchdog.h"
+#include <iostream>
+#include <utility>
+
+namespace ose4g
+{
+    Watchdog::Watch::Watch(Watch &&other) noexcept : d_owner(std::exchange(other.d_owner, nullptr)), d_entry(std::move(other.d_entry))
+    {
+    }
+
+    Watchdog::Watch &Watchdog::Watch::operator=(Watch &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (d_owner)
+            {
+                d_owner->finish(*d_entry);
+            }
+            d_owner = std::exchange(other.d_owner, nullptr);
+            d_entry = std::move(other.d_entry);
+        }
+        return *this;
+    }
+
+    Watchdog::Watch::~Watch()
+    {
+        if (d_owner)
+        {
+            d_owner->finish(*d_entry);
+        }
+    }
+
+    bool Watchdog::Watch::expired() const
+    {
+        return d_entry && d_entry->expired.load();
+    }
+
+    Watchdog::Watchdog(std::chrono::milliseconds grace) : d_grace(grace), d_epoch(Clock::now())
+    {
+    }
+
+    Watchdog::~Watchdog()
+    {
+        {
+            std::lock_guard lock(d_mutex);
+            d_stopping = true;
+        }
+        d_wakeup.notify_one();
+        if (d_thread.joinable())
+        {
+            d_thread.join();
+        }
+    }
+
+    std::uint64_t Watchdog::tick(Clock::time_point time) const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time - d_epoch).count();
+    }
+
+    Watchdog::Watch Watchdog::watch(std::string name, std::chrono::milliseconds timeout, std::stop_source stop,
+                                    std::function<void()> onIgnored)
+    {
+        auto entry = std::make_shared<Entry>();
+        entry->name = std::move(name);
+        entry->stop = std::move(stop);
+        entry->onIgnored = std::move(onIgnored);
+        entry->started = Clock::now();
+        {
+            std::lock_guard lock(d_mutex);
+            // most processors never set a deadline, so only start the thread when one is used
+            if (!d_thread.joinable())
+            {
+                d_thread = std::thread([this]
+                                       { loop(); });
+            }
+            d_stats.watched++;
+            entry->timer = d_wheel.schedule(tick(entry->started + timeout), [this, entry]
+                                            { expire(entry); });
+        }
+        d_wakeup.notify_one();
+        return Watch(this, std::move(entry));
+    }
+
+    void Watchdog::setGracePeriod(std::chrono::milliseconds grace)
+    {
+        std::lock_guard lock(d_mutex);
+        d_grace = grace;
+    }
+
+    std::chrono::milliseconds Watchdog::gracePeriod() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_grace;
+    }
+
+    Watchdog::Stats Watchdog::stats() const
+    {
+        std::lock_guard lock(d_mutex);
+        return d_stats;
+    }
+
+    // timer callbacks run on the watchdog thread with the mutex held, stop callbacks of handlers
+    // and onIgnored may watch or finish commands, so they run later from loop without it
+    void Watchdog::expire(const std::shared_ptr<Entry> &entry)
+    {
+        d_stats.deadlineMisses++;
+        entry->expired = true;
+        entry->timer = d_wheel.schedule(d_wheel.now() + d_grace.count(), [this, entry]
+                                        { ignored(entry); });
+        d_actions.push_back([entry]
+                            { entry->stop.request_stop(); });
+    }
+
+    void Watchdog::ignored(const std::shared_ptr<Entry> &entry)
+    {
+        d_stats.ignoredCancellations++;
+        d_actions.push_back([entry]
+                            {
+            if (entry->finished)
+            {
+                return;
+            }
+            auto running = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - entry->started);
+            std::cerr << "watchdog: '" << entry->name << "' ignored cancellation, still running after "
+                      << running.count() << "ms" << std::endl;
+            if (entry->onIgnored)
+            {
+                entry->onIgnored();
+            } });
+    }
+
+    void Watchdog::finish(Entry &entry)
+    {
+        std::lock_guard lock(d_mutex);
+        entry.finished = true;
+        d_wheel.cancel(entry.timer);
+    }
+
+    void Watchdog::loop()
+    {
+        std::unique_lock lock(d_mutex);
+        while (!d_stopping)
+        {
+            d_wheel.advance(tick(Clock::now()));
+            if (!d_actions.empty())
+            {
+                auto actions = std::exchange(d_actions, {});
+                lock.unlock();
+                for (auto &action : actions)
+                {
+                    action();
+                }
+                lock.lock();
+                continue;
+            }
+            auto next = d_wheel.nextExpiry();
+            if (next)
+            {
+                d_wakeup.wait_until(lock, d_epoch + std::chrono::milliseconds(*next));
+            }
+            else
+            {
+                d_wakeup.wait(lock);
+            }
+        }
+    }
+}
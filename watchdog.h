@@ -0,0 +1,117 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "timerwheel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ose4g
+{
+    /**
+     * @brief Enforces command deadlines from a background thread.
+     *
+     * A running command is watched with its deadline and a stop_source. When
+     * the deadline passes the watchdog requests a stop, the handler is
+     * expected to check its stop_token and return. If it is still running a
+     * grace period later it is reported as ignoring cancellation.
+     */
+    class Watchdog
+    {
+    public:
+        struct Stats
+        {
+            std::uint64_t watched = 0;
+            std::uint64_t deadlineMisses = 0;
+            std::uint64_t ignoredCancellations = 0;
+        };
+
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            std::stop_source stop;
+            std::function<void()> onIgnored;
+            Clock::time_point started;
+            TimerWheel::Id timer = 0;
+            std::atomic<bool> expired{false};
+            std::atomic<bool> finished{false};
+        };
+
+    public:
+        /**
+         * @brief Handle for one watched command, stops watching when destroyed.
+         */
+        class Watch
+        {
+        private:
+            Watchdog *d_owner = nullptr;
+            std::shared_ptr<Entry> d_entry;
+
+            friend class Watchdog;
+            Watch(Watchdog *owner, std::shared_ptr<Entry> entry) : d_owner(owner), d_entry(std::move(entry)) {}
+
+        public:
+            Watch() = default;
+            Watch(Watch &&other) noexcept;
+            Watch &operator=(Watch &&other) noexcept;
+            ~Watch();
+
+            /// @brief true once the deadline passed
+            bool expired() const;
+        };
+
+        explicit Watchdog(std::chrono::milliseconds grace = std::chrono::seconds(1));
+        ~Watchdog();
+
+        Watchdog(const Watchdog &) = delete;
+        Watchdog &operator=(const Watchdog &) = delete;
+
+        /**
+         * @brief starts watching a command.
+         *
+         * @param name shown when the command is reported.
+         * @param timeout time until stop is requested.
+         * @param stop source of the token given to the handler.
+         * @param onIgnored called from the watchdog thread if the command is
+         *        still running a grace period after its deadline.
+         */
+        Watch watch(std::string name, std::chrono::milliseconds timeout, std::stop_source stop,
+                    std::function<void()> onIgnored = {});
+
+        /// @brief time a command gets to return after stop was requested
+        void setGracePeriod(std::chrono::milliseconds grace);
+        std::chrono::milliseconds gracePeriod() const;
+
+        Stats stats() const;
+
+    private:
+        std::chrono::milliseconds d_grace;
+        Clock::time_point d_epoch;
+        mutable std::mutex d_mutex;
+        std::condition_variable d_wakeup;
+        TimerWheel d_wheel;
+        // stop requests and reports of expired timers, run by loop with the mutex released
+        std::vector<std::function<void()>> d_actions;
+        Stats d_stats;
+        bool d_stopping = false;
+        std::thread d_thread;
+
+        std::uint64_t tick(Clock::time_point time) const;
+        void expire(const std::shared_ptr<Entry> &entry);
+        void ignored(const std::shared_ptr<Entry> &entry);
+        void finish(Entry &entry);
+        void loop();
+    };
+}
+
+#endif
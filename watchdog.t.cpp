@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include "watchdog.h"
+
+using namespace std::chrono_literals;
+
+TEST(WatchdogTest, shouldRequestStopWhenDeadlinePasses)
+{
+    ose4g::Watchdog watchdog;
+    std::stop_source stop;
+    auto watch = watchdog.watch("slow", 20ms, stop);
+    auto token = stop.get_token();
+    auto start = std::chrono::steady_clock::now();
+    while (!token.stop_requested() && std::chrono::steady_clock::now() - start < 5s)
+        std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(token.stop_requested());
+    EXPECT_TRUE(watch.expired());
+    EXPECT_EQ(watchdog.stats().deadlineMisses, 1u);
+}
+
+TEST(WatchdogTest, finishedCommandShouldNotBeStopped)
+{
+    ose4g::Watchdog watchdog;
+    std::stop_source stop;
+    {
+        auto watch = watchdog.watch("fast", 20ms, stop);
+    }
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(stop.stop_requested());
+    EXPECT_EQ(watchdog.stats().watched, 1u);
+    EXPECT_EQ(watchdog.stats().deadlineMisses, 0u);
+}
+
+TEST(WatchdogTest, shouldReportCommandsIgnoringCancellation)
+{
+    ose4g::Watchdog watchdog(10ms);
+    std::atomic<bool> reported = false;
+    auto watch = watchdog.watch("stuck", 10ms, std::stop_source(), [&]
+                                { reported = true; });
+    auto start = std::chrono::steady_clock::now();
+    while (!reported && std::chrono::steady_clock::now() - start < 5s)
+        std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(reported);
+    EXPECT_EQ(watchdog.stats().ignoredCancellations, 1u);
+}
+
+TEST(WatchdogTest, stopCallbacksShouldBeAbleToWatchAndFinishCommands)
+{
+    ose4g::Watchdog watchdog(10ms);
+    std::stop_source stop;
+    std::atomic<bool> rewatched = false;
+    std::atomic<bool> reported = false;
+    // a handler whose cleanup runs another watched command
+    std::stop_callback cleanup(stop.get_token(), [&]
+                               {
+        auto inner = watchdog.watch("cleanup", 1s, std::stop_source());
+        rewatched = true; });
+    auto watch = watchdog.watch("outer", 10ms, stop, [&]
+                                { auto inner = watchdog.watch("report", 1s, std::stop_source());
+                                  reported = true; });
+    auto start = std::chrono::steady_clock::now();
+    while (!(rewatched && reported) && std::chrono::steady_clock::now() - start < 5s)
+        std::this_thread::sleep_for(1ms);
+    EXPECT_TRUE(rewatched);
+    EXPECT_TRUE(reported);
+    EXPECT_EQ(watchdog.stats().watched, 3u);
+}